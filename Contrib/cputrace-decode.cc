@@ -0,0 +1,90 @@
+// Converts a binary CPU trace (see the 'cputrace_file' setting) to the same
+// text format as printed by 'cputrace' without 'cputrace_file'.
+//
+// compile with:
+//   g++ -Wall -O2 -std=c++14 cputrace-decode.cc -I ../src -I ../src/cpu -I ../src/debugger -I ../src/utils -I ../derived/<flavour>/config ../src/cpu/Dasm.cc ../src/debugger/DasmTables.cc -o cputrace-decode
+//
+// usage:
+//   cputrace-decode [-t] <trace-file>
+// With -t each line is prefixed with the EmuTime (in seconds) at the end of
+// the instruction.
+
+#include "Dasm.hh"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace openmsx;
+
+// Must match the structs in src/cpu/CPUTraceWriter.hh
+struct Header {
+	char magic[16];
+	uint32_t version;
+	uint32_t recordSize;
+	uint64_t ticksPerSecond;
+};
+struct Record {
+	uint64_t time;
+	uint16_t pc;
+	uint16_t af, bc, de, hl, ix, iy, sp;
+	uint8_t opcode[4];
+	uint8_t cpu;
+	uint8_t pad[3];
+};
+
+static int usage(const char* prog)
+{
+	fprintf(stderr, "Usage: %s [-t] <trace-file>\n", prog);
+	return 1;
+}
+
+int main(int argc, char** argv)
+{
+	bool printTime = false;
+	const char* filename = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-t") == 0) {
+			printTime = true;
+		} else if (!filename) {
+			filename = argv[i];
+		} else {
+			return usage(argv[0]);
+		}
+	}
+	if (!filename) return usage(argv[0]);
+
+	FILE* file = fopen(filename, "rb");
+	if (!file) {
+		perror(filename);
+		return 1;
+	}
+	Header header;
+	if ((fread(&header, sizeof(header), 1, file) != 1) ||
+	    (memcmp(header.magic, "openMSX cputrace", sizeof(header.magic)) != 0)) {
+		fprintf(stderr, "%s: not an openMSX CPU trace file\n", filename);
+		return 1;
+	}
+	if ((header.version != 1) || (header.recordSize != sizeof(Record))) {
+		// also triggers for a trace recorded on a host with a
+		// different byte order
+		fprintf(stderr, "%s: unsupported trace file version\n", filename);
+		return 1;
+	}
+
+	Record rec;
+	std::string dasmOutput;
+	while (fread(&rec, sizeof(rec), 1, file) == 1) {
+		dasmOutput.clear();
+		dasm(rec.opcode, rec.pc, dasmOutput);
+		if (printTime) {
+			printf("%.9f ", double(rec.time) / header.ticksPerSecond);
+		}
+		printf("%04x : %s AF=%04x BC=%04x DE=%04x HL=%04x "
+		       "IX=%04x IY=%04x SP=%04x\n",
+		       rec.pc, dasmOutput.c_str(), rec.af, rec.bc, rec.de,
+		       rec.hl, rec.ix, rec.iy, rec.sp);
+	}
+	fclose(file);
+	return 0;
+}
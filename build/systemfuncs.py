@@ -20,6 +20,13 @@ class FTruncateFunction(SystemFunction):
 	def iterHeaders(cls, targetPlatform):
 		yield '<unistd.h>'
 
+class InotifyInit1Function(SystemFunction):
+	name = 'inotify_init1'
+
+	@classmethod
+	def iterHeaders(cls, targetPlatform):
+		yield '<sys/inotify.h>'
+
 class MMapFunction(SystemFunction):
 	name = 'mmap'
 
@@ -36,6 +43,13 @@ class PosixMemAlignFunction(SystemFunction):
 	def iterHeaders(cls, targetPlatform):
 		yield '<stdlib.h>'
 
+class ShmOpenFunction(SystemFunction):
+	name = 'shm_open'
+
+	@classmethod
+	def iterHeaders(cls, targetPlatform):
+		yield '<sys/mman.h>'
+
 class NftwFunction(SystemFunction):
 	name = 'nftw'
 
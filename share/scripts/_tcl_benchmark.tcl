@@ -0,0 +1,35 @@
+namespace eval tcl_benchmark {
+
+set_help_text tcl_dispatch_benchmark \
+"Measures how long it takes to call some often used openMSX commands from Tcl,
+e.g. to check the overhead of calling C++ commands from scripts. The optional
+argument is the number of calls per command (default 100000). Needs a running
+machine."
+
+proc empty_proc {} {}
+
+proc tcl_dispatch_benchmark {{iterations 100000}} {
+	set machine [machine]
+	set tests [list \
+		"Tcl proc (reference)"   {tcl_benchmark::empty_proc} \
+		"peek"                   {peek 0} \
+		"${machine}::peek"       [list ${machine}::peek 0] \
+		"peek16"                 {peek16 0} \
+		"debug read"             {debug read memory 0} \
+		"debug read_block"       {debug read_block memory 0 256} \
+		"reg"                    {reg pc} \
+		"peek in expression"     {expr {[peek 0] + 1}} \
+	]
+	set result ""
+	foreach {name script} $tests {
+		set us [lindex [time $script $iterations] 0]
+		append result [format "%-24s %8.3f us/call\n" $name $us]
+	}
+	return $result
+}
+
+namespace export tcl_dispatch_benchmark
+
+} ;# namespace tcl_benchmark
+
+namespace import tcl_benchmark::*
@@ -65,6 +65,7 @@ register_lazy "_tas_tools.tcl" {
 	toggle_frame_counter prev_frame next_frame start_of_frame
 	advance_frame reverse_frame toggle_cursors ram_watch
 	toggle_lag_counter reset_lag_counter toggle_movie_length_display}
+register_lazy "_tcl_benchmark.tcl" tcl_dispatch_benchmark
 register_lazy "_test_machines_and_extensions.tcl" {
 	test_all_machines test_all_extensions}
 register_lazy "_text_echo.tcl" text_echo
@@ -445,6 +445,11 @@ void MSXDevice::globalWrite(word /*address*/, byte /*value*/,
 	UNREACHABLE;
 }
 
+int MSXDevice::getVisibleBlock(word /*address*/) const
+{
+	return -1;
+}
+
 void MSXDevice::globalRead(word /*address*/, EmuTime::param /*time*/)
 {
 	UNREACHABLE;
@@ -186,6 +186,14 @@ public:
 	 */
 	virtual byte peekMem(word address, EmuTime::param time) const;
 
+	/** Returns the number of the memory block (e.g. memory mapper
+	  * segment or ROM bank) that is currently visible at the given
+	  * address. This is only used by the CPU profiler, to distinguish
+	  * code that is executed at the same address. The default
+	  * implementation returns -1 (device has no switchable blocks).
+	  */
+	virtual int getVisibleBlock(word address) const;
+
 	/** Global writes.
 	  * Some devices violate the MSX standard by ignoring the SLOT-SELECT
 	  * signal; they react to writes to a certain address in _any_ slot.
@@ -29,6 +29,7 @@ RealTime::RealTime(
 	, speedSetting   (globalSettings.getSpeedSetting())
 	, pauseSetting   (globalSettings.getPauseSetting())
 	, powerSetting   (globalSettings.getPowerSetting())
+	, totalSleepTime(0)
 	, emuTime(EmuTime::zero)
 	, enabled(true)
 {
@@ -65,12 +66,17 @@ EmuDuration RealTime::getEmuDuration(double realDur)
 }
 
 bool RealTime::timeLeft(uint64_t us, EmuTime::param time)
+{
+	return getSlack(time) > static_cast<int64_t>(us);
+}
+
+int64_t RealTime::getSlack(EmuTime::param time)
 {
 	auto realDuration = static_cast<uint64_t>(
 		getRealDuration(emuTime, time) * 1000000ULL);
 	auto currentRealTime = Timer::getTime();
-	return (currentRealTime + us) <
-	           (idealRealTime + realDuration + ALLOWED_LAG);
+	return static_cast<int64_t>(idealRealTime + realDuration + ALLOWED_LAG) -
+	       static_cast<int64_t>(currentRealTime);
 }
 
 void RealTime::sync(EmuTime::param time, bool allowSleep)
@@ -99,6 +105,7 @@ void RealTime::internalSync(EmuTime::param time, bool allowSleep)
 			if (sleep > 0) {
 				Timer::sleep(sleep); // request to sleep for 'sleep+sleepAdjust'
 				int64_t slept = Timer::getTime() - currentRealTime;
+				totalSleepTime += slept;
 				delta = sleep - slept; // actually slept for 'slept' us
 			}
 			const double ALPHA = 0.2;
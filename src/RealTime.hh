@@ -43,6 +43,20 @@ public:
 	  */
 	bool timeLeft(uint64_t us, EmuTime::param time);
 
+	/** The amount of real time (in micro seconds) that is left before
+	  * the given point in emulated time must be reached. This includes
+	  * the allowed lag, a negative value means emulation is running
+	  * behind real time (this is also the case when throttle is off).
+	  * @param time Point in emulated time.
+	  */
+	int64_t getSlack(EmuTime::param time);
+
+	/** Total amount of real time (in micro seconds) spent sleeping to
+	  * keep emulation in sync with real time. Subtracting this from
+	  * elapsed time gives the time the host was busy emulating.
+	  */
+	uint64_t getSleepTime() const { return totalSleepTime; }
+
 	void resync();
 
 	void enable();
@@ -78,6 +92,7 @@ private:
 	BooleanSetting& powerSetting;
 
 	uint64_t idealRealTime;
+	uint64_t totalSleepTime;
 	EmuTime emuTime;
 	double sleepAdjust;
 	bool enabled;
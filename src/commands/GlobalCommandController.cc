@@ -36,6 +36,7 @@ GlobalCommandController::GlobalCommandController(
 	, helpCmd(*this)
 	, tabCompletionCmd(*this)
 	, updateCmd(*this)
+	, replyFormatCmd(*this)
 	, platformInfo(getOpenMSXInfoCommand())
 	, versionInfo (getOpenMSXInfoCommand())
 	, romInfoTopic(getOpenMSXInfoCommand())
@@ -548,9 +549,8 @@ static GlobalCliComm::UpdateType getType(const TclObject& name)
 	throw CommandException("No such update type: ", name.getString());
 }
 
-CliConnection& GlobalCommandController::UpdateCmd::getConnection()
+static CliConnection& getCliConnection(GlobalCommandController& controller)
 {
-	auto& controller = OUTER(GlobalCommandController, updateCmd);
 	if (auto* c = controller.getConnection()) {
 		return *c;
 	}
@@ -558,6 +558,11 @@ CliConnection& GlobalCommandController::UpdateCmd::getConnection()
 	                       "it's used from an external application.");
 }
 
+CliConnection& GlobalCommandController::UpdateCmd::getConnection()
+{
+	return getCliConnection(OUTER(GlobalCommandController, updateCmd));
+}
+
 void GlobalCommandController::UpdateCmd::execute(
 	span<const TclObject> tokens, TclObject& /*result*/)
 {
@@ -594,6 +599,44 @@ void GlobalCommandController::UpdateCmd::tabCompletion(vector<string>& tokens) c
 }
 
 
+// class ReplyFormatCmd
+
+GlobalCommandController::ReplyFormatCmd::ReplyFormatCmd(CommandController& commandController_)
+	: Command(commandController_, "openmsx_reply_format")
+{
+}
+
+void GlobalCommandController::ReplyFormatCmd::execute(
+	span<const TclObject> tokens, TclObject& /*result*/)
+{
+	if (tokens.size() != 2) {
+		throw SyntaxError();
+	}
+	auto& connection = getCliConnection(
+		OUTER(GlobalCommandController, replyFormatCmd));
+	if (tokens[1] == "text") {
+		connection.setBase64Replies(false);
+	} else if (tokens[1] == "base64") {
+		connection.setBase64Replies(true);
+	} else {
+		throw SyntaxError();
+	}
+}
+
+string GlobalCommandController::ReplyFormatCmd::help(const vector<string>& /*tokens*/) const
+{
+	return "Select how binary command results (e.g. of 'debug read_block') "
+	       "are sent to an external application: as 'text' (default) or "
+	       "'base64' encoded. See doc/manual/openmsx-control.html.";
+}
+
+void GlobalCommandController::ReplyFormatCmd::tabCompletion(vector<string>& tokens) const
+{
+	static const char* const formats[] = { "text", "base64" };
+	completeString(tokens, formats);
+}
+
+
 // Platform info
 
 GlobalCommandController::PlatformInfo::PlatformInfo(InfoCommand& openMSXInfoCommand_)
@@ -136,6 +136,13 @@ private:
 		CliConnection& getConnection();
 	} updateCmd;
 
+	struct ReplyFormatCmd final : Command {
+		explicit ReplyFormatCmd(CommandController& commandController);
+		void execute(span<const TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} replyFormatCmd;
+
 	struct PlatformInfo final : InfoTopic {
 		explicit PlatformInfo(InfoCommand& openMSXInfoCommand);
 		void execute(span<const TclObject> tokens,
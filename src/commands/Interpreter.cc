@@ -8,6 +8,8 @@
 #include "InterpreterOutput.hh"
 #include "MSXCPUInterface.hh"
 #include "FileOperations.hh"
+#include "ScopedAssign.hh"
+#include "checked_cast.hh"
 #include "ranges.hh"
 #include "span.hh"
 #include "stl.hh"
@@ -164,16 +166,29 @@ int Interpreter::commandProc(ClientData clientData, Tcl_Interp* interp,
 			reinterpret_cast<TclObject*>(const_cast<Tcl_Obj**>(objv)),
 			objc);
 		int res = TCL_OK;
-		TclObject result;
+
+		// Reuse the result object of the previous command at this
+		// nesting level. When the caller only consumed that result
+		// (e.g. 'if {[peek $addr] == 0}') it's no longer shared, then
+		// assigning e.g. an integer result doesn't allocate.
+		auto& interpreter = command.getInterpreter();
+		unsigned depth = interpreter.commandDepth;
+		if (depth == interpreter.results.size()) {
+			interpreter.results.emplace_back();
+		}
+		TclObject& result = interpreter.results[depth];
+		result.clear();
+		ScopedAssign<unsigned> sa(interpreter.commandDepth, depth + 1);
+
 		try {
 			if (!command.isAllowedInEmptyMachine()) {
-				if (auto controller =
-					dynamic_cast<MSXCommandController*>(
-						&command.getCommandController())) {
-					if (!controller->getMSXMotherBoard().getMachineConfig()) {
-						throw CommandException(
-							"Can't execute command in empty machine");
-					}
+				// only machine commands are not allowed, see
+				// MSXCommandController::registerCommand()
+				auto controller = checked_cast<MSXCommandController*>(
+					&command.getCommandController());
+				if (!controller->getMSXMotherBoard().getMachineConfig()) {
+					throw CommandException(
+						"Can't execute command in empty machine");
 				}
 			}
 			command.execute(tokens, result);
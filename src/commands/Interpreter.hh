@@ -5,6 +5,7 @@
 #include "TclObject.hh"
 #include "string_view.hh"
 #include <tcl.h>
+#include <deque>
 #include <string>
 
 namespace openmsx {
@@ -63,6 +64,11 @@ private:
 	Tcl_Interp* interp;
 	InterpreterOutput* output;
 
+	// Result objects for commandProc(), one per nesting level (deque
+	// because references must stay valid while it grows).
+	std::deque<TclObject> results;
+	unsigned commandDepth = 0;
+
 	friend class TclObject;
 };
 
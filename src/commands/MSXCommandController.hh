@@ -45,6 +45,11 @@ public:
 
 	Command* findCommand(string_view name) const;
 
+	/** Changes whenever a machine command is (un)registered in any
+	  * MSXCommandController. Used to know when the result of an earlier
+	  * findCommand() call may no longer be valid (see ProxyCmd). */
+	static unsigned getCommandGeneration() { return commandGeneration; }
+
 	/** Returns true iff the machine this controller belongs to is currently
 	  * active.
 	  */
@@ -82,6 +87,8 @@ private:
 	Reactor& reactor;
 	MSXMotherBoard& motherboard;
 	MSXEventDistributor& msxEventDistributor;
+	static unsigned commandGeneration;
+
 	std::string machineID;
 	std::unique_ptr<InfoCommand> machineInfoCommand;
 
@@ -21,7 +21,16 @@ Command* ProxyCmd::getMachineCommand() const
 {
 	MSXMotherBoard* motherBoard = reactor.getMotherBoard();
 	if (!motherBoard) return nullptr;
-	return motherBoard->getMSXCommandController().findCommand(getName());
+	// This gets called for every execution of e.g. 'peek' or 'debug',
+	// so avoid looking up the command by name each time.
+	auto& controller = motherBoard->getMSXCommandController();
+	auto generation = MSXCommandController::getCommandGeneration();
+	if ((&controller != cachedController) || (generation != cachedGeneration)) {
+		cachedCommand = controller.findCommand(getName());
+		cachedController = &controller;
+		cachedGeneration = generation;
+	}
+	return cachedCommand;
 }
 
 void ProxyCmd::execute(span<const TclObject> tokens, TclObject& result)
@@ -7,6 +7,7 @@
 namespace openmsx {
 
 class Reactor;
+class MSXCommandController;
 
 class ProxyCmd final : public Command
 {
@@ -19,6 +20,11 @@ public:
 private:
 	Command* getMachineCommand() const;
 	Reactor& reactor;
+
+	// result of the last lookup in getMachineCommand()
+	mutable const MSXCommandController* cachedController = nullptr;
+	mutable unsigned cachedGeneration = 0;
+	mutable Command* cachedCommand = nullptr;
 };
 
 } // namespace openmsx
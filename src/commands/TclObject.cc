@@ -106,6 +106,31 @@ string_view TclObject::getString() const
 	return string_view(buf, length);
 }
 
+void TclObject::clear()
+{
+	if (Tcl_IsShared(obj)) {
+		Tcl_DecrRefCount(obj);
+		init(Tcl_NewObj());
+	} else {
+		Tcl_SetStringObj(obj, "", 0);
+	}
+}
+
+uint8_t* TclObject::setBinary(size_t size)
+{
+	Tcl_Obj* newObj = Tcl_NewByteArrayObj(nullptr, 0);
+	Tcl_IncrRefCount(newObj);
+	Tcl_DecrRefCount(obj);
+	obj = newObj;
+	return Tcl_SetByteArrayLength(obj, int(size));
+}
+
+bool TclObject::isBinary() const
+{
+	static const Tcl_ObjType* byteArrayType = Tcl_GetObjType("bytearray");
+	return obj->typePtr == byteArrayType;
+}
+
 span<const uint8_t> TclObject::getBinary() const
 {
 	int length;
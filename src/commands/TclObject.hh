@@ -113,6 +113,19 @@ public:
 		return *this;
 	}
 
+	/** Make this an empty object again. When the underlying Tcl_Obj is
+	  * not shared it's reused, so that e.g. assigning an integer
+	  * afterwards doesn't need to allocate a new Tcl_Obj. */
+	void clear();
+
+	/** Turn this into a binary (byte array) object of the given size.
+	  * Returns a pointer to the (uninitialized) bytes, so that they can
+	  * be filled in without first building a temporary buffer. */
+	uint8_t* setBinary(size_t size);
+
+	/** Is this (currently) a binary (byte array) object? */
+	bool isBinary() const;
+
 	// get underlying Tcl_Obj
 	Tcl_Obj* getTclObject() { return obj; }
 	Tcl_Obj* getTclObjectNonConst() const { return const_cast<Tcl_Obj*>(obj); }
@@ -207,6 +220,9 @@ private:
 	static Tcl_Obj* newObj(unsigned u) {
 		return Tcl_NewIntObj(u);
 	}
+	static Tcl_Obj* newObj(uint64_t u) {
+		return Tcl_NewWideIntObj(Tcl_WideInt(u));
+	}
 	static Tcl_Obj* newObj(float f) {
 		return Tcl_NewDoubleObj(double(f));
 	}
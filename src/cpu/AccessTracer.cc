@@ -0,0 +1,286 @@
+#include "AccessTracer.hh"
+#include "MSXMotherBoard.hh"
+#include "MSXCPUInterface.hh"
+#include "CommandException.hh"
+#include "FileContext.hh"
+#include "FileOperations.hh"
+#include "TclObject.hh"
+#include "outer.hh"
+#include "ranges.hh"
+#include <algorithm>
+#include <cstdio>
+
+using std::string;
+using std::vector;
+
+namespace openmsx {
+
+static const char* const typeNames[] = { "read", "write", "in", "out" };
+
+AccessTracer::AccessTracer(MSXMotherBoard& motherBoard,
+                           MSXCPUInterface& interface_)
+	: interface(interface_)
+	, traceCommand(motherBoard.getCommandController())
+	, head(0)
+	, count(0)
+	, addrBegin(0), addrEnd(0xFFFF)
+	, portBegin(0), portEnd(0xFF)
+	, primarySlot(-1), secondarySlot(-1)
+	, active(false)
+{
+	ranges::fill(types, true);
+}
+
+void AccessTracer::record(Type type, word address, byte value,
+                          EmuTime::param time)
+{
+	byte info = type;
+	if (type <= MEM_WRITE) {
+		// cache lines are traced as a whole, check the exact range
+		if ((address < addrBegin) || (address > addrEnd)) return;
+		int page = address >> 14;
+		int ps = interface.getPrimarySlot(page);
+		int ss = interface.getSecondarySlot(page);
+		bool expanded = interface.isExpanded(ps);
+		if ((primarySlot != -1) && (ps != primarySlot)) return;
+		if ((secondarySlot != -1) && (!expanded || (ss != secondarySlot))) return;
+		info |= (ps << 2) | (ss << 4) | (expanded ? 0x40 : 0);
+	}
+	records[head] = Record{(time - EmuTime::zero).length(), address, value, info};
+	if (++head == records.size()) head = 0;
+	++count;
+}
+
+void AccessTracer::start(Interpreter& interp, span<const TclObject> tokens)
+{
+	bool newTypes[4] = { false, false, false, false };
+	bool anyType = false;
+	unsigned newAddrBegin = 0, newAddrEnd = 0xFFFF;
+	unsigned newPortBegin = 0, newPortEnd = 0xFF;
+	int newPrimary = -1, newSecondary = -1;
+	int size = 1000000;
+
+	auto getArg = [&](size_t& i, int min, int max) {
+		if (++i == tokens.size()) {
+			throw CommandException("Missing argument for ",
+			                       tokens[i - 1].getString());
+		}
+		int value = tokens[i].getInt(interp);
+		if ((value < min) || (value > max)) {
+			throw CommandException("Invalid value for ",
+			                       tokens[i - 1].getString(), ": ", value);
+		}
+		return value;
+	};
+	for (size_t i = 2; i < tokens.size(); ++i) {
+		string_view option = tokens[i].getString();
+		if (option == "-read") {
+			newTypes[MEM_READ] = anyType = true;
+		} else if (option == "-write") {
+			newTypes[MEM_WRITE] = anyType = true;
+		} else if (option == "-in") {
+			newTypes[IO_READ] = anyType = true;
+		} else if (option == "-out") {
+			newTypes[IO_WRITE] = anyType = true;
+		} else if (option == "-address") {
+			newAddrBegin = getArg(i, 0, 0xFFFF);
+			newAddrEnd   = getArg(i, newAddrBegin, 0xFFFF);
+		} else if (option == "-port") {
+			newPortBegin = getArg(i, 0, 0xFF);
+			newPortEnd   = getArg(i, newPortBegin, 0xFF);
+		} else if (option == "-slot") {
+			newPrimary = getArg(i, 0, 3);
+		} else if (option == "-subslot") {
+			newSecondary = getArg(i, 0, 3);
+		} else if (option == "-size") {
+			size = getArg(i, 1, 100000000);
+		} else {
+			throw SyntaxError();
+		}
+	}
+
+	if (anyType) {
+		ranges::copy(newTypes, types);
+	} else {
+		ranges::fill(types, true);
+	}
+	addrBegin = newAddrBegin; addrEnd = newAddrEnd;
+	portBegin = newPortBegin; portEnd = newPortEnd;
+	primarySlot = newPrimary; secondarySlot = newSecondary;
+	records.assign(size, Record{0, 0, 0, 0});
+	clear();
+	active = true;
+	update();
+}
+
+void AccessTracer::stop()
+{
+	if (!active) return;
+	active = false;
+	update();
+}
+
+void AccessTracer::clear()
+{
+	head = 0;
+	count = 0;
+}
+
+void AccessTracer::update()
+{
+	for (int i = 0; i < 2; ++i) {
+		tracedPorts[i].reset();
+		if (active && types[IO_READ + i]) {
+			for (unsigned port = portBegin; port <= portEnd; ++port) {
+				tracedPorts[i].set(port);
+			}
+		}
+	}
+	interface.updateAccessTrace();
+}
+
+void AccessTracer::status(TclObject& result) const
+{
+	result.addDictKeyValue("active", active);
+	result.addDictKeyValue("size", uint64_t(records.size()));
+	result.addDictKeyValue("count", std::min<uint64_t>(count, records.size()));
+	result.addDictKeyValue("total", count);
+}
+
+template<typename Op>
+void AccessTracer::forEachRecord(uint64_t num, Op op) const
+{
+	num = std::min<uint64_t>({num, count, records.size()});
+	size_t i = (head + records.size() - num) % std::max<size_t>(records.size(), 1);
+	for (uint64_t n = 0; n < num; ++n) {
+		op(records[i]);
+		if (++i == records.size()) i = 0;
+	}
+}
+
+void AccessTracer::dump(Interpreter& interp, span<const TclObject> tokens,
+                        TclObject& result) const
+{
+	uint64_t num = 100;
+	if (tokens.size() == 3) {
+		int n = tokens[2].getInt(interp);
+		if (n < 0) throw CommandException("Invalid number of records: ", n);
+		num = n;
+	} else if (tokens.size() != 2) {
+		throw SyntaxError();
+	}
+	forEachRecord(num, [&](const Record& r) {
+		unsigned type = r.info & 3;
+		TclObject slot;
+		if (type <= MEM_WRITE) {
+			slot.addListElement((r.info >> 2) & 3);
+			if (r.info & 0x40) {
+				slot.addListElement((r.info >> 4) & 3);
+			}
+		}
+		result.addListElement(makeTclList(
+			double(r.time) / MAIN_FREQ, typeNames[type],
+			unsigned(r.address), unsigned(r.value), slot));
+	});
+}
+
+void AccessTracer::save(span<const TclObject> tokens, TclObject& result) const
+{
+	if (tokens.size() != 3) {
+		throw SyntaxError();
+	}
+	string filename = FileOperations::expandTilde(tokens[2].getString());
+	auto file = FileOperations::openFile(filename, "wb");
+	if (!file) {
+		throw CommandException("Couldn't open ", filename, " for writing");
+	}
+	// 12 bytes per record, little endian:
+	//   8 bytes time, 2 bytes address/port, 1 byte value, 1 byte info
+	vector<byte> buf;
+	forEachRecord(count, [&](const Record& r) {
+		for (int i = 0; i < 8; ++i) buf.push_back(byte(r.time >> (8 * i)));
+		buf.push_back(byte(r.address >> 0));
+		buf.push_back(byte(r.address >> 8));
+		buf.push_back(r.value);
+		buf.push_back(r.info);
+	});
+	if (fwrite(buf.data(), 1, buf.size(), file.get()) != buf.size()) {
+		throw CommandException("Error while writing ", filename);
+	}
+	result = strCat("Saved ", buf.size() / 12, " records to ", filename);
+}
+
+
+// class AccessTracer::Cmd
+
+AccessTracer::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "access_trace")
+{
+}
+
+void AccessTracer::Cmd::execute(span<const TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() < 2) {
+		throw CommandException("Missing argument");
+	}
+	auto& tracer = OUTER(AccessTracer, traceCommand);
+	const string_view subcommand = tokens[1].getString();
+	if (subcommand == "start") {
+		tracer.start(getInterpreter(), tokens);
+	} else if (subcommand == "stop") {
+		if (tokens.size() != 2) throw SyntaxError();
+		tracer.stop();
+	} else if (subcommand == "clear") {
+		if (tokens.size() != 2) throw SyntaxError();
+		tracer.clear();
+	} else if (subcommand == "status") {
+		if (tokens.size() != 2) throw SyntaxError();
+		tracer.status(result);
+	} else if (subcommand == "dump") {
+		tracer.dump(getInterpreter(), tokens, result);
+	} else if (subcommand == "save") {
+		tracer.save(tokens, result);
+	} else {
+		throw SyntaxError();
+	}
+}
+
+string AccessTracer::Cmd::help(const vector<string>& /*tokens*/) const
+{
+	return "Record memory and IO accesses of the CPU in a ring buffer.\n"
+	       "access_trace start [<options>]  (Re)start recording, options are:\n"
+	       "    -read -write -in -out        only record these kinds of accesses\n"
+	       "                                 (default all)\n"
+	       "    -address <begin> <end>       only memory accesses in this range\n"
+	       "    -port <begin> <end>          only IO accesses to these ports\n"
+	       "    -slot <ps> -subslot <ss>     only memory accesses to this (sub)slot\n"
+	       "    -size <records>              size of the ring buffer (default 1000000)\n"
+	       "access_trace stop               Stop recording, the records are kept\n"
+	       "access_trace clear              Remove all records\n"
+	       "access_trace status             Query state and number of records\n"
+	       "access_trace dump [<n>]         The last <n> (default 100) records, each as a\n"
+	       "                                list: {time type address value slot}\n"
+	       "access_trace save <filename>    Save all records in a binary file\n"
+	       "Recording memory accesses makes the emulation slower for the traced address "
+	       "range, just like a watchpoint does.";
+}
+
+void AccessTracer::Cmd::tabCompletion(vector<string>& tokens) const
+{
+	if (tokens.size() == 2) {
+		static const char* const cmds[] = {
+			"start", "stop", "clear", "status", "dump", "save",
+		};
+		completeString(tokens, cmds);
+	} else if ((tokens.size() >= 3) && (tokens[1] == "start")) {
+		static const char* const options[] = {
+			"-read", "-write", "-in", "-out", "-address", "-port",
+			"-slot", "-subslot", "-size",
+		};
+		completeString(tokens, options);
+	} else if ((tokens.size() == 3) && (tokens[1] == "save")) {
+		completeFileName(tokens, userFileContext());
+	}
+}
+
+} // namespace openmsx
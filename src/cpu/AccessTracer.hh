@@ -0,0 +1,104 @@
+#ifndef ACCESSTRACER_HH
+#define ACCESSTRACER_HH
+
+#include "Command.hh"
+#include "EmuTime.hh"
+#include "CacheLine.hh"
+#include "openmsx.hh"
+#include "span.hh"
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+class MSXCPUInterface;
+class TclObject;
+class Interpreter;
+
+/** Records memory and IO accesses of the CPU in a ring buffer (see the
+  * 'access_trace' command). This is a lot faster than logging accesses
+  * from the Tcl callback of a watchpoint.
+  *
+  * Like watchpoints, memory accesses can only be seen when the CPU doesn't
+  * access the memory directly via its cache. So MSXCPUInterface disallows
+  * caching for the cache lines that overlap with the address filter (see
+  * isLineTraced()), and calls record() from readMemSlow()/writeMemSlow().
+  * For IO the check is a lookup in a table per port (isPortTraced()).
+  */
+class AccessTracer
+{
+public:
+	enum Type : byte { MEM_READ, MEM_WRITE, IO_READ, IO_WRITE };
+
+	/** A single access. */
+	struct Record {
+		uint64_t time; // in EmuTime ticks (MAIN_FREQ)
+		word address;  // memory address or IO port
+		byte value;
+		byte info;     // bits 0-1: Type
+		               // memory only: bits 2-3 primary slot,
+		               //              bits 4-5 secondary slot,
+		               //              bit 6 primary slot is expanded
+	};
+
+	AccessTracer(MSXMotherBoard& motherBoard, MSXCPUInterface& interface);
+
+	/** Should memory accesses of the given type in the given cache line
+	  * go via record()? */
+	bool isLineTraced(Type type, unsigned line) const {
+		return active && types[type] &&
+		       (addrBegin <= ((line << CacheLine::BITS) + CacheLine::LOW)) &&
+		       ((line << CacheLine::BITS) <= addrEnd);
+	}
+
+	/** Should accesses to this IO port go via record()? */
+	bool isPortTraced(Type type, word port) const {
+		return tracedPorts[type - IO_READ][port & 0xFF];
+	}
+
+	/** Record an access (if it passes the filters). */
+	void record(Type type, word address, byte value, EmuTime::param time);
+
+private:
+	void start(Interpreter& interp, span<const TclObject> tokens);
+	void stop();
+	void clear();
+	void update();
+	void status(TclObject& result) const;
+	void dump(Interpreter& interp, span<const TclObject> tokens,
+	          TclObject& result) const;
+	void save(span<const TclObject> tokens, TclObject& result) const;
+
+	/** Call 'op(record)' for the last 'num' records, oldest first. */
+	template<typename Op> void forEachRecord(uint64_t num, Op op) const;
+
+	MSXCPUInterface& interface;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(span<const TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} traceCommand;
+
+	std::vector<Record> records; // ring buffer
+	size_t head;     // position of the next record
+	uint64_t count;  // total number of records (possibly overwritten)
+
+	// filters
+	bool types[4];
+	unsigned addrBegin, addrEnd; // memory addresses (inclusive)
+	unsigned portBegin, portEnd; // IO ports (inclusive)
+	int primarySlot;   // -1 for any slot
+	int secondarySlot; // -1 for any subslot
+	std::bitset<256> tracedPorts[2];
+
+	bool active;
+};
+
+} // namespace openmsx
+
+#endif
@@ -1,23 +1,44 @@
 #include "BreakPointBase.hh"
+#include "DebugExpression.hh"
+#include "Debugger.hh"
 #include "CommandException.hh"
 #include "GlobalCliComm.hh"
 #include "ScopedAssign.hh"
 
 namespace openmsx {
 
+class DebuggerContext final : public DebugExpression::Context
+{
+public:
+	explicit DebuggerContext(Debugger& debugger_) : debugger(debugger_) {}
+	Debuggable* findDebuggable(string_view name) override {
+		return debugger.findDebuggable(name);
+	}
+private:
+	Debugger& debugger;
+};
+
 BreakPointBase::BreakPointBase(TclObject command_, TclObject condition_)
 	: command(std::move(command_)), condition(std::move(condition_))
 	, executing(false)
 {
+	if (!condition.getString().empty()) {
+		compiledCondition = DebugExpression::compile(condition.getString());
+	}
 }
 
-bool BreakPointBase::isTrue(GlobalCliComm& cliComm, Interpreter& interp) const
+bool BreakPointBase::isTrue(GlobalCliComm& cliComm, Interpreter& interp,
+                            Debugger& debugger) const
 {
 	if (condition.getString().empty()) {
 		// unconditional bp
 		return true;
 	}
 	try {
+		if (compiledCondition) {
+			DebuggerContext context(debugger);
+			return compiledCondition->eval(context) != 0;
+		}
 		return condition.evalBool(interp);
 	} catch (CommandException& e) {
 		cliComm.printWarning(e.getMessage());
@@ -25,14 +46,15 @@ bool BreakPointBase::isTrue(GlobalCliComm& cliComm, Interpreter& interp) const
 	}
 }
 
-void BreakPointBase::checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp)
+void BreakPointBase::checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp,
+                                     Debugger& debugger)
 {
 	if (executing) {
 		// no recursive execution
 		return;
 	}
 	ScopedAssign<bool> sa(executing, true);
-	if (isTrue(cliComm, interp)) {
+	if (isTrue(cliComm, interp, debugger)) {
 		try {
 			command.executeCommand(interp, true); // compile command
 		} catch (CommandException& e) {
@@ -3,11 +3,14 @@
 
 #include "TclObject.hh"
 #include "string_view.hh"
+#include <memory>
 
 namespace openmsx {
 
 class Interpreter;
 class GlobalCliComm;
+class Debugger;
+class DebugExpression;
 
 /** Base class for CPU break and watch points.
  */
@@ -19,7 +22,8 @@ public:
 	TclObject getConditionObj() const { return condition; }
 	TclObject getCommandObj()   const { return command; }
 
-	void checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp);
+	void checkAndExecute(GlobalCliComm& cliComm, Interpreter& interp,
+	                     Debugger& debugger);
 
 protected:
 	// Note: we require GlobalCliComm here because breakpoint objects can
@@ -28,10 +32,14 @@ protected:
 	BreakPointBase(TclObject command, TclObject condition);
 
 private:
-	bool isTrue(GlobalCliComm& cliComm, Interpreter& interp) const;
+	bool isTrue(GlobalCliComm& cliComm, Interpreter& interp,
+	            Debugger& debugger) const;
 
 	TclObject command;
 	TclObject condition;
+	/** Native version of 'condition', nullptr when it must be evaluated
+	  * by Tcl. Shared, because breakpoints get copied a lot. */
+	std::shared_ptr<const DebugExpression> compiledCondition;
 	bool executing;
 };
 
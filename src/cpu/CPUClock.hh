@@ -37,6 +37,11 @@ protected:
 	EmuTime getTimeFast(int cc) const {
 		return clock.getFastAdd(limit - remaining + cc);
 	}
+	/** Only meaningful as the difference between two calls (e.g. the
+	  * number of cycles taken by one instruction, see CPUProfiler). */
+	uint64_t getTotalTicksFast() const {
+		return clock.getTotalTicks() + (limit - remaining);
+	}
 	void setTime(EmuTime::param time) { sync(); clock.reset(time); }
 	void setFreq(unsigned freq) { clock.setFreq(freq); }
 	void advanceTime(EmuTime::param time);
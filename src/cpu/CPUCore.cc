@@ -165,6 +165,9 @@
 #include "CliComm.hh"
 #include "TclCallback.hh"
 #include "Dasm.hh"
+#include "CPUTraceWriter.hh"
+#include "CPUProfiler.hh"
+#include "MemoryCoverage.hh"
 #include "Z80.hh"
 #include "R800.hh"
 #include "Thread.hh"
@@ -302,6 +305,7 @@ template<class T> CPUCore<T>::CPUCore(
 		TclCallback& diHaltCallback_, EmuTime::param time)
 	: CPURegs(T::isR800())
 	, T(time, motherboard_.getScheduler())
+	, coverage(nullptr)
 	, motherboard(motherboard_)
 	, scheduler(motherboard.getScheduler())
 	, interface(nullptr)
@@ -328,6 +332,9 @@ template<class T> CPUCore<T>::CPUCore(
 	, nmiEdge(false)
 	, exitLoop(false)
 	, tracingEnabled(traceSetting.getBoolean())
+	, traceWriter(nullptr)
+	, profiler(nullptr)
+	, profileStartTicks(0)
 	, isTurboR(motherboard.isTurboR())
 {
 	static_assert(!std::is_polymorphic<CPUCore<T>>::value,
@@ -357,6 +364,20 @@ template<class T> void CPUCore<T>::invalidateMemCache(unsigned start, unsigned s
 	memset(&writeCacheTried[first], 0, num * sizeof(bool));  //
 }
 
+template<class T> void CPUCore<T>::setCoverage(MemoryCoverage* coverage_)
+{
+	coverage = coverage_;
+	if (coverage) {
+		// normally filled in together with the memory cache
+		byte* dummy = coverage->getFlags(nullptr);
+		for (unsigned i = 0; i < CacheLine::NUM; ++i) {
+			readCoverage [i] = dummy - i * CacheLine::SIZE;
+			writeCoverage[i] = dummy - i * CacheLine::SIZE;
+		}
+	}
+	invalidateMemCache(0x0000, 0x10000);
+}
+
 template<class T> void CPUCore<T>::doReset(EmuTime::param time)
 {
 	// AF and SP are 0xFFFF
@@ -536,14 +557,23 @@ static void toHex(byte x, char* buf)
 	buf[1] = toHex(x & 15);
 }
 
+static void peekOpcode(const MSXCPUInterface& interf, word pc, byte buf[4],
+                       EmuTime::param time)
+{
+	// peeking has no side effects, so just always peek the max length
+	for (unsigned i = 0; i < 4; ++i) {
+		buf[i] = interf.peekMem(word(pc + i), time);
+	}
+}
+
 template<class T> void CPUCore<T>::disasmCommand(
 	Interpreter& interp, span<const TclObject> tokens, TclObject& result) const
 {
 	word address = (tokens.size() < 3) ? getPC() : tokens[2].getInt(interp);
 	byte outBuf[4];
+	peekOpcode(*interface, address, outBuf, T::getTimeFast());
 	std::string dasmOutput;
-	unsigned len = dasm(*interface, address, outBuf, dasmOutput,
-	               T::getTimeFast());
+	unsigned len = dasm(outBuf, address, dasmOutput);
 	result.addListElement(dasmOutput);
 	char tmp[3]; tmp[2] = 0;
 	for (unsigned i = 0; i < len; ++i) {
@@ -598,6 +628,22 @@ template<class T> inline void CPUCore<T>::WRITE_PORT(unsigned port, byte value,
 	// note: no forced page-break after IO
 }
 
+// Mark coverage flags. The pointers in readCoverage/writeCoverage are valid
+// for each address that was accessed via RDMEMslow() or WRMEMslow() since
+// the last invalidateMemCache(), so these must be called after the access.
+template<class T> ALWAYS_INLINE void CPUCore<T>::coverRead(unsigned address, byte flag)
+{
+	if (unlikely(coverage != nullptr)) {
+		readCoverage[address >> CacheLine::BITS][address] |= flag;
+	}
+}
+template<class T> ALWAYS_INLINE void CPUCore<T>::coverWrite(unsigned address)
+{
+	if (unlikely(coverage != nullptr)) {
+		writeCoverage[address >> CacheLine::BITS][address] |= MemoryCoverage::WRITTEN;
+	}
+}
+
 template<class T> template<bool PRE_PB, bool POST_PB>
 NEVER_INLINE byte CPUCore<T>::RDMEMslow(unsigned address, unsigned cc)
 {
@@ -611,11 +657,29 @@ NEVER_INLINE byte CPUCore<T>::RDMEMslow(unsigned address, unsigned cc)
 			T::template PRE_MEM<PRE_PB, POST_PB>(address);
 			T::template POST_MEM<       POST_PB>(address);
 			readCacheLine[high] = line - addrBase;
+			if (unlikely(coverage != nullptr)) {
+				readCoverage[high] = coverage->getFlags(line) - addrBase;
+			}
 			return readCacheLine[high][address];
 		}
+		const byte* watchLine = interface->getWatchedReadCacheLine(addrBase);
+		readWatchLine[high] = watchLine ? watchLine - addrBase : nullptr;
+		if (unlikely(coverage != nullptr)) {
+			// e.g. not cacheable because of a watchpoint
+			readCoverage[high] = coverage->getFlags(
+				interface->getDeviceReadCacheLine(addrBase)) - addrBase;
+		}
 	}
-	// uncacheable
 	readCacheTried[high] = true;
+	if (const byte* line = readWatchLine[high]) {
+		if (!interface->isReadWatched(address)) {
+			// line contains a watchpoint, but not on this address
+			T::template PRE_MEM<PRE_PB, POST_PB>(address);
+			T::template POST_MEM<       POST_PB>(address);
+			return line[address];
+		}
+	}
+	// uncacheable
 	T::template PRE_MEM<PRE_PB, POST_PB>(address);
 	EmuTime time = T::getTimeFast(cc);
 	scheduler.schedule(time);
@@ -655,11 +719,15 @@ template<class T> template<unsigned PC_OFFSET> ALWAYS_INLINE byte CPUCore<T>::RD
 	// faster to only update PC once per instruction instead of after each
 	// fetch.
 	unsigned address = (getPC() + PC_OFFSET) & 0xFFFF;
-	return RDMEM_impl<false, false>(address, cc);
+	byte result = RDMEM_impl<false, false>(address, cc);
+	coverRead(address, MemoryCoverage::EXECUTED);
+	return result;
 }
 template<class T> ALWAYS_INLINE byte CPUCore<T>::RDMEM(unsigned address, unsigned cc)
 {
-	return RDMEM_impl<true, true>(address, cc);
+	byte result = RDMEM_impl<true, true>(address, cc);
+	coverRead(address, MemoryCoverage::READ);
+	return result;
 }
 
 template<class T> template<bool PRE_PB, bool POST_PB>
@@ -693,12 +761,18 @@ ALWAYS_INLINE unsigned CPUCore<T>::RD_WORD_impl(unsigned address, unsigned cc)
 template<class T> template<unsigned PC_OFFSET> ALWAYS_INLINE unsigned CPUCore<T>::RD_WORD_PC(unsigned cc)
 {
 	unsigned addr = (getPC() + PC_OFFSET) & 0xFFFF;
-	return RD_WORD_impl<false, false>(addr, cc);
+	unsigned result = RD_WORD_impl<false, false>(addr, cc);
+	coverRead( addr,                MemoryCoverage::EXECUTED);
+	coverRead((addr + 1) & 0xFFFF, MemoryCoverage::EXECUTED);
+	return result;
 }
 template<class T> ALWAYS_INLINE unsigned CPUCore<T>::RD_WORD(
 	unsigned address, unsigned cc)
 {
-	return RD_WORD_impl<true, true>(address, cc);
+	unsigned result = RD_WORD_impl<true, true>(address, cc);
+	coverRead( address,                MemoryCoverage::READ);
+	coverRead((address + 1) & 0xFFFF, MemoryCoverage::READ);
+	return result;
 }
 
 template<class T> template<bool PRE_PB, bool POST_PB>
@@ -715,16 +789,37 @@ NEVER_INLINE void CPUCore<T>::WRMEMslow(unsigned address, byte value, unsigned c
 			T::template POST_MEM<       POST_PB>(address);
 			writeCacheLine[high] = line - addrBase;
 			writeCacheLine[high][address] = value;
+			if (unlikely(coverage != nullptr)) {
+				writeCoverage[high] = coverage->getFlags(line) - addrBase;
+				writeCoverage[high][address] |= MemoryCoverage::WRITTEN;
+			}
+			return;
+		}
+		byte* watchLine = interface->getWatchedWriteCacheLine(addrBase);
+		writeWatchLine[high] = watchLine ? watchLine - addrBase : nullptr;
+		if (unlikely(coverage != nullptr)) {
+			writeCoverage[high] = coverage->getFlags(
+				interface->getDeviceWriteCacheLine(addrBase)) - addrBase;
+		}
+	}
+	writeCacheTried[high] = true;
+	if (byte* line = writeWatchLine[high]) {
+		if (!interface->isWriteWatched(address)) {
+			// line contains a watchpoint, but not on this address
+			T::template PRE_MEM<PRE_PB, POST_PB>(address);
+			T::template POST_MEM<       POST_PB>(address);
+			line[address] = value;
+			coverWrite(address);
 			return;
 		}
 	}
 	// uncacheable
-	writeCacheTried[high] = true;
 	T::template PRE_MEM<PRE_PB, POST_PB>(address);
 	EmuTime time = T::getTimeFast(cc);
 	scheduler.schedule(time);
 	interface->writeMem(address, value, time);
 	T::template POST_MEM<POST_PB>(address);
+	coverWrite(address);
 }
 template<class T> template<bool PRE_PB, bool POST_PB>
 ALWAYS_INLINE void CPUCore<T>::WRMEM_impl2(
@@ -736,6 +831,7 @@ ALWAYS_INLINE void CPUCore<T>::WRMEM_impl2(
 		T::template PRE_MEM<PRE_PB, POST_PB>(address);
 		T::template POST_MEM<       POST_PB>(address);
 		line[address] = value;
+		coverWrite(address);
 	} else {
 		WRMEMslow<PRE_PB, POST_PB>(address, value, cc); // not inlined
 	}
@@ -769,6 +865,8 @@ template<class T> ALWAYS_INLINE void CPUCore<T>::WR_WORD(
 		T::template PRE_WORD<true, true>(address);
 		T::template POST_WORD<     true>(address);
 		Endian::write_UA_L16(&line[address], value);
+		coverWrite(address);
+		coverWrite(address + 1);
 	} else {
 		// slow path, not inline
 		WR_WORD_slow(address, value, cc);
@@ -793,6 +891,8 @@ ALWAYS_INLINE void CPUCore<T>::WR_WORD_rev2(
 		T::template PRE_WORD<PRE_PB, POST_PB>(address);
 		T::template POST_WORD<       POST_PB>(address);
 		Endian::write_UA_L16(&line[address], value);
+		coverWrite(address);
+		coverWrite(address + 1);
 	} else {
 		// slow path, not inline
 		WR_WORD_rev_slow<PRE_PB, POST_PB>(address, value, cc);
@@ -918,6 +1018,7 @@ void CPUCore<T>::executeInstructions()
 			T::template PRE_MEM<false, false>(address); \
 			T::template POST_MEM<      false>(address); \
 			byte op = line[address]; \
+			coverRead(address, MemoryCoverage::EXECUTED); \
 			goto *(opcodeTable[op]); \
 		} else { \
 			goto fetchSlow; \
@@ -984,6 +1085,7 @@ start:
 fetchSlow: {
 	unsigned address = getPC();
 	byte opcodeSlow = RDMEMslow<false, false>(address, T::CC_MAIN);
+	coverRead(address, MemoryCoverage::EXECUTED);
 	goto *(opcodeTable[opcodeSlow]);
 }
 #endif
@@ -2462,18 +2564,44 @@ xx_cb: {
 template<class T> inline void CPUCore<T>::cpuTracePre()
 {
 	start_pc = getPC();
+	if (unlikely(profiler != nullptr)) {
+		profileStartTicks = T::getTotalTicksFast();
+	}
 }
 template<class T> inline void CPUCore<T>::cpuTracePost()
 {
 	if (unlikely(tracingEnabled)) {
 		cpuTracePost_slow();
 	}
+	if (unlikely(profiler != nullptr)) {
+		profiler->addInstruction(
+			start_pc, unsigned(T::getTotalTicksFast() - profileStartTicks));
+	}
 }
 template<class T> void CPUCore<T>::cpuTracePost_slow()
 {
 	byte opbuf[4];
+	peekOpcode(*interface, start_pc, opbuf, T::getTimeFast());
+	if (traceWriter) {
+		// Only store the raw data, disassembling and formatting is
+		// done offline (see Contrib/cputrace-decode.cc).
+		auto& rec = traceWriter->newRecord();
+		rec.time = (T::getTimeFast() - EmuTime::zero).length();
+		rec.pc = start_pc;
+		rec.af = getAF();
+		rec.bc = getBC();
+		rec.de = getDE();
+		rec.hl = getHL();
+		rec.ix = getIX();
+		rec.iy = getIY();
+		rec.sp = getSP();
+		memcpy(rec.opcode, opbuf, sizeof(opbuf));
+		rec.cpu = T::isR800() ? 1 : 0;
+		memset(rec.pad, 0, sizeof(rec.pad));
+		return;
+	}
 	string dasmOutput;
-	dasm(*interface, start_pc, opbuf, dasmOutput, T::getTimeFast());
+	dasm(opbuf, start_pc, dasmOutput);
 	std::cout << std::setfill('0') << std::hex << std::setw(4) << start_pc
 	     << " : " << dasmOutput
 	     << " AF=" << std::setw(4) << getAF()
@@ -2592,8 +2720,8 @@ template<class T> void CPUCore<T>::execute2(bool fastForward)
 	// deciding between executeFast() and executeSlow() (because a
 	// SyncPoint could set an IRQ and then we must choose executeSlow())
 	if (fastForward ||
-	    (!interface->anyBreakPoints() && !tracingEnabled)) {
-		// fast path, no breakpoints, no tracing
+	    (!interface->anyBreakPoints() && !tracingEnabled && !profiler)) {
+		// fast path, no breakpoints, no tracing, no exact profiling
 		while (!needExitCPULoop()) {
 			if (slowInstructions) {
 				--slowInstructions;
@@ -3994,6 +4122,8 @@ template<class T> II CPUCore<T>::djnz() {
 // EX (SP),ss
 template<class T> template<Reg16 REG, int EE> II CPUCore<T>::ex_xsp_SS() {
 	unsigned res = RD_WORD_impl<true, false>(getSP(), T::CC_EX_SP_HL_1 + EE);
+	coverRead( getSP(),                MemoryCoverage::READ);
+	coverRead((getSP() + 1) & 0xFFFF, MemoryCoverage::READ);
 	T::setMemPtr(res);
 	WR_WORD_rev<false, true>(getSP(), get16<REG>(), T::CC_EX_SP_HL_2 + EE);
 	set16<REG>(res);
@@ -16,6 +16,9 @@
 namespace openmsx {
 
 class MSXCPUInterface;
+class CPUTraceWriter;
+class CPUProfiler;
+class MemoryCoverage;
 class Scheduler;
 class MSXMotherBoard;
 class TclCallback;
@@ -49,6 +52,18 @@ public:
 
 	void setInterface(MSXCPUInterface* interf) { interface = interf; }
 
+	/** When set, the instruction trace (see 'cputrace' setting) is
+	  * written in binary form to this writer instead of to stdout. */
+	void setTraceWriter(CPUTraceWriter* writer) { traceWriter = writer; }
+
+	/** When set, every executed instruction is reported to this profiler
+	  * (this forces the slow emulation path, like tracing does). */
+	void setProfiler(CPUProfiler* profiler_) { profiler = profiler_; }
+
+	/** When set, all memory accesses are marked in this coverage
+	  * tracker. This keeps using the memory cache. */
+	void setCoverage(MemoryCoverage* coverage);
+
 	/**
 	 * Reset the CPU.
 	 */
@@ -126,6 +141,17 @@ private:
 	byte* writeCacheLine[CacheLine::NUM];
 	bool readCacheTried [CacheLine::NUM];
 	bool writeCacheTried[CacheLine::NUM];
+	// For lines that are only uncacheable because of watchpoints, the
+	// non-watched addresses can still be accessed directly (or nullptr).
+	// Only valid when the corresponding xxxCacheTried is set.
+	const byte* readWatchLine[CacheLine::NUM];
+	byte* writeWatchLine[CacheLine::NUM];
+
+	// coverage flags, only valid when 'coverage' is set, updated together
+	// with the memory cache
+	MemoryCoverage* coverage; // can be nullptr
+	byte* readCoverage [CacheLine::NUM];
+	byte* writeCoverage[CacheLine::NUM];
 
 	MSXMotherBoard& motherboard;
 	Scheduler& scheduler;
@@ -157,6 +183,9 @@ private:
 
 	/** In sync with traceSetting.getBoolean(). */
 	bool tracingEnabled;
+	CPUTraceWriter* traceWriter; // can be nullptr
+	CPUProfiler* profiler; // can be nullptr
+	uint64_t profileStartTicks;
 
 	/** 'normal' Z80 and Z80 in a turboR behave slightly different */
 	const bool isTurboR;
@@ -169,6 +198,9 @@ private:
 	inline byte READ_PORT(unsigned port, unsigned cc);
 	inline void WRITE_PORT(unsigned port, byte value, unsigned cc);
 
+	inline void coverRead (unsigned address, byte flag);
+	inline void coverWrite(unsigned address);
+
 	template<bool PRE_PB, bool POST_PB>
 	byte RDMEMslow(unsigned address, unsigned cc);
 	template<bool PRE_PB, bool POST_PB>
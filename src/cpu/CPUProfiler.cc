@@ -0,0 +1,300 @@
+#include "CPUProfiler.hh"
+#include "MSXMotherBoard.hh"
+#include "MSXCPU.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXDevice.hh"
+#include "CPURegs.hh"
+#include "CommandException.hh"
+#include "FileContext.hh"
+#include "FileOperations.hh"
+#include "TclObject.hh"
+#include "outer.hh"
+#include "ranges.hh"
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+
+using std::string;
+using std::vector;
+
+namespace openmsx {
+
+static const CPUProfiler::Key INVALID_KEY = CPUProfiler::Key(-1);
+
+CPUProfiler::CPUProfiler(MSXMotherBoard& motherBoard_, MSXCPU& cpu_)
+	: Schedulable(motherBoard_.getScheduler())
+	, motherBoard(motherBoard_)
+	, cpu(cpu_)
+	, profileCommand(motherBoard.getCommandController())
+	, mode(OFF)
+	, interval(1000)
+	, lastSample(EmuTime::zero)
+	, random(1)
+{
+	ranges::fill(cachedKey, INVALID_KEY);
+	ranges::fill(cachedCounters, nullptr);
+}
+
+CPUProfiler::~CPUProfiler()
+{
+	stop();
+}
+
+CPUProfiler::Counters& CPUProfiler::getCounters(word pc)
+{
+	unsigned page = pc >> 14;
+	unsigned region = pc / REGION_SIZE;
+	auto& interface = motherBoard.getCPUInterface();
+	Key key = makeKey(interface.getPrimarySlot(page),
+	                  interface.getSecondarySlot(page), region,
+	                  interface.getVisibleDevice(page)->getVisibleBlock(pc));
+	if (key != cachedKey[region]) {
+		auto& counters = regions[key];
+		if (counters.empty()) counters.resize(REGION_SIZE, Counters{0, 0});
+		cachedKey[region] = key;
+		cachedCounters[region] = counters.data();
+	}
+	return cachedCounters[region][pc % REGION_SIZE];
+}
+
+void CPUProfiler::start(Mode newMode, unsigned newInterval)
+{
+	stop();
+	mode = newMode;
+	interval = newInterval;
+	if (mode == EXACT) {
+		cpu.setProfiler(this);
+	} else {
+		lastSample = getCurrentTime();
+		scheduleSample(lastSample);
+	}
+}
+
+void CPUProfiler::stop()
+{
+	if (mode == EXACT) {
+		cpu.setProfiler(nullptr);
+	} else if (mode == SAMPLE) {
+		removeSyncPoints();
+	}
+	mode = OFF;
+}
+
+void CPUProfiler::clear()
+{
+	regions.clear();
+	ranges::fill(cachedKey, INVALID_KEY);
+	ranges::fill(cachedCounters, nullptr);
+}
+
+void CPUProfiler::scheduleSample(EmuTime::param time)
+{
+	// Spread the samples uniformly over [interval/2, 3*interval/2).
+	random = random * 1664525 + 1013904223;
+	unsigned cycles = interval / 2 + (random >> 8) % interval;
+	setSyncPoint(time + EmuDuration::hz(cpu.getFreq()) * std::max(cycles, 1u));
+}
+
+void CPUProfiler::executeUntil(EmuTime::param time)
+{
+	assert(mode == SAMPLE);
+	auto& c = getCounters(cpu.getRegisters().getPC());
+	c.count += 1;
+	c.cycles += (time - lastSample).getTicksAt(cpu.getFreq());
+	lastSample = time;
+	scheduleSample(time);
+}
+
+void CPUProfiler::processStart(Interpreter& interp, span<const TclObject> tokens)
+{
+	Mode newMode = SAMPLE;
+	unsigned newInterval = 1000;
+	for (size_t i = 2; i < tokens.size(); ++i) {
+		string_view token = tokens[i].getString();
+		if (token == "-exact") {
+			newMode = EXACT;
+		} else if (token == "-interval") {
+			if (++i == tokens.size()) {
+				throw CommandException("Missing argument for -interval");
+			}
+			int value = tokens[i].getInt(interp);
+			if (value < 1) {
+				throw CommandException("Interval must be at least 1");
+			}
+			newInterval = value;
+		} else {
+			throw SyntaxError();
+		}
+	}
+	start(newMode, newInterval);
+}
+
+void CPUProfiler::status(TclObject& result) const
+{
+	static const char* const modeNames[] = { "off", "sample", "exact" };
+	uint64_t count = 0;
+	uint64_t cycles = 0;
+	for (auto& r : regions) {
+		for (auto& c : r.second) {
+			count  += c.count;
+			cycles += c.cycles;
+		}
+	}
+	result.addDictKeyValue("mode", modeNames[mode]);
+	if (mode == SAMPLE) {
+		result.addDictKeyValue("interval", interval);
+	}
+	result.addDictKeyValue("count", count);
+	result.addDictKeyValue("cycles", cycles);
+}
+
+// Calls 'op(address, ps, ss, block, counters)' for all addresses that got
+// executed (or sampled) at least once.
+template<typename Op>
+static void forEachAddress(
+	const std::map<CPUProfiler::Key, vector<CPUProfiler::Counters>>& regions,
+	unsigned regionSize, Op op)
+{
+	for (auto& r : regions) {
+		CPUProfiler::Key key = r.first;
+		unsigned region = key & 7;
+		byte ss = (key >> 3) & 3;
+		byte ps = (key >> 5) & 3;
+		int block = int(key >> 8) - 1;
+		for (unsigned i = 0; i < regionSize; ++i) {
+			auto& c = r.second[i];
+			if (c.count == 0) continue;
+			op(region * regionSize + i, ps, ss, block, c);
+		}
+	}
+}
+
+void CPUProfiler::top(Interpreter& interp, span<const TclObject> tokens,
+                      TclObject& result) const
+{
+	unsigned num = 20;
+	if (tokens.size() == 3) {
+		num = tokens[2].getInt(interp);
+	} else if (tokens.size() != 2) {
+		throw SyntaxError();
+	}
+
+	struct Entry {
+		unsigned address;
+		byte ps, ss;
+		int block;
+		Counters counters;
+	};
+	vector<Entry> entries;
+	forEachAddress(regions, REGION_SIZE,
+		[&](unsigned address, byte ps, byte ss, int block, const Counters& c) {
+			entries.push_back({address, ps, ss, block, c});
+		});
+	num = std::min<size_t>(num, entries.size());
+	std::partial_sort(entries.begin(), entries.begin() + num, entries.end(),
+		[](const Entry& x, const Entry& y) {
+			return x.counters.cycles > y.counters.cycles;
+		});
+	for (unsigned i = 0; i < num; ++i) {
+		auto& e = entries[i];
+		result.addListElement(TclObject(TclObject::MakeListTag{},
+			e.address, unsigned(e.ps), unsigned(e.ss), e.block,
+			e.counters.count, e.counters.cycles));
+	}
+}
+
+void CPUProfiler::save(span<const TclObject> tokens, TclObject& result) const
+{
+	if (tokens.size() != 3) {
+		throw SyntaxError();
+	}
+	string filename = FileOperations::expandTilde(tokens[2].getString());
+	auto file = FileOperations::openFile(filename, "wt");
+	if (!file) {
+		throw CommandException("Couldn't open ", filename, " for writing");
+	}
+	fprintf(file.get(), "# address,primary slot,secondary slot,block,%s,cycles\n",
+	        (mode == SAMPLE) ? "samples" : "instructions");
+	forEachAddress(regions, REGION_SIZE,
+		[&](unsigned address, byte ps, byte ss, int block, const Counters& c) {
+			fprintf(file.get(), "0x%04X,%d,%d,%d,%" PRIu64 ",%" PRIu64 "\n",
+			        address, ps, ss, block, c.count, c.cycles);
+		});
+	if (ferror(file.get())) {
+		throw CommandException("Error while writing ", filename);
+	}
+	result = "Profile saved to " + filename;
+}
+
+
+// class CPUProfiler::Cmd
+
+CPUProfiler::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "cpu_profile")
+{
+}
+
+void CPUProfiler::Cmd::execute(span<const TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() < 2) {
+		throw CommandException("Missing argument");
+	}
+	auto& profiler = OUTER(CPUProfiler, profileCommand);
+	const string_view subcommand = tokens[1].getString();
+	if (subcommand == "start") {
+		profiler.processStart(getInterpreter(), tokens);
+	} else if (subcommand == "stop") {
+		if (tokens.size() != 2) throw SyntaxError();
+		profiler.stop();
+	} else if (subcommand == "clear") {
+		if (tokens.size() != 2) throw SyntaxError();
+		profiler.clear();
+	} else if (subcommand == "status") {
+		if (tokens.size() != 2) throw SyntaxError();
+		profiler.status(result);
+	} else if (subcommand == "top") {
+		profiler.top(getInterpreter(), tokens, result);
+	} else if (subcommand == "save") {
+		profiler.save(tokens, result);
+	} else {
+		throw SyntaxError();
+	}
+}
+
+string CPUProfiler::Cmd::help(const vector<string>& /*tokens*/) const
+{
+	return "Profile where the emulated CPU spends its time.\n"
+	       "cpu_profile start [-exact] [-interval <cycles>]\n"
+	       "                            Start profiling, by default a PC sample is taken\n"
+	       "                            about every 1000 cycles, -exact counts every\n"
+	       "                            instruction (much slower)\n"
+	       "cpu_profile stop            Stop profiling, the results are kept\n"
+	       "cpu_profile clear           Clear the results\n"
+	       "cpu_profile status          Query profiler state and totals\n"
+	       "cpu_profile top [<n>]       The <n> (default 20) addresses with the most\n"
+	       "                            cycles, each as a list:\n"
+	       "                            {address primary-slot secondary-slot block count cycles}\n"
+	       "cpu_profile save <filename> Save all results as CSV\n"
+	       "The block is the memory mapper segment or ROM bank that was visible at that "
+	       "address (-1 if not applicable).";
+}
+
+void CPUProfiler::Cmd::tabCompletion(vector<string>& tokens) const
+{
+	if (tokens.size() == 2) {
+		static const char* const cmds[] = {
+			"start", "stop", "clear", "status", "top", "save",
+		};
+		completeString(tokens, cmds);
+	} else if ((tokens.size() >= 3) && (tokens[1] == "start")) {
+		static const char* const options[] = {
+			"-exact", "-interval",
+		};
+		completeString(tokens, options);
+	} else if ((tokens.size() == 3) && (tokens[1] == "save")) {
+		completeFileName(tokens, userFileContext());
+	}
+}
+
+} // namespace openmsx
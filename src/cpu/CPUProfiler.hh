@@ -0,0 +1,111 @@
+#ifndef CPUPROFILER_HH
+#define CPUPROFILER_HH
+
+#include "Schedulable.hh"
+#include "Command.hh"
+#include "EmuTime.hh"
+#include "openmsx.hh"
+#include "span.hh"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+class MSXCPU;
+class TclObject;
+class Interpreter;
+
+/** Measures where the emulated software spends its time (see the
+  * 'cpu_profile' command).
+  *
+  * Two modes are supported:
+  *  - sample: every 'interval' CPU cycles (with some jitter to avoid
+  *    aliasing with periodic code) the current PC is sampled and the
+  *    elapsed cycles are attributed to it. This only costs a few percent
+  *    of emulation speed.
+  *  - exact: every executed instruction is counted, together with the
+  *    number of cycles it took. Like 'cputrace' this forces the CPU
+  *    emulation in its slow path, so it's (a lot) slower.
+  *
+  * The counters are kept in flat arrays per 8kB region of the 64kB address
+  * space, separately for each combination of (sub)slot and the memory
+  * block that was visible in that region (e.g. the memory mapper segment
+  * or ROM bank, see MSXDevice::getVisibleBlock()).
+  */
+class CPUProfiler final : public Schedulable
+{
+public:
+	enum Mode { OFF, SAMPLE, EXACT };
+
+	struct Counters {
+		uint64_t count;  // instructions (exact) or samples (sample)
+		uint64_t cycles;
+	};
+	/** Identifies (sub)slot, region and block, see makeKey(). */
+	using Key = uint32_t;
+
+	CPUProfiler(MSXMotherBoard& motherBoard, MSXCPU& cpu);
+	~CPUProfiler();
+
+	/** Called by CPUCore after each instruction, only in EXACT mode. */
+	void addInstruction(word pc, unsigned cycles) {
+		auto& c = getCounters(pc);
+		c.count += 1;
+		c.cycles += cycles;
+	}
+
+private:
+	static const unsigned REGION_SIZE = 0x2000;
+	static const unsigned NUM_REGIONS = 0x10000 / REGION_SIZE;
+
+	static Key makeKey(byte ps, byte ss, unsigned region, int block) {
+		return (Key(block + 1) << 8) | (ps << 5) | (ss << 3) | region;
+	}
+	Counters& getCounters(word pc);
+
+	void start(Mode newMode, unsigned newInterval);
+	void stop();
+	void clear();
+	void scheduleSample(EmuTime::param time);
+
+	// Schedulable
+	void executeUntil(EmuTime::param time) override;
+
+	// command implementation
+	void processStart(Interpreter& interp, span<const TclObject> tokens);
+	void status(TclObject& result) const;
+	void top(Interpreter& interp, span<const TclObject> tokens,
+	         TclObject& result) const;
+	void save(span<const TclObject> tokens, TclObject& result) const;
+
+	MSXMotherBoard& motherBoard;
+	MSXCPU& cpu;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(span<const TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} profileCommand;
+
+	/** REGION_SIZE counters per key. */
+	std::map<Key, std::vector<Counters>> regions;
+
+	// Looking up the slot and block for every instruction is relatively
+	// cheap, finding the region in the map isn't. So cache the last
+	// result per region.
+	Key cachedKey[NUM_REGIONS];
+	Counters* cachedCounters[NUM_REGIONS];
+
+	Mode mode;
+	unsigned interval; // in cycles of the active CPU (sample mode)
+	EmuTime lastSample;
+	uint32_t random; // for sample jitter
+};
+
+} // namespace openmsx
+
+#endif
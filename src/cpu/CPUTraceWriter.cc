@@ -0,0 +1,101 @@
+#include "CPUTraceWriter.hh"
+#include "FileException.hh"
+#include "EmuDuration.hh"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace openmsx {
+
+CPUTraceWriter::CPUTraceWriter(const std::string& filename_)
+	: filename(filename_)
+	, file(FileOperations::openFile(
+		FileOperations::expandTilde(filename), "wb"))
+	, block(RECORDS_PER_BLOCK)
+	, current(0)
+	, stop(false)
+	, failed(false)
+{
+	if (!file) {
+		throw FileException("Couldn't open ", filename, " for writing: ",
+		                    strerror(errno));
+	}
+	Header header;
+	memcpy(header.magic, "openMSX cputrace", sizeof(header.magic));
+	header.version = VERSION;
+	header.recordSize = sizeof(Record);
+	header.ticksPerSecond = MAIN_FREQ;
+	if (fwrite(&header, sizeof(header), 1, file.get()) != 1) {
+		throw FileException("Couldn't write to ", filename);
+	}
+
+	thread = std::thread([this]() { run(); });
+}
+
+CPUTraceWriter::~CPUTraceWriter()
+{
+	close();
+}
+
+bool CPUTraceWriter::close()
+{
+	if (!thread.joinable()) return !failed; // already closed
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (current != 0) {
+			block.resize(current);
+			queue.push_back(std::move(block));
+		}
+		stop = true;
+	}
+	condition.notify_all();
+	thread.join();
+	if (fflush(file.get()) != 0) failed = true;
+	return !failed;
+}
+
+void CPUTraceWriter::flushBlock()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	// Block the emulation (rather than dropping records) when the writer
+	// thread can't keep up.
+	condition.wait(lock, [&]() { return queue.size() < MAX_QUEUED_BLOCKS; });
+	queue.push_back(std::move(block));
+	if (!freeBlocks.empty()) {
+		block = std::move(freeBlocks.back());
+		freeBlocks.pop_back();
+	} else {
+		block = Block(RECORDS_PER_BLOCK);
+	}
+	current = 0;
+	lock.unlock();
+	condition.notify_all();
+}
+
+void CPUTraceWriter::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		condition.wait(lock, [&]() { return !queue.empty() || stop; });
+		if (queue.empty()) break; // only when stopping
+
+		Block full = std::move(queue.front());
+		queue.pop_front();
+		lock.unlock();
+
+		// After an error the remaining records are dropped, this keeps
+		// the emulation running.
+		if (!failed &&
+		    (fwrite(full.data(), sizeof(Record), full.size(), file.get())
+		     != full.size())) {
+			failed = true;
+		}
+
+		lock.lock();
+		full.resize(RECORDS_PER_BLOCK);
+		freeBlocks.push_back(std::move(full));
+		condition.notify_all();
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,103 @@
+#ifndef CPUTRACEWRITER_HH
+#define CPUTRACEWRITER_HH
+
+#include "FileOperations.hh"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace openmsx {
+
+/** Writes a binary CPU instruction trace (see 'cputrace_file' setting).
+  *
+  * The emulation thread only fills in fixed-size records in a memory block,
+  * full blocks are handed over to a background thread that writes them to
+  * the file. The trace is lossless: when the disk can't keep up and too
+  * many blocks are queued, the emulation thread waits.
+  *
+  * File layout (integers in host byte order):
+  *   Header
+  *   a sequence of Records, one per executed instruction
+  * Use Contrib/cputrace-decode.cc to convert it to the textual trace format.
+  */
+class CPUTraceWriter
+{
+public:
+	static const uint32_t VERSION = 1;
+	static const unsigned RECORDS_PER_BLOCK = 65536;
+	static const unsigned MAX_QUEUED_BLOCKS = 32;
+
+	struct Header {
+		char magic[16]; // "openMSX cputrace" (no zero byte)
+		uint32_t version;
+		uint32_t recordSize;
+		uint64_t ticksPerSecond; // unit of the Record 'time' field
+	};
+
+	struct Record {
+		uint64_t time; // start of the next instruction
+		uint16_t pc; // address of the executed instruction
+		// register values after the instruction was executed
+		uint16_t af, bc, de, hl, ix, iy, sp;
+		uint8_t opcode[4]; // only the first (instruction length) are used
+		uint8_t cpu; // 0 = Z80, 1 = R800
+		uint8_t pad[3];
+	};
+	static_assert(sizeof(Header) == 32, "no padding in file header");
+	static_assert(sizeof(Record) == 32, "no padding in file records");
+
+	/** Opens the file and writes the header.
+	  * @throws FileException when the file can't be created. */
+	explicit CPUTraceWriter(const std::string& filename);
+
+	/** Calls close(). */
+	~CPUTraceWriter();
+
+	/** Writes all pending records and stops the writer thread. After
+	  * this no new records may be added anymore.
+	  * @return false when (part of) the trace could not be written
+	  *         (e.g. disk full). */
+	bool close();
+
+	/** Returns a record that must be filled in completely by the caller.
+	  * It's only written to disk after the next call to this method (or
+	  * when this object is destroyed). */
+	Record& newRecord() {
+		if (current == RECORDS_PER_BLOCK) flushBlock();
+		return block[current++];
+	}
+
+	const std::string& getFilename() const { return filename; }
+
+private:
+	using Block = std::vector<Record>;
+
+	void flushBlock();
+	void run();
+
+	const std::string filename;
+	FileOperations::FILE_t file;
+
+	// block currently being filled in by the emulation thread
+	Block block;
+	unsigned current;
+
+	// writer thread, 'mutex' protects the members below
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<Block> queue; // full blocks, waiting to be written
+	std::vector<Block> freeBlocks; // already written, ready to be reused
+	bool stop;
+	std::atomic<bool> failed;
+	std::thread thread;
+};
+
+} // namespace openmsx
+
+#endif
@@ -1,25 +1,21 @@
 #ifndef DASM_HH
 #define DASM_HH
 
-#include "EmuTime.hh"
 #include "openmsx.hh"
 #include <string>
 
 namespace openmsx {
 
-class MSXCPUInterface;
-
 /** Disassemble
-  * @param interf The CPU interface, used to peek bytes from memory
-  * @param pc The position (program counter) where to start disassembling
-  * @param buf The bytes that form this opcode (max 4). The buffer is only
-  *            filled with the min required bytes (see return value)
+  * This doesn't depend on the rest of openMSX (e.g. MSXCPUInterface), so
+  * it can also be used to decode recorded opcodes in standalone tools.
+  * @param buf The bytes starting at 'pc'. Always 4 bytes, even though
+  *            only the first 'return value' bytes are used.
+  * @param pc The position (program counter) of the opcode
   * @param dest String representation of the disassembled opcode
-  * @param time TODO
   * @return Length of the disassembled opcode in bytes
   */
-unsigned dasm(const MSXCPUInterface& interf, word pc, byte buf[4],
-              std::string& dest, EmuTime::param time);
+unsigned dasm(const byte buf[4], word pc, std::string& dest);
 
 } // namespace openmsx
 
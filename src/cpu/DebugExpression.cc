@@ -0,0 +1,438 @@
+#include "DebugExpression.hh"
+#include "Debuggable.hh"
+#include "CommandException.hh"
+#include "StringOp.hh"
+#include "unreachable.hh"
+#include <cassert>
+#include <cctype>
+
+namespace openmsx {
+
+// Tcl register names, see 'reg' proc in _cpuregs.tcl: byte registers
+// are at the given index in the "CPU regs" debuggable, word registers
+// are stored big endian starting at the given index.
+struct RegInfo {
+	const char* name;
+	unsigned index;
+	bool word;
+};
+static const RegInfo regInfos[] = {
+	{"A",    0, false}, {"F",    1, false}, {"B",    2, false}, {"C",    3, false},
+	{"D",    4, false}, {"E",    5, false}, {"H",    6, false}, {"L",    7, false},
+	{"A2",   8, false}, {"F2",   9, false}, {"B2",  10, false}, {"C2",  11, false},
+	{"D2",  12, false}, {"E2",  13, false}, {"H2",  14, false}, {"L2",  15, false},
+	{"IXH", 16, false}, {"IXL", 17, false}, {"IYH", 18, false}, {"IYL", 19, false},
+	{"PCH", 20, false}, {"PCL", 21, false}, {"SPH", 22, false}, {"SPL", 23, false},
+	{"I",   24, false}, {"R",   25, false}, {"IM",  26, false}, {"IFF", 27, false},
+	{"AF",   0, true }, {"BC",   2, true }, {"DE",   4, true }, {"HL",   6, true },
+	{"AF2",  8, true }, {"BC2", 10, true }, {"DE2", 12, true }, {"HL2", 14, true },
+	{"IX",  16, true }, {"IY",  18, true }, {"PC",  20, true }, {"SP",  22, true },
+};
+
+// The (unsigned) peek procs from _disasm.tcl.
+struct PeekInfo {
+	const char* name;
+	DebugExpression::Op op;
+};
+static const PeekInfo peekInfos[] = {
+	{"peek",       DebugExpression::Op::READ8},
+	{"peek8",      DebugExpression::Op::READ8},
+	{"peek_u8",    DebugExpression::Op::READ8},
+	{"peek16",     DebugExpression::Op::READ16_LE},
+	{"peek16_LE",  DebugExpression::Op::READ16_LE},
+	{"peek_u16",   DebugExpression::Op::READ16_LE},
+	{"peek_u16LE", DebugExpression::Op::READ16_LE},
+	{"peek16_BE",  DebugExpression::Op::READ16_BE},
+	{"peek_u16BE", DebugExpression::Op::READ16_BE},
+};
+
+static bool isSpace(char c)
+{
+	return isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+static bool isAlnum(char c)
+{
+	return isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+/** Recursive descent parser, the precedence levels are the same as in Tcl
+  * 'expr'. All parse methods return false when (that part of) the
+  * expression is not supported, the expression is then left to Tcl.
+  */
+class DebugExpressionParser
+{
+public:
+	DebugExpressionParser(string_view str_, DebugExpression& expr_)
+		: str(str_), expr(expr_) {}
+
+	bool parse()
+	{
+		unsigned n;
+		if (!parseTernary(n)) return false;
+		skipSpace();
+		return str.empty();
+	}
+
+private:
+	using Op = DebugExpression::Op;
+
+	void skipSpace()
+	{
+		while (!str.empty() && isSpace(str.front())) {
+			str.pop_front();
+		}
+	}
+	// Consume 'token' if it's next, but e.g. '&' must not match '&&'.
+	bool match(string_view token, char notFollowedBy = 0)
+	{
+		skipSpace();
+		if (!str.starts_with(token)) return false;
+		if (notFollowedBy && (str.size() > token.size()) &&
+		    (str[token.size()] == notFollowedBy)) {
+			return false;
+		}
+		str.remove_prefix(token.size());
+		return true;
+	}
+
+	unsigned add(Op op, unsigned a = 0, unsigned b = 0, unsigned c = 0,
+	             int64_t value = 0, string_view name = {})
+	{
+		expr.nodes.push_back({op, value, a, b, c, name.str()});
+		return unsigned(expr.nodes.size() - 1);
+	}
+
+	bool parseTernary(unsigned& n)
+	{
+		if (!parseOr(n)) return false;
+		if (!match("?")) return true;
+		unsigned t, f;
+		if (!parseTernary(t)) return false;
+		if (!match(":")) return false;
+		if (!parseTernary(f)) return false;
+		n = add(Op::CONDITIONAL, n, t, f);
+		return true;
+	}
+	bool parseOr(unsigned& n)
+	{
+		if (!parseAnd(n)) return false;
+		while (match("||")) {
+			unsigned m;
+			if (!parseAnd(m)) return false;
+			n = add(Op::LOG_OR, n, m);
+		}
+		return true;
+	}
+	bool parseAnd(unsigned& n)
+	{
+		if (!parseBitOr(n)) return false;
+		while (match("&&")) {
+			unsigned m;
+			if (!parseBitOr(m)) return false;
+			n = add(Op::LOG_AND, n, m);
+		}
+		return true;
+	}
+	bool parseBitOr(unsigned& n)
+	{
+		if (!parseBitXor(n)) return false;
+		while (match("|", '|')) {
+			unsigned m;
+			if (!parseBitXor(m)) return false;
+			n = add(Op::BIT_OR, n, m);
+		}
+		return true;
+	}
+	bool parseBitXor(unsigned& n)
+	{
+		if (!parseBitAnd(n)) return false;
+		while (match("^")) {
+			unsigned m;
+			if (!parseBitAnd(m)) return false;
+			n = add(Op::BIT_XOR, n, m);
+		}
+		return true;
+	}
+	bool parseBitAnd(unsigned& n)
+	{
+		if (!parseEquality(n)) return false;
+		while (match("&", '&')) {
+			unsigned m;
+			if (!parseEquality(m)) return false;
+			n = add(Op::BIT_AND, n, m);
+		}
+		return true;
+	}
+	bool parseEquality(unsigned& n)
+	{
+		if (!parseRelational(n)) return false;
+		while (true) {
+			Op op;
+			if      (match("==")) op = Op::EQUAL;
+			else if (match("!=")) op = Op::NOT_EQUAL;
+			else return true;
+			unsigned m;
+			if (!parseRelational(m)) return false;
+			n = add(op, n, m);
+		}
+	}
+	bool parseRelational(unsigned& n)
+	{
+		if (!parseAdditive(n)) return false;
+		while (true) {
+			Op op;
+			if      (match("<=")) op = Op::LESS_EQ;
+			else if (match(">=")) op = Op::GREATER_EQ;
+			else if (match("<<") || match(">>")) return false;
+			else if (match("<"))  op = Op::LESS;
+			else if (match(">"))  op = Op::GREATER;
+			else return true;
+			unsigned m;
+			if (!parseAdditive(m)) return false;
+			n = add(op, n, m);
+		}
+	}
+	bool parseAdditive(unsigned& n)
+	{
+		if (!parseUnary(n)) return false;
+		while (true) {
+			Op op;
+			if      (match("+")) op = Op::ADD;
+			else if (match("-")) op = Op::SUB;
+			else return true;
+			unsigned m;
+			if (!parseUnary(m)) return false;
+			n = add(op, n, m);
+		}
+	}
+	bool parseUnary(unsigned& n)
+	{
+		Op op;
+		if      (match("-")) op = Op::NEG;
+		else if (match("~")) op = Op::BIT_NOT;
+		else if (match("!", '=')) op = Op::LOG_NOT;
+		else if (match("+")) return parseUnary(n);
+		else return parsePrimary(n);
+		unsigned m;
+		if (!parseUnary(m)) return false;
+		n = add(op, m);
+		return true;
+	}
+	bool parsePrimary(unsigned& n)
+	{
+		if (match("(")) {
+			return parseTernary(n) && match(")");
+		} else if (match("[")) {
+			return parseCommand(n) && match("]");
+		} else {
+			return parseLiteral(n);
+		}
+	}
+	bool parseLiteral(unsigned& n)
+	{
+		skipSpace();
+		string_view::size_type len = 0;
+		while ((len < str.size()) && isAlnum(str[len])) {
+			++len;
+		}
+		int64_t value;
+		if (!parseNumber(str.substr(0, len), value)) return false;
+		str.remove_prefix(len);
+		n = add(Op::LITERAL, 0, 0, 0, value);
+		return true;
+	}
+	static bool parseNumber(string_view s, int64_t& result)
+	{
+		unsigned base = 10;
+		if ((s.size() >= 2) && (s[0] == '0')) {
+			switch (s[1]) {
+				case 'x': case 'X': base = 16; break;
+				case 'o': case 'O': base = 8; break;
+				case 'b': case 'B': base = 2; break;
+				default: return false; // octal in Tcl 8, decimal in Tcl 9
+			}
+			s.remove_prefix(2);
+		}
+		if (s.empty()) return false;
+		uint64_t value = 0;
+		for (char c : s) {
+			unsigned d;
+			if      (('0' <= c) && (c <= '9')) d = c - '0';
+			else if (('a' <= c) && (c <= 'f')) d = c - 'a' + 10;
+			else if (('A' <= c) && (c <= 'F')) d = c - 'A' + 10;
+			else return false;
+			if (d >= base) return false;
+			value = value * base + d;
+			// Keep all intermediate results far away from overflow.
+			if (value > 0xFFFFFFFF) return false;
+		}
+		result = int64_t(value);
+		return true;
+	}
+
+	// Reads one word of a Tcl command: a bare word, a {braced} or a
+	// "quoted" word, all without any substitutions.
+	bool parseWord(string_view& result)
+	{
+		skipSpace();
+		if (str.empty()) return false;
+		char open = str.front();
+		if ((open == '{') || (open == '"')) {
+			char close = (open == '{') ? '}' : '"';
+			str.pop_front();
+			auto pos = str.find(close);
+			if (pos == string_view::npos) return false;
+			result = str.substr(0, pos);
+			if (result.find_first_of("{}\"[]$\\") != string_view::npos) {
+				return false;
+			}
+			str.remove_prefix(pos + 1);
+			return true;
+		}
+		string_view::size_type len = 0;
+		while ((len < str.size()) &&
+		       !isSpace(str[len]) &&
+		       (string_view("[]{}\"$\\;").find(str[len]) == string_view::npos)) {
+			++len;
+		}
+		if (len == 0) return false;
+		result = str.substr(0, len);
+		str.remove_prefix(len);
+		return true;
+	}
+	// An address argument: a literal or a nested command.
+	bool parseArgument(unsigned& n)
+	{
+		if (match("[")) {
+			return parseCommand(n) && match("]");
+		}
+		string_view arg;
+		int64_t value;
+		if (!parseWord(arg) || !parseNumber(arg, value)) return false;
+		n = add(Op::LITERAL, 0, 0, 0, value);
+		return true;
+	}
+	bool atCommandEnd()
+	{
+		skipSpace();
+		return str.starts_with(']');
+	}
+	bool parseCommand(unsigned& n)
+	{
+		string_view cmd;
+		if (!parseWord(cmd)) return false;
+		if (cmd == "reg") {
+			string_view regName;
+			if (!parseWord(regName) || !atCommandEnd()) return false;
+			for (auto& r : regInfos) {
+				if (StringOp::casecmp()(regName, r.name)) {
+					unsigned index = add(Op::LITERAL, 0, 0, 0, r.index);
+					n = add(r.word ? Op::READ16_BE : Op::READ8,
+					        index, 0, 0, 0, "CPU regs");
+					return true;
+				}
+			}
+			return false;
+		} else if (cmd == "debug") {
+			string_view sub, name;
+			unsigned addr;
+			if (!parseWord(sub) || (sub != "read") ||
+			    !parseWord(name) || !parseArgument(addr) ||
+			    !atCommandEnd()) {
+				return false;
+			}
+			n = add(Op::READ8, addr, 0, 0, 0, name);
+			return true;
+		}
+		for (auto& p : peekInfos) {
+			if (cmd != p.name) continue;
+			unsigned addr;
+			if (!parseArgument(addr)) return false;
+			string_view name = "memory";
+			if (!atCommandEnd() &&
+			    (!parseWord(name) || !atCommandEnd())) {
+				return false;
+			}
+			n = add(p.op, addr, 0, 0, 0, name);
+			return true;
+		}
+		return false;
+	}
+
+	string_view str;
+	DebugExpression& expr;
+};
+
+std::shared_ptr<const DebugExpression> DebugExpression::compile(string_view str)
+{
+	auto result = std::make_shared<DebugExpression>();
+	DebugExpressionParser parser(str, *result);
+	if (!parser.parse()) return nullptr;
+	return result;
+}
+
+int64_t DebugExpression::eval(Context& context) const
+{
+	assert(!nodes.empty());
+	return eval(unsigned(nodes.size() - 1), context);
+}
+
+unsigned DebugExpression::read(
+	Context& context, string_view name, int64_t addr) const
+{
+	// same checks and error messages as the 'debug read' command
+	auto* debuggable = context.findDebuggable(name);
+	if (!debuggable) {
+		throw CommandException("No such debuggable: ", name);
+	}
+	if ((addr < 0) || (addr >= debuggable->getSize())) {
+		throw CommandException("Invalid address");
+	}
+	return debuggable->read(unsigned(addr));
+}
+
+int64_t DebugExpression::eval(unsigned n, Context& context) const
+{
+	const auto& node = nodes[n];
+	switch (node.op) {
+	case Op::LITERAL:
+		return node.value;
+	case Op::READ8:
+		return read(context, node.name, eval(node.a, context));
+	case Op::READ16_LE: {
+		int64_t addr = eval(node.a, context);
+		unsigned lo = read(context, node.name, addr + 0);
+		unsigned hi = read(context, node.name, addr + 1);
+		return lo + 256 * hi;
+	}
+	case Op::READ16_BE: {
+		int64_t addr = eval(node.a, context);
+		unsigned hi = read(context, node.name, addr + 0);
+		unsigned lo = read(context, node.name, addr + 1);
+		return lo + 256 * hi;
+	}
+	case Op::NEG:    return -eval(node.a, context);
+	case Op::BIT_NOT: return ~eval(node.a, context);
+	case Op::LOG_NOT:    return  eval(node.a, context) == 0;
+	case Op::ADD:    return eval(node.a, context) +  eval(node.b, context);
+	case Op::SUB:    return eval(node.a, context) -  eval(node.b, context);
+	case Op::LESS:     return eval(node.a, context) <  eval(node.b, context);
+	case Op::GREATER:     return eval(node.a, context) >  eval(node.b, context);
+	case Op::LESS_EQ:     return eval(node.a, context) <= eval(node.b, context);
+	case Op::GREATER_EQ:     return eval(node.a, context) >= eval(node.b, context);
+	case Op::EQUAL:     return eval(node.a, context) == eval(node.b, context);
+	case Op::NOT_EQUAL:     return eval(node.a, context) != eval(node.b, context);
+	case Op::BIT_AND: return eval(node.a, context) &  eval(node.b, context);
+	case Op::BIT_XOR: return eval(node.a, context) ^  eval(node.b, context);
+	case Op::BIT_OR:  return eval(node.a, context) |  eval(node.b, context);
+	case Op::LOG_AND:    return eval(node.a, context) && eval(node.b, context);
+	case Op::LOG_OR:     return eval(node.a, context) || eval(node.b, context);
+	case Op::CONDITIONAL:
+		return eval(node.a, context) ? eval(node.b, context)
+		                             : eval(node.c, context);
+	}
+	UNREACHABLE; return 0;
+}
+
+} // namespace openmsx
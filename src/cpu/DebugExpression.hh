@@ -0,0 +1,79 @@
+#ifndef DEBUGEXPRESSION_HH
+#define DEBUGEXPRESSION_HH
+
+#include "string_view.hh"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class Debuggable;
+
+/** Natively evaluated form of a (simple) breakpoint/condition expression.
+  *
+  * Conditions are checked after every instruction, evaluating them through
+  * Tcl is relatively slow. Most conditions only compare register or memory
+  * values, like
+  *    [reg A] == 3 && [peek 0xF3AE] != 0
+  * Those are compiled into a small expression tree once, so that they can
+  * be evaluated without going through the Tcl interpreter.
+  *
+  * Recognized are:
+  *  - integer literals (decimal, 0x.., 0o.., 0b..)
+  *  - [reg <name>], [peek <addr>], [peek16 <addr>] (and their variants
+  *    like peek8, peek_u16, peek16_BE) and [debug read <name> <addr>],
+  *    where <addr> is a literal or again one of these commands
+  *  - the Tcl operators  ( )  - + ~ !  + -  < > <= >=  == !=  & ^ |  && ||
+  *    and  ?:
+  * Anything else (variables, other commands or operators, ...) is not
+  * compiled, those conditions are still evaluated by Tcl. This assumes
+  * the 'reg' and 'peek' procs are not redefined by the user.
+  */
+class DebugExpression
+{
+public:
+	/** Gives access to the debuggables of the MSX machine. */
+	class Context
+	{
+	public:
+		/** Returns nullptr when there's no debuggable with that name. */
+		virtual Debuggable* findDebuggable(string_view name) = 0;
+	protected:
+		~Context() = default;
+	};
+
+	/** Returns nullptr when the expression can't be evaluated natively. */
+	static std::shared_ptr<const DebugExpression> compile(string_view expr);
+
+	/** Has the same result as evaluating the expression with Tcl 'expr'.
+	  * @throws CommandException (e.g. on an invalid address). */
+	int64_t eval(Context& context) const;
+
+	// for the parser in DebugExpression.cc
+	enum class Op : uint8_t {
+		LITERAL, READ8, READ16_LE, READ16_BE,
+		NEG, BIT_NOT, LOG_NOT,
+		ADD, SUB, LESS, GREATER, LESS_EQ, GREATER_EQ, EQUAL, NOT_EQUAL,
+		BIT_AND, BIT_XOR, BIT_OR, LOG_AND, LOG_OR, CONDITIONAL,
+	};
+	struct Node {
+		Op op;
+		int64_t value; // for LITERAL
+		unsigned a, b, c; // indices of the operands in 'nodes'
+		std::string name; // for READ*, name of the debuggable
+	};
+
+private:
+	int64_t eval(unsigned n, Context& context) const;
+	unsigned read(Context& context, string_view name, int64_t addr) const;
+
+	std::vector<Node> nodes; // the root is the last node
+
+	friend class DebugExpressionParser;
+};
+
+} // namespace openmsx
+
+#endif
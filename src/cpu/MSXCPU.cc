@@ -4,6 +4,11 @@
 #include "Scheduler.hh"
 #include "IntegerSetting.hh"
 #include "CPUCore.hh"
+#include "CPUTraceWriter.hh"
+#include "CPUProfiler.hh"
+#include "MemoryCoverage.hh"
+#include "MSXCliComm.hh"
+#include "MSXException.hh"
 #include "Z80.hh"
 #include "R800.hh"
 #include "TclObject.hh"
@@ -23,6 +28,11 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 	, traceSetting(
 		motherboard.getCommandController(), "cputrace",
 		"CPU tracing on/off", false, Setting::DONT_SAVE)
+	, traceFileSetting(
+		motherboard.getCommandController(), "cputrace_file",
+		"when not empty, 'cputrace' writes a (much faster) binary "
+		"trace to this file instead of printing text to stdout",
+		"", Setting::DONT_SAVE)
 	, diHaltCallback(
 		motherboard.getCommandController(), "di_halt_callback",
 		"Tcl proc called when the CPU executed a DI/HALT sequence")
@@ -34,6 +44,8 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 			motherboard, "r800", traceSetting,
 			diHaltCallback, EmuTime::zero)
 		: nullptr)
+	, profiler(std::make_unique<CPUProfiler>(motherboard, *this))
+	, coverage(std::make_unique<MemoryCoverage>(motherboard, *this))
 	, timeInfo(motherboard.getMachineInfoCommand())
 	, z80FreqInfo(motherboard.getMachineInfoCommand(), "z80_freq", *z80)
 	, r800FreqInfo(r800
@@ -49,6 +61,7 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 	motherboard.getDebugger().setCPU(this);
 	motherboard.getScheduler().setCPU(this);
 	traceSetting.attach(*this);
+	traceFileSetting.attach(*this);
 
 	z80->freqLocked.attach(*this);
 	z80->freqValue.attach(*this);
@@ -60,6 +73,7 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 
 MSXCPU::~MSXCPU()
 {
+	traceFileSetting.detach(*this);
 	traceSetting.detach(*this);
 	z80->freqLocked.detach(*this);
 	z80->freqValue.detach(*this);
@@ -177,6 +191,24 @@ bool MSXCPU::isM1Cycle(unsigned address) const
 	                 : r800->isM1Cycle(address);
 }
 
+unsigned MSXCPU::getFreq() const
+{
+	return z80Active ? z80->getFreq() : r800->getFreq();
+}
+
+void MSXCPU::setProfiler(CPUProfiler* newProfiler)
+{
+	          z80 ->setProfiler(newProfiler);
+	if (r800) r800->setProfiler(newProfiler);
+	exitCPULoopSync();
+}
+
+void MSXCPU::setCoverage(MemoryCoverage* newCoverage)
+{
+	          z80 ->setCoverage(newCoverage);
+	if (r800) r800->setCoverage(newCoverage);
+}
+
 void MSXCPU::setZ80Freq(unsigned freq)
 {
 	z80->setFreq(freq);
@@ -211,11 +243,41 @@ CPURegs& MSXCPU::getRegisters()
 
 void MSXCPU::update(const Setting& setting)
 {
+	if ((&setting == &traceSetting) || (&setting == &traceFileSetting)) {
+		updateTraceWriter();
+	}
 	          z80 ->update(setting);
 	if (r800) r800->update(setting);
 	exitCPULoopSync();
 }
 
+void MSXCPU::updateTraceWriter()
+{
+	          z80 ->setTraceWriter(nullptr);
+	if (r800) r800->setTraceWriter(nullptr);
+	if (traceWriter) {
+		if (!traceWriter->close()) {
+			motherboard.getMSXCliComm().printWarning(
+				"Error while writing CPU trace file ",
+				traceWriter->getFilename(),
+				", the trace is incomplete.");
+		}
+		traceWriter.reset();
+	}
+
+	string_view filename = traceFileSetting.getString();
+	if (!traceSetting.getBoolean() || filename.empty()) return;
+	try {
+		traceWriter = std::make_unique<CPUTraceWriter>(filename.str());
+	} catch (MSXException& e) {
+		motherboard.getMSXCliComm().printWarning(
+			e.getMessage(), ", falling back to text trace.");
+		return;
+	}
+	          z80 ->setTraceWriter(traceWriter.get());
+	if (r800) r800->setTraceWriter(traceWriter.get());
+}
+
 // Command
 
 void MSXCPU::disasmCommand(
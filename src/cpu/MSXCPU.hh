@@ -5,6 +5,7 @@
 #include "SimpleDebuggable.hh"
 #include "Observer.hh"
 #include "BooleanSetting.hh"
+#include "StringSetting.hh"
 #include "EmuTime.hh"
 #include "TclCallback.hh"
 #include "serialize_meta.hh"
@@ -18,6 +19,9 @@ class MSXMotherBoard;
 class MSXCPUInterface;
 class CPUClock;
 class CPURegs;
+class CPUTraceWriter;
+class CPUProfiler;
+class MemoryCoverage;
 class Z80TYPE;
 class R800TYPE;
 template <typename T> class CPUCore;
@@ -94,6 +98,20 @@ public:
 	/** Is the R800 currently active? */
 	bool isR800Active() const { return !z80Active; }
 
+	/** Clock frequency of the active CPU. */
+	unsigned getFreq() const;
+
+	/** Only for CPUProfiler: when not nullptr, every executed instruction
+	  * is passed to the profiler. */
+	void setProfiler(CPUProfiler* profiler);
+
+	/** Rom and Ram register their memory here for coverage tracking. */
+	MemoryCoverage& getCoverage() { return *coverage; }
+
+	/** Only for MemoryCoverage: when not nullptr, all memory accesses
+	  * are marked in this coverage tracker. */
+	void setCoverage(MemoryCoverage* coverage);
+
 	/** Switch the Z80 clock freq. */
 	void setZ80Freq(unsigned freq);
 
@@ -133,11 +151,19 @@ private:
 	// Observer<Setting>
 	void update(const Setting& setting) override;
 
+	/** (Re)create the binary trace writer, depending on the 'cputrace'
+	  * and 'cputrace_file' settings. */
+	void updateTraceWriter();
+
 	MSXMotherBoard& motherboard;
 	BooleanSetting traceSetting;
+	StringSetting traceFileSetting;
 	TclCallback diHaltCallback;
 	const std::unique_ptr<CPUCore<Z80TYPE>> z80;
 	const std::unique_ptr<CPUCore<R800TYPE>> r800; // can be nullptr
+	std::unique_ptr<CPUTraceWriter> traceWriter; // can be nullptr
+	const std::unique_ptr<CPUProfiler> profiler;
+	const std::unique_ptr<MemoryCoverage> coverage;
 
 	struct TimeInfoTopic final : InfoTopic {
 		explicit TimeInfoTopic(InfoCommand& machineInfoCommand);
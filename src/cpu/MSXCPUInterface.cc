@@ -1,5 +1,6 @@
 #include "MSXCPUInterface.hh"
 #include "DebugCondition.hh"
+#include "Debugger.hh"
 #include "DummyDevice.hh"
 #include "CommandException.hh"
 #include "TclObject.hh"
@@ -26,6 +27,7 @@
 #include "ranges.hh"
 #include "stl.hh"
 #include "unreachable.hh"
+#include <algorithm>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
@@ -55,6 +57,7 @@ static unsigned breakedSettingCount = 0;
 static const byte SECONDARY_SLOT_BIT = 0x01;
 static const byte MEMORY_WATCH_BIT   = 0x02;
 static const byte GLOBAL_RW_BIT      = 0x04;
+static const byte ACCESS_TRACE_BIT   = 0x08;
 
 
 MSXCPUInterface::MSXCPUInterface(MSXMotherBoard& motherBoard_)
@@ -66,6 +69,7 @@ MSXCPUInterface::MSXCPUInterface(MSXMotherBoard& motherBoard_)
 	, externalSlotInfo(motherBoard_.getMachineInfoCommand())
 	, inputPortInfo (motherBoard_.getMachineInfoCommand())
 	, outputPortInfo(motherBoard_.getMachineInfoCommand())
+	, accessTracer(motherBoard_, *this)
 	, dummyDevice(DeviceFactory::createDummyDevice(
 		*motherBoard_.getMachineConfig()))
 	, msxcpu(motherBoard_.getCPU())
@@ -189,11 +193,16 @@ byte MSXCPUInterface::readMemSlow(word address, EmuTime::param time)
 			executeMemWatch(WatchPoint::READ_MEM, address);
 		}
 	}
+	byte result;
 	if (unlikely((address == 0xFFFF) && isExpanded(primarySlotState[3]))) {
-		return 0xFF ^ subSlotRegister[primarySlotState[3]];
+		result = 0xFF ^ subSlotRegister[primarySlotState[3]];
 	} else {
-		return visibleDevices[address >> 14]->readMem(address, time);
+		result = visibleDevices[address >> 14]->readMem(address, time);
+	}
+	if (unlikely(disallowReadCache[address >> CacheLine::BITS] & ACCESS_TRACE_BIT)) {
+		accessTracer.record(AccessTracer::MEM_READ, address, result, time);
 	}
+	return result;
 }
 
 void MSXCPUInterface::writeMemSlow(word address, byte value, EmuTime::param time)
@@ -216,6 +225,9 @@ void MSXCPUInterface::writeMemSlow(word address, byte value, EmuTime::param time
 				g.device->globalWrite(address, value, time);
 			}
 		}
+		if (disallowWriteCache[address >> CacheLine::BITS] & ACCESS_TRACE_BIT) {
+			accessTracer.record(AccessTracer::MEM_WRITE, address, value, time);
+		}
 		// execute write watches after actual write
 		if (writeWatchSet[address >> CacheLine::BITS]
 		                 [address &  CacheLine::LOW]) {
@@ -752,12 +764,13 @@ void MSXCPUInterface::checkBreakPoints(
 	BreakPoints bpCopy(range.first, range.second);
 	auto& globalCliComm = motherBoard.getReactor().getGlobalCliComm();
 	auto& interp        = motherBoard.getReactor().getInterpreter();
+	auto& debugger      = motherBoard.getDebugger();
 	for (auto& p : bpCopy) {
-		p.checkAndExecute(globalCliComm, interp);
+		p.checkAndExecute(globalCliComm, interp, debugger);
 	}
 	auto condCopy = conditions;
 	for (auto& c : condCopy) {
-		c.checkAndExecute(globalCliComm, interp);
+		c.checkAndExecute(globalCliComm, interp, debugger);
 	}
 }
 
@@ -858,21 +871,33 @@ void MSXCPUInterface::updateMemWatch(WatchPoint::Type type)
 {
 	std::bitset<CacheLine::SIZE>* watchSet =
 		(type == WatchPoint::READ_MEM) ? readWatchSet : writeWatchSet;
+	auto& watchIndex =
+		(type == WatchPoint::READ_MEM) ? readWatchIndex : writeWatchIndex;
 	for (unsigned i = 0; i < CacheLine::NUM; ++i) {
 		watchSet[i].reset();
 	}
+	watchIndex.clear();
 	for (auto& w : watchPoints) {
 		if (w->getType() == type) {
 			unsigned beginAddr = w->getBeginAddress();
 			unsigned endAddr   = w->getEndAddress();
 			assert(beginAddr <= endAddr);
 			assert(endAddr < 0x10000);
+			watchIndex.add(beginAddr, endAddr, w);
 			for (unsigned addr = beginAddr; addr <= endAddr; ++addr) {
-				watchSet[addr >> CacheLine::BITS].set(
-				         addr  & CacheLine::LOW);
+				if (((addr & CacheLine::LOW) == 0) &&
+				    ((addr + CacheLine::LOW) <= endAddr)) {
+					// complete cache line
+					watchSet[addr >> CacheLine::BITS].set();
+					addr += CacheLine::LOW;
+				} else {
+					watchSet[addr >> CacheLine::BITS].set(
+					         addr  & CacheLine::LOW);
+				}
 			}
 		}
 	}
+	watchIndex.build();
 	for (unsigned i = 0; i < CacheLine::NUM; ++i) {
 		if (readWatchSet [i].any()) {
 			disallowReadCache [i] |=  MEMORY_WATCH_BIT;
@@ -888,6 +913,39 @@ void MSXCPUInterface::updateMemWatch(WatchPoint::Type type)
 	msxcpu.invalidateMemCache(0x0000, 0x10000);
 }
 
+void MSXCPUInterface::updateAccessTrace()
+{
+	for (unsigned i = 0; i < CacheLine::NUM; ++i) {
+		if (accessTracer.isLineTraced(AccessTracer::MEM_READ, i)) {
+			disallowReadCache [i] |=  ACCESS_TRACE_BIT;
+		} else {
+			disallowReadCache [i] &= ~ACCESS_TRACE_BIT;
+		}
+		if (accessTracer.isLineTraced(AccessTracer::MEM_WRITE, i)) {
+			disallowWriteCache[i] |=  ACCESS_TRACE_BIT;
+		} else {
+			disallowWriteCache[i] &= ~ACCESS_TRACE_BIT;
+		}
+	}
+	msxcpu.invalidateMemCache(0x0000, 0x10000);
+}
+
+const byte* MSXCPUInterface::getWatchedReadCacheLine(word start) const
+{
+	if (disallowReadCache[start >> CacheLine::BITS] != MEMORY_WATCH_BIT) {
+		return nullptr;
+	}
+	return visibleDevices[start >> 14]->getReadCacheLine(start);
+}
+
+byte* MSXCPUInterface::getWatchedWriteCacheLine(word start) const
+{
+	if (disallowWriteCache[start >> CacheLine::BITS] != MEMORY_WATCH_BIT) {
+		return nullptr;
+	}
+	return visibleDevices[start >> 14]->getWriteCacheLine(start);
+}
+
 void MSXCPUInterface::executeMemWatch(WatchPoint::Type type,
                                       unsigned address, unsigned value)
 {
@@ -903,13 +961,15 @@ void MSXCPUInterface::executeMemWatch(WatchPoint::Type type,
 		                   TclObject(int(value)));
 	}
 
-	auto wpCopy = watchPoints;
-	for (auto& w : wpCopy) {
-		if ((w->getBeginAddress() <= address) &&
-		    (w->getEndAddress()   >= address) &&
-		    (w->getType()         == type)) {
-			w->checkAndExecute(globalCliComm, interp);
-		}
+	// Copy the matching watchpoints: executing them may add or remove
+	// watchpoints (and thus rebuild the index).
+	std::vector<std::shared_ptr<WatchPoint>> matches;
+	auto& watchIndex =
+		(type == WatchPoint::READ_MEM) ? readWatchIndex : writeWatchIndex;
+	watchIndex.query(address, matches);
+	for (auto& w : matches) {
+		w->checkAndExecute(globalCliComm, interp,
+		                   motherBoard.getDebugger());
 	}
 
 	interp.unsetVariable("wp_last_address");
@@ -986,6 +1046,31 @@ byte MSXCPUInterface::MemoryDebug::read(unsigned address, EmuTime::param time)
 	return interface.peekMem(address, time);
 }
 
+void MSXCPUInterface::MemoryDebug::readBlock(
+	unsigned start, byte* output, unsigned num)
+{
+	auto& interface = OUTER(MSXCPUInterface, memoryDebug);
+	EmuTime::param time = getMotherBoard().getCurrentTime();
+	unsigned end = start + num;
+	while (start < end) {
+		// Cacheable memory can be peeked directly from the cache line,
+		// that's equivalent to peekMem() for each byte.
+		unsigned lineEnd = std::min(end, (start | CacheLine::LOW) + 1);
+		const byte* line = interface.getDeviceReadCacheLine(
+			start & CacheLine::HIGH);
+		if (line && ((lineEnd != 0x10000) ||
+		             !interface.isExpanded(interface.primarySlotState[3]))) {
+			memcpy(output, &line[start & CacheLine::LOW], lineEnd - start);
+			output += lineEnd - start;
+			start = lineEnd;
+		} else {
+			for (/**/; start < lineEnd; ++start) {
+				*output++ = interface.peekMem(start, time);
+			}
+		}
+	}
+}
+
 void MSXCPUInterface::MemoryDebug::write(unsigned address, byte value,
                                          EmuTime::param time)
 {
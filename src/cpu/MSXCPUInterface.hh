@@ -7,6 +7,8 @@
 #include "MSXDevice.hh"
 #include "BreakPoint.hh"
 #include "WatchPoint.hh"
+#include "IntervalIndex.hh"
+#include "AccessTracer.hh"
 #include "openmsx.hh"
 #include "likely.hh"
 #include "ranges.hh"
@@ -134,7 +136,11 @@ public:
 	 * @see MSXDevice::readIO()
 	 */
 	inline byte readIO(word port, EmuTime::param time) {
-		return IO_In[port & 0xFF]->readIO(port, time);
+		byte result = IO_In[port & 0xFF]->readIO(port, time);
+		if (unlikely(accessTracer.isPortTraced(AccessTracer::IO_READ, port))) {
+			accessTracer.record(AccessTracer::IO_READ, port, result, time);
+		}
+		return result;
 	}
 
 	/**
@@ -143,6 +149,9 @@ public:
 	 */
 	inline void writeIO(word port, byte value, EmuTime::param time) {
 		IO_Out[port & 0xFF]->writeIO(port, value, time);
+		if (unlikely(accessTracer.isPortTraced(AccessTracer::IO_WRITE, port))) {
+			accessTracer.record(AccessTracer::IO_WRITE, port, value, time);
+		}
 	}
 
 	/**
@@ -183,6 +192,37 @@ public:
 		return visibleDevices[start >> 14]->getWriteCacheLine(start);
 	}
 
+	/** Like getReadCacheLine() and getWriteCacheLine(), but also returns
+	 * the line when it's only uncacheable because of watchpoints or IO
+	 * listeners. Only used to locate the memory for coverage tracking,
+	 * the CPU must not access the memory directly via this pointer.
+	 */
+	const byte* getDeviceReadCacheLine(word start) const {
+		return visibleDevices[start >> 14]->getReadCacheLine(start);
+	}
+	byte* getDeviceWriteCacheLine(word start) const {
+		return visibleDevices[start >> 14]->getWriteCacheLine(start);
+	}
+
+	/** For cache lines that are only uncacheable because they contain
+	 * a memory watchpoint this returns the line as getReadCacheLine()
+	 * would have done without that watchpoint. The CPU may then access
+	 * the addresses in this line for which isReadWatched() returns false
+	 * directly via this pointer. For all other lines it returns nullptr.
+	 */
+	const byte* getWatchedReadCacheLine(word start) const;
+	byte* getWatchedWriteCacheLine(word start) const;
+
+	/** Is there a read/write watchpoint on the given memory address? */
+	bool isReadWatched(word address) const {
+		return readWatchSet[address >> CacheLine::BITS]
+		                   [address &  CacheLine::LOW];
+	}
+	bool isWriteWatched(word address) const {
+		return writeWatchSet[address >> CacheLine::BITS]
+		                    [address &  CacheLine::LOW];
+	}
+
 	/**
 	 * CPU uses this method to read 'extra' data from the databus
 	 * used in interrupt routines. In MSX this returns always 255.
@@ -213,11 +253,20 @@ public:
 
 	DummyDevice& getDummyDevice() { return *dummyDevice; }
 
+	/** The currently selected slot and device for a page (0-3). */
+	byte getPrimarySlot  (int page) const { return primarySlotState  [page]; }
+	byte getSecondarySlot(int page) const { return secondarySlotState[page]; }
+	MSXDevice* getVisibleDevice(int page) const { return visibleDevices[page]; }
+
 	static void insertBreakPoint(const BreakPoint& bp);
 	static void removeBreakPoint(const BreakPoint& bp);
 	using BreakPoints = std::vector<BreakPoint>;
 	static const BreakPoints& getBreakPoints() { return breakPoints; }
 
+	/** (Dis)allow caching of the memory that's (no longer) traced by
+	  * the AccessTracer. */
+	void updateAccessTrace();
+
 	void setWatchPoint(const std::shared_ptr<WatchPoint>& watchPoint);
 	void removeWatchPoint(std::shared_ptr<WatchPoint> watchPoint);
 	// note: must be shared_ptr (not unique_ptr), see WatchIO::doReadCallback()
@@ -301,6 +350,7 @@ private:
 	struct MemoryDebug final : SimpleDebuggable {
 		explicit MemoryDebug(MSXMotherBoard& motherBoard);
 		byte read(unsigned address, EmuTime::param time) override;
+		void readBlock(unsigned start, byte* output, unsigned num) override;
 		void write(unsigned address, byte value, EmuTime::param time) override;
 	} memoryDebug;
 
@@ -358,6 +408,8 @@ private:
 		             TclObject& result) const override;
 	} outputPortInfo;
 
+	AccessTracer accessTracer;
+
 	/** Updated visibleDevices for a given page and clears the cache
 	  * on changes.
 	  * Should be called whenever PrimarySlotState or SecondarySlotState
@@ -379,6 +431,10 @@ private:
 	byte disallowWriteCache[CacheLine::NUM];
 	std::bitset<CacheLine::SIZE> readWatchSet [CacheLine::NUM];
 	std::bitset<CacheLine::SIZE> writeWatchSet[CacheLine::NUM];
+	// memory watchpoints per address range, to quickly find the
+	// watchpoints that must be executed for a given address
+	IntervalIndex<std::shared_ptr<WatchPoint>> readWatchIndex;
+	IntervalIndex<std::shared_ptr<WatchPoint>> writeWatchIndex;
 
 	struct GlobalRwInfo {
 		MSXDevice* device;
@@ -2,6 +2,7 @@
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
 #include "MSXCPUInterface.hh"
+#include "Debugger.hh"
 #include "TclObject.hh"
 #include "Interpreter.hh"
 #include <cassert>
@@ -43,7 +44,7 @@ void WatchIO::doReadCallback(unsigned port)
 	// keep this object alive by holding a shared_ptr to it, for the case
 	// this watchpoint deletes itself in checkAndExecute()
 	auto keepAlive = shared_from_this();
-	checkAndExecute(cliComm, interp);
+	checkAndExecute(cliComm, interp, motherboard.getDebugger());
 
 	interp.unsetVariable("wp_last_address");
 }
@@ -60,7 +61,7 @@ void WatchIO::doWriteCallback(unsigned port, unsigned value)
 
 	// see comment in doReadCallback() above
 	auto keepAlive = shared_from_this();
-	checkAndExecute(cliComm, interp);
+	checkAndExecute(cliComm, interp, motherboard.getDebugger());
 
 	interp.unsetVariable("wp_last_address");
 	interp.unsetVariable("wp_last_value");
@@ -0,0 +1,211 @@
+#include "MemoryCoverage.hh"
+#include "MSXMotherBoard.hh"
+#include "MSXCPU.hh"
+#include "CommandException.hh"
+#include "FileContext.hh"
+#include "FileOperations.hh"
+#include "TclObject.hh"
+#include "outer.hh"
+#include "ranges.hh"
+#include "stl.hh"
+#include <cassert>
+#include <cstdio>
+
+using std::string;
+using std::vector;
+
+namespace openmsx {
+
+MemoryCoverage::MemoryCoverage(MSXMotherBoard& motherBoard, MSXCPU& cpu_)
+	: cpu(cpu_)
+	, coverageCommand(motherBoard.getCommandController())
+	, active(false)
+{
+}
+
+MemoryCoverage::~MemoryCoverage()
+{
+	assert(memories.empty());
+	stop();
+}
+
+void MemoryCoverage::registerMemory(
+	const void* owner, const string& name, const byte* data, unsigned size)
+{
+	assert(ranges::none_of(memories, [&](auto& m) { return m.owner == owner; }));
+	memories.push_back({owner, name, data, size, {}});
+	if (active) {
+		memories.back().flags.resize(size, 0);
+	}
+}
+
+void MemoryCoverage::unregisterMemory(const void* owner)
+{
+	auto it = rfind_if_unguarded(memories,
+		[&](auto& m) { return m.owner == owner; });
+	move_pop_back(memories, it);
+	if (active) {
+		// The CPU may still hold pointers to the removed flags.
+		cpu.invalidateMemCache(0x0000, 0x10000);
+	}
+}
+
+byte* MemoryCoverage::getFlags(const byte* line)
+{
+	// Prefer the smallest block (e.g. when a ROM is a window in a
+	// bigger ROM).
+	Memory* best = nullptr;
+	for (auto& m : memories) {
+		if ((m.data <= line) && ((line + CacheLine::SIZE) <= (m.data + m.size)) &&
+		    (!best || (m.size < best->size))) {
+			best = &m;
+		}
+	}
+	return best ? &best->flags[line - best->data] : dummy;
+}
+
+void MemoryCoverage::start()
+{
+	if (active) return;
+	for (auto& m : memories) {
+		m.flags.resize(m.size, 0);
+	}
+	active = true;
+	cpu.setCoverage(this);
+}
+
+void MemoryCoverage::stop()
+{
+	if (!active) return;
+	active = false;
+	cpu.setCoverage(nullptr);
+}
+
+void MemoryCoverage::clear()
+{
+	for (auto& m : memories) {
+		ranges::fill(m.flags, 0);
+	}
+}
+
+const MemoryCoverage::Memory& MemoryCoverage::getMemory(string_view name) const
+{
+	auto it = ranges::find_if(memories,
+		[&](auto& m) { return m.name == name; });
+	if (it == end(memories)) {
+		throw CommandException("No ROM or RAM with name: ", name);
+	}
+	return *it;
+}
+
+void MemoryCoverage::summary(const Memory& memory, TclObject& result) const
+{
+	unsigned executed = 0;
+	unsigned read     = 0;
+	unsigned written  = 0;
+	for (byte f : memory.flags) {
+		executed += (f & EXECUTED) ? 1 : 0;
+		read     += (f & READ)     ? 1 : 0;
+		written  += (f & WRITTEN)  ? 1 : 0;
+	}
+	result.addDictKeyValue("size",     memory.size);
+	result.addDictKeyValue("executed", executed);
+	result.addDictKeyValue("read",     read);
+	result.addDictKeyValue("written",  written);
+}
+
+void MemoryCoverage::save(const Memory& memory, string_view filename_,
+                          TclObject& result) const
+{
+	string filename = FileOperations::expandTilde(filename_);
+	auto file = FileOperations::openFile(filename, "wb");
+	if (!file) {
+		throw CommandException("Couldn't open ", filename, " for writing");
+	}
+	vector<byte> flags = memory.flags;
+	flags.resize(memory.size, 0); // in case coverage was never started
+	if (fwrite(flags.data(), 1, flags.size(), file.get()) != flags.size()) {
+		throw CommandException("Error while writing ", filename);
+	}
+	result = "Coverage of " + memory.name + " saved to " + filename;
+}
+
+
+// class MemoryCoverage::Cmd
+
+MemoryCoverage::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "coverage")
+{
+}
+
+void MemoryCoverage::Cmd::execute(span<const TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() < 2) {
+		throw CommandException("Missing argument");
+	}
+	auto& coverage = OUTER(MemoryCoverage, coverageCommand);
+	const string_view subcommand = tokens[1].getString();
+	if (subcommand == "start") {
+		if (tokens.size() != 2) throw SyntaxError();
+		coverage.start();
+	} else if (subcommand == "stop") {
+		if (tokens.size() != 2) throw SyntaxError();
+		coverage.stop();
+	} else if (subcommand == "clear") {
+		if (tokens.size() != 2) throw SyntaxError();
+		coverage.clear();
+	} else if (subcommand == "status") {
+		if (tokens.size() != 2) throw SyntaxError();
+		result = coverage.active;
+	} else if (subcommand == "list") {
+		if (tokens.size() != 2) throw SyntaxError();
+		for (auto& m : coverage.memories) {
+			result.addListElement(m.name);
+		}
+	} else if (subcommand == "summary") {
+		if (tokens.size() != 3) throw SyntaxError();
+		coverage.summary(coverage.getMemory(tokens[2].getString()), result);
+	} else if (subcommand == "save") {
+		if (tokens.size() != 4) throw SyntaxError();
+		coverage.save(coverage.getMemory(tokens[2].getString()),
+		              tokens[3].getString(), result);
+	} else {
+		throw SyntaxError();
+	}
+}
+
+string MemoryCoverage::Cmd::help(const vector<string>& /*tokens*/) const
+{
+	return "Track which bytes of the ROMs and RAMs are executed, read or written.\n"
+	       "coverage start                 Start tracking\n"
+	       "coverage stop                  Stop tracking, the results are kept\n"
+	       "coverage clear                 Clear the results\n"
+	       "coverage status                Is tracking active?\n"
+	       "coverage list                  Names of all ROMs and RAMs\n"
+	       "coverage summary <name>        Number of executed/read/written bytes\n"
+	       "coverage save <name> <file>    Save the coverage of one ROM or RAM to a\n"
+	       "                               file, one byte per ROM/RAM byte with bit 0\n"
+	       "                               set when executed, bit 1 read, bit 2 written\n";
+}
+
+void MemoryCoverage::Cmd::tabCompletion(vector<string>& tokens) const
+{
+	if (tokens.size() == 2) {
+		static const char* const cmds[] = {
+			"start", "stop", "clear", "status", "list", "summary", "save",
+		};
+		completeString(tokens, cmds);
+	} else if ((tokens.size() == 3) &&
+	           ((tokens[1] == "summary") || (tokens[1] == "save"))) {
+		auto& coverage = OUTER(MemoryCoverage, coverageCommand);
+		vector<string> names;
+		for (auto& m : coverage.memories) {
+			names.push_back(m.name);
+		}
+		completeString(tokens, names);
+	} else if ((tokens.size() == 4) && (tokens[1] == "save")) {
+		completeFileName(tokens, userFileContext());
+	}
+}
+
+} // namespace openmsx
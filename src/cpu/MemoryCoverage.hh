@@ -0,0 +1,86 @@
+#ifndef MEMORYCOVERAGE_HH
+#define MEMORYCOVERAGE_HH
+
+#include "Command.hh"
+#include "CacheLine.hh"
+#include "openmsx.hh"
+#include "span.hh"
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+class MSXCPU;
+class TclObject;
+
+/** Keeps track of which bytes of the ROMs and RAMs of the MSX machine were
+  * executed, read or written (see the 'coverage' command).
+  *
+  * Rom and Ram register their memory block here. When coverage tracking is
+  * active CPUCore asks, each time it (re)fills an entry in its memory
+  * cache, for the coverage flags that correspond to that cache line (see
+  * getFlags()). After that marking an access is a single 'or' operation,
+  * so the cache stays in use.
+  *
+  * Per memory byte there's one byte with coverage flags (instead of three
+  * separate bitmaps) because that's cheaper to update.
+  */
+class MemoryCoverage
+{
+public:
+	enum Flags : byte {
+		EXECUTED = 1,
+		READ     = 2,
+		WRITTEN  = 4,
+	};
+
+	MemoryCoverage(MSXMotherBoard& motherBoard, MSXCPU& cpu);
+	~MemoryCoverage();
+
+	/** Start tracking accesses to the given memory block. The 'owner'
+	  * is only used to identify the block in unregisterMemory(). */
+	void registerMemory(const void* owner, const std::string& name,
+	                    const byte* data, unsigned size);
+	void unregisterMemory(const void* owner);
+
+	/** Returns the coverage flags for the cache line (of CacheLine::SIZE
+	  * bytes) starting at 'line'. When that line is not (completely) part
+	  * of a registered memory block (or when 'line' is nullptr) this
+	  * returns a dummy block that's never read. */
+	byte* getFlags(const byte* line);
+
+private:
+	struct Memory {
+		const void* owner;
+		std::string name;
+		const byte* data;
+		unsigned size;
+		std::vector<byte> flags; // empty if never activated
+	};
+
+	void start();
+	void stop();
+	void clear();
+	const Memory& getMemory(string_view name) const;
+	void summary(const Memory& memory, TclObject& result) const;
+	void save(const Memory& memory, string_view filename,
+	          TclObject& result) const;
+
+	MSXCPU& cpu;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(span<const TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} coverageCommand;
+
+	std::vector<Memory> memories;
+	byte dummy[CacheLine::SIZE];
+	bool active;
+};
+
+} // namespace openmsx
+
+#endif
@@ -14,6 +14,17 @@ public:
 	virtual byte read(unsigned address) = 0;
 	virtual void write(unsigned address, byte value) = 0;
 
+	/** Read the bytes in the range [start, start + num), which must be
+	  * within [0, getSize()). The default implementation calls read()
+	  * for each byte. Debuggables that are backed by a contiguous buffer
+	  * override this with a (much faster) block copy.
+	  */
+	virtual void readBlock(unsigned start, byte* output, unsigned num) {
+		for (unsigned i = 0; i < num; ++i) {
+			output[i] = read(start + i);
+		}
+	}
+
 protected:
 	Debuggable() = default;
 	~Debuggable() = default;
@@ -9,7 +9,6 @@
 #include "MSXWatchIODevice.hh"
 #include "TclObject.hh"
 #include "CommandException.hh"
-#include "MemBuffer.hh"
 #include "ranges.hh"
 #include "stl.hh"
 #include "unreachable.hh"
@@ -329,11 +328,8 @@ void Debugger::Cmd::readBlock(span<const TclObject> tokens, TclObject& result)
 		throw CommandException("Invalid size");
 	}
 
-	MemBuffer<byte> buf(num);
-	for (unsigned i = 0; i < num; ++i) {
-		buf[i] = device.read(addr + i);
-	}
-	result = span<byte>{buf.data(), num};
+	// read directly into the Tcl object, no intermediate buffer
+	device.readBlock(addr, result.setBinary(num), num);
 }
 
 void Debugger::Cmd::write(span<const TclObject> tokens, TclObject& /*result*/)
@@ -12,10 +12,13 @@
 #include "CommandException.hh"
 #include "TclObject.hh"
 #include "XMLElement.hh"
+#include "Base64.hh"
+#include "endian.hh"
 #include "checked_cast.hh"
 #include "cstdiop.hh"
 #include "openmsx.hh"
 #include "ranges.hh"
+#include "unreachable.hh"
 #include "unistdp.hh"
 #include <cassert>
 #include <iostream>
@@ -31,44 +34,109 @@ namespace openmsx {
 
 // class CliCommandEvent
 
+/** One or more commands received in one go from a CliConnection. An event
+  * without commands is used to flush the pending (coalesced) updates, see
+  * CliConnection::scheduleFlush().
+  */
 class CliCommandEvent final : public Event
 {
 public:
-	CliCommandEvent(string command_, const CliConnection* id_)
+	CliCommandEvent(std::vector<string> commands_, const CliConnection* id_,
+	                bool startFraming_ = false)
 		: Event(OPENMSX_CLICOMMAND_EVENT)
-		, command(std::move(command_)), id(id_)
+		, commands(std::move(commands_)), id(id_)
+		, startFraming(startFraming_)
 	{
 	}
-	const string& getCommand() const
+	const std::vector<string>& getCommands() const
 	{
-		return command;
+		return commands;
 	}
 	const CliConnection* getId() const
 	{
 		return id;
 	}
+	bool getStartFraming() const
+	{
+		return startFraming;
+	}
 	TclObject toTclList() const override
 	{
-		return makeTclList("CliCmd", getCommand());
+		TclObject result = makeTclList("CliCmd");
+		result.addListElements(commands);
+		return result;
 	}
 	bool lessImpl(const Event& other) const override
 	{
 		auto& otherCmdEvent = checked_cast<const CliCommandEvent&>(other);
-		return getCommand() < otherCmdEvent.getCommand();
+		return getCommands() < otherCmdEvent.getCommands();
 	}
 private:
-	const string command;
+	const std::vector<string> commands;
 	const CliConnection* id;
+	const bool startFraming;
 };
 
 
+// Framed output: each frame is a 32-bit big endian length followed by that
+// many payload bytes, the first payload byte is the frame type. Frames are
+// directly appended to the output buffer, so e.g. binary command results are
+// only copied once.
+static const char* const FRAMING_MAGIC = "<openmsx-framed/>";
+
+static size_t beginFrame(string& out, char type)
+{
+	size_t pos = out.size();
+	out.append(4, '\0'); // length, filled in by endFrame()
+	out += type;
+	return pos;
+}
+
+static void endFrame(string& out, size_t pos)
+{
+	Endian::writeB32(&out[pos], uint32_t(out.size() - pos - 4));
+}
+
+static void appendField(string& out, string_view s)
+{
+	size_t pos = out.size();
+	out.append(4, '\0');
+	Endian::writeB32(&out[pos], uint32_t(s.size()));
+	out.append(s.data(), s.size());
+}
+
+static void appendFrame(string& out, char type, string_view payload)
+{
+	auto pos = beginFrame(out, type);
+	out.append(payload.data(), payload.size());
+	endFrame(out, pos);
+}
+
+static void appendUpdateFrame(string& out, CliComm::UpdateType type,
+                              string_view machine, string_view name,
+                              string_view value)
+{
+	auto pos = beginFrame(out, 'U');
+	out += char(type);
+	appendField(out, machine);
+	appendField(out, name);
+	out.append(value.data(), value.size());
+	endFrame(out, pos);
+}
+
+
 // class CliConnection
 
 CliConnection::CliConnection(CommandController& commandController_,
                              EventDistributor& eventDistributor_)
-	: parser([this](const std::string& cmd) { execute(cmd); })
-	, commandController(commandController_)
+	: commandController(commandController_)
 	, eventDistributor(eventDistributor_)
+	, parser([this](const std::string& cmd) { batch.push_back(cmd); })
+	, framedParser([this](const std::string& cmd) { batch.push_back(cmd); })
+	, inputMode(NEGOTIATE)
+	, framed(false)
+	, flushScheduled(false)
+	, base64Replies(false)
 {
 	ranges::fill(updateEnabled, false);
 
@@ -82,6 +150,15 @@ CliConnection::~CliConnection()
 
 void CliConnection::log(CliComm::LogLevel level, string_view message)
 {
+	if (framed) {
+		outBuf.clear();
+		auto pos = beginFrame(outBuf, 'L');
+		outBuf += char(level);
+		outBuf.append(message.data(), message.size());
+		endFrame(outBuf, pos);
+		output(outBuf);
+		return;
+	}
 	auto levelStr = CliComm::getLevelStrings();
 	output(strCat("<log level=\"", levelStr[level], "\">",
 	              XMLElement::XMLEscape(message.str()), "</log>\n"));
@@ -92,6 +169,24 @@ void CliConnection::update(CliComm::UpdateType type, string_view machine,
 {
 	if (!getUpdateEnable(type)) return;
 
+	if (framed) {
+		// Only send the last value when the same item changes several
+		// times before the updates are flushed. Typically only a few
+		// different items are pending, so a linear search is fine.
+		auto it = ranges::find_if(pendingUpdates, [&](auto& u) {
+			return (u.type == type) && (u.machine == machine) &&
+			       (u.name == name);
+		});
+		if (it != pendingUpdates.end()) {
+			it->value.assign(value.data(), value.size());
+		} else {
+			pendingUpdates.push_back(
+				{type, machine.str(), name.str(), value.str()});
+		}
+		scheduleFlush();
+		return;
+	}
+
 	auto updateStr = CliComm::getUpdateStrings();
 	string tmp = strCat("<update type=\"", updateStr[type], '\"');
 	if (!machine.empty()) {
@@ -105,6 +200,24 @@ void CliConnection::update(CliComm::UpdateType type, string_view machine,
 	output(tmp);
 }
 
+void CliConnection::scheduleFlush()
+{
+	// The flush happens when the event gets delivered, so all updates
+	// until then are combined.
+	if (flushScheduled) return;
+	flushScheduled = true;
+	eventDistributor.distributeEvent(
+		std::make_shared<CliCommandEvent>(std::vector<string>(), this));
+}
+
+void CliConnection::flushUpdates(string& out)
+{
+	for (auto& u : pendingUpdates) {
+		appendUpdateFrame(out, u.type, u.machine, u.name, u.value);
+	}
+	pendingUpdates.clear();
+}
+
 void CliConnection::startOutput()
 {
 	output("<openmsx-output>\n");
@@ -117,7 +230,9 @@ void CliConnection::start()
 
 void CliConnection::end()
 {
-	output("</openmsx-output>\n");
+	if (!framed) {
+		output("</openmsx-output>\n");
+	}
 	close();
 
 	poller.abort();
@@ -127,10 +242,44 @@ void CliConnection::end()
 	}
 }
 
-void CliConnection::execute(const string& command)
+void CliConnection::parse(const char* buf, size_t n)
 {
-	eventDistributor.distributeEvent(
-		std::make_shared<CliCommandEvent>(command, this));
+	// runs in helper thread
+	bool startFraming = false;
+	if (inputMode == NEGOTIATE) {
+		negotiate(buf, n);
+		startFraming = inputMode == INPUT_FRAMED;
+	} else if (inputMode == INPUT_XML) {
+		parser.parse(buf, n);
+	} else {
+		framedParser.parse(buf, n);
+	}
+	if (!batch.empty() || startFraming) {
+		eventDistributor.distributeEvent(std::make_shared<CliCommandEvent>(
+			std::move(batch), this, startFraming));
+		batch.clear();
+	}
+}
+
+void CliConnection::negotiate(const char* buf, size_t n)
+{
+	// The client can switch to the framed protocol by sending
+	// FRAMING_MAGIC as the very first bytes, otherwise it's XML.
+	string_view magic = FRAMING_MAGIC;
+	size_t i = 0;
+	while ((i < n) && (negotiateBuf.size() < magic.size()) &&
+	       (buf[i] == magic[negotiateBuf.size()])) {
+		negotiateBuf += buf[i++];
+	}
+	if (negotiateBuf.size() == magic.size()) {
+		inputMode = INPUT_FRAMED;
+		framedParser.parse(&buf[i], n - i);
+	} else if (i < n) {
+		inputMode = INPUT_XML;
+		parser.parse(negotiateBuf.data(), negotiateBuf.size());
+		parser.parse(&buf[i], n - i);
+	}
+	// else still a prefix of the magic, wait for more data
 }
 
 static string reply(const string& message, bool status)
@@ -139,19 +288,69 @@ static string reply(const string& message, bool status)
 	              XMLElement::XMLEscape(message), "</reply>\n");
 }
 
-int CliConnection::signalEvent(const std::shared_ptr<const Event>& event)
+void CliConnection::executeBatch(const std::vector<string>& commands,
+                                 string& out)
 {
-	auto& commandEvent = checked_cast<const CliCommandEvent&>(*event);
-	if (commandEvent.getId() == this) {
+	for (auto& command : commands) {
 		try {
-			string result = commandController.executeCommand(
-				commandEvent.getCommand(), this).getString().str();
-			output(reply(result, true));
+			TclObject result = commandController.executeCommand(
+				command, this);
+			if (framed) {
+				// binary results (e.g. a memory dump) are sent as-is
+				if (result.isBinary()) {
+					auto buf = result.getBinary();
+					appendFrame(out, 'R', string_view(
+						reinterpret_cast<const char*>(buf.data()),
+						buf.size()));
+				} else {
+					appendFrame(out, 'R', result.getString());
+				}
+			} else if (base64Replies && result.isBinary()) {
+				// e.g. a memory dump, no need to XML-escape
+				auto buf = result.getBinary();
+				strAppend(out, "<reply result=\"ok\" encoding=\"base64\">",
+				          Base64::encode(buf.data(), buf.size()),
+				          "</reply>\n");
+			} else {
+				out += reply(result.getString().str(), true);
+			}
 		} catch (CommandException& e) {
-			string result = std::move(e).getMessage() + '\n';
-			output(reply(result, false));
+			if (framed) {
+				appendFrame(out, 'E', e.getMessage());
+			} else {
+				string result = std::move(e).getMessage() + '\n';
+				out += reply(result, false);
+			}
 		}
 	}
+}
+
+int CliConnection::signalEvent(const std::shared_ptr<const Event>& event)
+{
+	auto& commandEvent = checked_cast<const CliCommandEvent&>(*event);
+	if (commandEvent.getId() != this) return 0;
+
+	if (commandEvent.getStartFraming()) {
+		// last XML output, from now on everything is sent as frames
+		output(FRAMING_MAGIC + string("\n"));
+		framed = true;
+	}
+	// Collect all replies (and updates) and send them in one go.
+	string out = std::move(outBuf);
+	out.clear();
+	if (framed) {
+		flushUpdates(out);
+	}
+	executeBatch(commandEvent.getCommands(), out);
+	if (framed) {
+		// updates caused by these commands
+		flushUpdates(out);
+		flushScheduled = false;
+	}
+	if (!out.empty()) {
+		output(out);
+	}
+	outBuf = std::move(out);
 	return 0;
 }
 
@@ -183,7 +382,7 @@ void StdioConnection::run()
 		char buf[BUF_SIZE];
 		int n = read(STDIN_FILENO, buf, sizeof(buf));
 		if (n > 0) {
-			parser.parse(buf, n);
+			parse(buf, n);
 		} else if (n < 0) {
 			break;
 		}
@@ -273,7 +472,7 @@ void PipeConnection::run()
 			if (!GetOverlappedResult(pipeHandle, &overlapped, &bytesRead, TRUE)) {
 				break; // Pipe broke
 			}
-			parser.parse(buf, bytesRead);
+			parse(buf, bytesRead);
 		} else if (wait == WAIT_OBJECT_0) {
 			break; // Shutdown
 		} else {
@@ -307,8 +506,9 @@ void PipeConnection::close()
 
 SocketConnection::SocketConnection(CommandController& commandController_,
                                    EventDistributor& eventDistributor_,
-                                   SOCKET sd_)
+                                   SOCKET sd_, Poller& serverPoller_)
 	: CliConnection(commandController_, eventDistributor_)
+	, serverPoller(serverPoller_)
 	, sd(sd_), established(false)
 {
 }
@@ -318,10 +518,46 @@ SocketConnection::~SocketConnection()
 	end();
 }
 
+#ifndef _WIN32
+void SocketConnection::start()
+{
+	established = true;
+	startOutput();
+	// let the CliServer thread (also) wait for input on this connection
+	serverPoller.wakeup();
+}
+
+SOCKET SocketConnection::getSocket()
+{
+	std::lock_guard<std::mutex> lock(sdMutex);
+	return established ? sd : OPENMSX_INVALID_SOCKET;
+}
+
+bool SocketConnection::receive()
+{
+	// runs in CliServer thread
+	SOCKET s = getSocket();
+	if (s == OPENMSX_INVALID_SOCKET) return false;
+	char buf[BUF_SIZE];
+	int n = sock_recv(s, buf, BUF_SIZE);
+	if (n <= 0) {
+		// closed by the other side (or error)
+		closeSocket();
+		return false;
+	}
+	parse(buf, n);
+	return true;
+}
+
+void SocketConnection::run()
+{
+	// not used, see CliServer::mainLoop()
+	UNREACHABLE;
+}
+#else
 void SocketConnection::run()
 {
 	// runs in helper thread
-#ifdef _WIN32
 	bool ok;
 	{
 		std::lock_guard<std::mutex> lock(sdMutex);
@@ -334,9 +570,8 @@ void SocketConnection::run()
 		closeSocket();
 		return;
 	}
-#endif
 	// Start output element
-	established = true; // TODO needs locking?
+	established = true;
 	startOutput();
 
 	// TODO is locking correct?
@@ -344,21 +579,17 @@ void SocketConnection::run()
 	// and 'sd' only gets written to in this thread.
 	while (true) {
 		if (sd == OPENMSX_INVALID_SOCKET) return;
-#ifndef _WIN32
-		if (poller.poll(sd)) {
-			break;
-		}
-#endif
 		char buf[BUF_SIZE];
 		int n = sock_recv(sd, buf, BUF_SIZE);
 		if (n > 0) {
-			parser.parse(buf, n);
+			parse(buf, n);
 		} else if (n < 0) {
 			break;
 		}
 	}
 	closeSocket();
 }
+#endif
 
 void SocketConnection::output(string_view message)
 {
@@ -383,9 +614,11 @@ void SocketConnection::output(string_view message)
 		} else {
 			// Note: On Windows we rely on closing the socket to
 			//       wake up the worker thread, on other platforms
-			//       we rely on Poller.
+			//       the CliServer thread should stop waiting on it.
 			closeSocket();
-			poller.abort();
+#ifndef _WIN32
+			serverPoller.wakeup();
+#endif
 			break;
 		}
 	}
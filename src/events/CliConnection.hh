@@ -6,10 +6,13 @@
 #include "Socket.hh"
 #include "CliComm.hh"
 #include "AdhocCliCommParser.hh"
+#include "FramedCliCommParser.hh"
 #include "Poller.hh"
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace openmsx {
 
@@ -26,12 +29,16 @@ public:
 		return updateEnabled[type];
 	}
 
-	/** Starts the helper thread.
+	/** When enabled, binary command results (e.g. of 'debug read_block')
+	  * are sent base64 encoded instead of as (XML escaped) text. */
+	void setBase64Replies(bool enabled) { base64Replies = enabled; }
+
+	/** Starts the helper thread (or otherwise starts reading commands).
 	  * Called when this CliConnection is added to GlobalCliComm (and
 	  * after it's allowed to respond to external commands).
 	  * Subclasses should themself send the opening tag (startOutput()).
 	  */
-	void start();
+	virtual void start();
 
 protected:
 	CliConnection(CommandController& commandController,
@@ -58,13 +65,22 @@ protected:
 	  */
 	void startOutput();
 
-	AdhocCliCommParser parser;
+	/** Process data received from the client, called from the helper
+	  * thread. All complete commands in this block of data are passed as
+	  * one batch to the main thread.
+	  */
+	void parse(const char* buf, size_t n);
+
 	Poller poller;
 
 private:
 	virtual void run() = 0;
 
-	void execute(const std::string& command);
+	void negotiate(const char* buf, size_t n);
+	void executeBatch(const std::vector<std::string>& commands,
+	                  std::string& out);
+	void scheduleFlush();
+	void flushUpdates(std::string& out);
 
 	// CliListener
 	void log(CliComm::LogLevel level, string_view message) override;
@@ -79,7 +95,27 @@ private:
 
 	std::thread thread;
 
+	// Only used in the helper thread.
+	AdhocCliCommParser parser;
+	FramedCliCommParser framedParser;
+	std::string negotiateBuf;
+	std::vector<std::string> batch;
+	enum InputMode { NEGOTIATE, INPUT_XML, INPUT_FRAMED } inputMode;
+
+	// Only used in the main thread.
+	struct PendingUpdate {
+		CliComm::UpdateType type;
+		std::string machine;
+		std::string name;
+		std::string value;
+	};
+	std::vector<PendingUpdate> pendingUpdates; // framed mode only
+	std::string outBuf; // reused to avoid reallocations
+	bool framed;
+	bool flushScheduled;
+
 	bool updateEnabled[CliComm::NUM_UPDATES];
+	bool base64Replies;
 };
 
 class StdioConnection final : public CliConnection
@@ -116,24 +152,43 @@ private:
 };
 #endif
 
+/** A connection over a (local) socket, see CliServer.
+  * On Windows each connection has its own helper thread (like the other
+  * CliConnections). On other platforms there's no helper thread, instead
+  * the CliServer thread waits for input on all connections and calls
+  * receive() when there's data available.
+  */
 class SocketConnection final : public CliConnection
 {
 public:
 	SocketConnection(CommandController& commandController,
 	                 EventDistributor& eventDistributor,
-	                 SOCKET sd);
+	                 SOCKET sd, Poller& serverPoller);
 	~SocketConnection() override;
 
 	void output(string_view message) override;
 
+#ifndef _WIN32
+	void start() override;
+
+	/** The socket to wait on, or OPENMSX_INVALID_SOCKET when this
+	  * connection is not started yet or already closed. */
+	SOCKET getSocket();
+
+	/** Read and process the available data, called from the CliServer
+	  * thread. Returns false when the connection got closed. */
+	bool receive();
+#endif
+
 private:
 	void close() override;
 	void run() override;
 	void closeSocket();
 
+	Poller& serverPoller;
 	std::mutex sdMutex;
 	SOCKET sd;
-	bool established;
+	std::atomic_bool established;
 };
 
 } // namespace openmsx
@@ -5,6 +5,7 @@
 #include "MSXException.hh"
 #include "random.hh"
 #include "statp.hh"
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -228,16 +229,44 @@ void CliServer::mainLoop()
 	// Set socket to non-blocking to make sure accept() doesn't hang when
 	// a connection attempt is dropped between poll() and accept().
 	fcntl(listenSock, F_SETFL, O_NONBLOCK);
-#endif
+
+	std::vector<pollfd> fds;
+	while (true) {
+		// wait for an incoming connection or input on any of the
+		// (started) connections
+		fds.clear();
+		fds.push_back({ .fd = listenSock, .events = POLLIN, .revents = 0 });
+		for (auto* c : connections) {
+			fds.push_back({ .fd = c->getSocket(), .events = POLLIN, .revents = 0 });
+		}
+		if (poller.poll(fds)) {
+			break;
+		}
+		// Note: the connections that are added in acceptConnection()
+		// don't have an entry in 'fds' yet.
+		size_t num = connections.size();
+		for (size_t i = 0; i < num; ++i) {
+			// (revents is zero when the connection wasn't
+			// started yet when polling)
+			if (!fds[i + 1].revents) continue;
+			if (!connections[i]->receive()) {
+				// Closed, but the connection itself stays alive
+				// (in GlobalCliComm), output to it is ignored.
+				connections[i] = nullptr;
+			}
+		}
+		connections.erase(std::remove(connections.begin(), connections.end(),
+		                              nullptr),
+		                  connections.end());
+		if (fds[0].revents) {
+			acceptConnection();
+		}
+	}
+#else
 	while (true) {
 		// wait for incoming connection
 		// Note: On Windows, closing the socket is sufficient to exit the
 		//       accept() call.
-#ifndef _WIN32
-		if (poller.poll(listenSock)) {
-			break;
-		}
-#endif
 		SOCKET sd = accept(listenSock, nullptr, nullptr);
 		if (poller.aborted()) {
 			if (sd != OPENMSX_INVALID_SOCKET) {
@@ -246,20 +275,30 @@ void CliServer::mainLoop()
 			break;
 		}
 		if (sd == OPENMSX_INVALID_SOCKET) {
-			if (errno == EAGAIN || errno == EWOULDBLOCK) {
-				continue;
-			} else {
-				break;
-			}
+			break;
 		}
-#ifndef _WIN32
-		// The BSD/OSX sockets implementation inherits O_NONBLOCK, while Linux
-		// does not. To be on the safe side, we explicitly reset file flags.
-		fcntl(sd, F_SETFL, 0);
-#endif
 		cliComm.addListener(std::make_unique<SocketConnection>(
-			commandController, eventDistributor, sd));
+			commandController, eventDistributor, sd, poller));
 	}
+#endif
 }
 
+#ifndef _WIN32
+void CliServer::acceptConnection()
+{
+	SOCKET sd = accept(listenSock, nullptr, nullptr);
+	if (sd == OPENMSX_INVALID_SOCKET) {
+		// e.g. EAGAIN/EWOULDBLOCK: connection attempt was dropped
+		return;
+	}
+	// The BSD/OSX sockets implementation inherits O_NONBLOCK, while Linux
+	// does not. To be on the safe side, we explicitly reset file flags.
+	fcntl(sd, F_SETFL, 0);
+	auto conn = std::make_unique<SocketConnection>(
+		commandController, eventDistributor, sd, poller);
+	connections.push_back(conn.get());
+	cliComm.addListener(std::move(conn));
+}
+#endif
+
 } // namespace openmsx
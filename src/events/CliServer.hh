@@ -5,13 +5,22 @@
 #include "Socket.hh"
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace openmsx {
 
 class CommandController;
 class EventDistributor;
 class GlobalCliComm;
-
+class SocketConnection;
+
+/** Accepts connections from external applications (see
+  * openmsx-control.html).
+  *
+  * Except on Windows, a single thread handles all socket connections: it
+  * waits for new connections and for input on all existing connections at
+  * the same time, so there's no thread per connection.
+  */
 class CliServer final
 {
 public:
@@ -24,6 +33,7 @@ private:
 	void mainLoop();
 	SOCKET createSocket();
 	void exitAcceptLoop();
+	void acceptConnection();
 
 	CommandController& commandController;
 	EventDistributor& eventDistributor;
@@ -33,6 +43,12 @@ private:
 	std::string socketName;
 	SOCKET listenSock;
 	Poller poller;
+
+#ifndef _WIN32
+	// Only used in the server thread. The connections themselves are
+	// owned by GlobalCliComm, which outlives this object.
+	std::vector<SocketConnection*> connections;
+#endif
 };
 
 } // namespace openmsx
@@ -75,6 +75,12 @@ enum EventType
 	OPENMSX_MIDI_IN_COREMIDI_VIRTUAL_EVENT,
 	OPENMSX_RS232_TESTER_EVENT,
 
+	/** Sent when a background screenshot write has failed */
+	OPENMSX_SCREENSHOT_WRITER_EVENT,
+
+	/** Sent when the background FilePool indexer has new results */
+	OPENMSX_FILEPOOL_INDEXER_EVENT,
+
 	NUM_EVENT_TYPES // must be last
 };
 
@@ -0,0 +1,42 @@
+#include "FramedCliCommParser.hh"
+#include <algorithm>
+
+
+FramedCliCommParser::FramedCliCommParser(std::function<void(const std::string&)> callback_)
+	: callback(std::move(callback_))
+	, remaining(0)
+	, headerBytes(0)
+	, skip(false)
+{
+}
+
+void FramedCliCommParser::parse(const char* buf, size_t n)
+{
+	size_t i = 0;
+	while (i < n) {
+		if (headerBytes < 4) {
+			remaining = (remaining << 8) | uint8_t(buf[i++]);
+			if (++headerBytes < 4) continue;
+			frame.clear();
+			skip = remaining > MAX_FRAME_SIZE;
+			if (remaining == 0) endFrame();
+			continue;
+		}
+		// Copy as much of the payload as possible in one go.
+		size_t num = std::min<size_t>(n - i, remaining);
+		if (!skip) frame.append(&buf[i], num);
+		i += num;
+		remaining -= uint32_t(num);
+		if (remaining == 0) endFrame();
+	}
+}
+
+void FramedCliCommParser::endFrame()
+{
+	if (!skip && !frame.empty() && (frame[0] == 'C')) {
+		frame.erase(0, 1);
+		callback(frame);
+	}
+	headerBytes = 0;
+	skip = false;
+}
@@ -0,0 +1,35 @@
+#ifndef FRAMEDCLICOMMPARSER_HH
+#define FRAMEDCLICOMMPARSER_HH
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/** Parser for the binary framed variant of the CliComm protocol (see
+  * openmsx-control.html).
+  *
+  * Each frame is a 32-bit big endian length followed by that many payload
+  * bytes. The first payload byte is the frame type, for now the only type a
+  * client can send is 'C': the rest of the payload is a (Tcl) command, sent
+  * as-is (so no XML escaping). Frames of other types, empty frames and
+  * frames bigger than MAX_FRAME_SIZE are skipped.
+  */
+class FramedCliCommParser
+{
+public:
+	static const uint32_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+	explicit FramedCliCommParser(std::function<void(const std::string&)> callback);
+	void parse(const char* buf, size_t n);
+
+private:
+	void endFrame();
+
+	std::function<void(const std::string&)> callback;
+	std::string frame;
+	uint32_t remaining; // payload bytes left in the current frame
+	unsigned headerBytes; // length bytes received so far for the current frame
+	bool skip; // current frame is too big, drop its payload
+};
+
+#endif
@@ -87,7 +87,7 @@ void GlobalCliComm::update(UpdateType type, string_view name, string_view value)
 		if (*v == value) {
 			return;
 		}
-		*v = value.str();
+		v->assign(value.data(), value.size()); // reuse allocation
 	} else {
 		prevValues[type].emplace_noDuplicateCheck(name.str(), value.str());
 	}
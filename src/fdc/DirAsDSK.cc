@@ -266,6 +266,10 @@ DirAsDSK::DirAsDSK(DiskChanger& diskChanger_, CliComm& cliComm_,
 	, hostDir(hostDir_.getResolved() + '/')
 	, syncMode(syncMode_)
 	, lastAccess(EmuTime::zero)
+	// Start watching before importing, so that we don't miss changes
+	// that happen while importing.
+	, hostWatcher(hostDir.substr(0, hostDir.size() - 1), true)
+	, needFullSync(false)
 	, nofSectors((diskChanger_.isDoubleSidedDrive() ? 2 : 1) * SECTORS_PER_TRACK * NUM_TRACKS)
 	, nofSectorsPerFat((((3 * nofSectors) / (2 * SECTORS_PER_CLUSTER)) + SECTOR_SIZE - 1) / SECTOR_SIZE)
 	, firstSector2ndFAT(FIRST_FAT_SECTOR + nofSectorsPerFat)
@@ -366,8 +370,7 @@ void DirAsDSK::readSectorImpl(size_t sector, SectorBuffer& buf)
 			// Happens when dirasdisk is used in virtual_drive.
 			needSync = true;
 		}
-		if (needSync) {
-			syncWithHost();
+		if (needSync && syncChangesWithHost()) {
 			flushCaches(); // e.g. sha1sum
 			// Let the diskdrive report the disk has been ejected.
 			// E.g. a turbor machine uses this to flush its
@@ -380,8 +383,32 @@ void DirAsDSK::readSectorImpl(size_t sector, SectorBuffer& buf)
 	memcpy(&buf, &sectors[sector], sizeof(buf));
 }
 
+bool DirAsDSK::syncChangesWithHost()
+{
+	auto changes = hostWatcher.getChanges();
+	if (changes.all || needFullSync ||
+	    ranges::any_of(changes.paths, [&](const string& p) {
+		    return !StringOp::startsWith(p, hostDir);
+	    })) {
+		// Unknown what changed on the host (e.g. no inotify support),
+		// the host directory itself was removed or renamed, or an
+		// earlier sync deferred some work: check everything.
+		syncWithHost();
+		return true;
+	}
+	if (changes.paths.empty()) {
+		// Nothing changed on the host, so also nothing to do.
+		return false;
+	}
+	for (auto& p : changes.paths) p.erase(0, hostDir.size());
+	syncWithHost(changes.paths);
+	return true;
+}
+
 void DirAsDSK::syncWithHost()
 {
+	needFullSync = false;
+
 	// Check for removed host files. This frees up space in the virtual
 	// disk. Do this first because otherwise later actions may fail (run
 	// out of virtual disk space) for no good reason.
@@ -397,6 +424,49 @@ void DirAsDSK::syncWithHost()
 	addNewHostFiles({}, firstDirSector);
 }
 
+void DirAsDSK::syncWithHost(const vector<string>& hostNames)
+{
+	// The same steps (in the same order) as a full sync, but only for
+	// the given host files and directories (relative to 'hostDir').
+	for (auto& hostName : hostNames) {
+		DirIndex dirIndex = findHostFileInDSK(hostName);
+		if (dirIndex.sector != unsigned(-1)) {
+			checkDeletedHostFile(dirIndex);
+		}
+	}
+	for (auto& hostName : hostNames) {
+		DirIndex dirIndex = findHostFileInDSK(hostName);
+		if (dirIndex.sector != unsigned(-1)) {
+			checkModifiedHostFile(dirIndex);
+		}
+	}
+	// 'hostNames' is sorted, so a new directory is added before the
+	// files in it (and then those files are already added).
+	for (auto& hostName : hostNames) {
+		if (checkFileUsedInDSK(hostName)) continue;
+		auto pos = hostName.rfind('/');
+		string hostSubDir;
+		unsigned msxDirSector = firstDirSector;
+		if (pos != string::npos) {
+			hostSubDir = hostName.substr(0, pos + 1);
+			DirIndex dirIndex = findHostFileInDSK(hostName.substr(0, pos));
+			if (dirIndex.sector == unsigned(-1)) {
+				// The directory itself isn't on the virtual
+				// disk (e.g. a hidden directory).
+				continue;
+			}
+			unsigned cluster = msxDir(dirIndex).startCluster;
+			if (!(msxDir(dirIndex).attrib & MSXDirEntry::ATT_DIRECTORY) ||
+			    (cluster < FIRST_CLUSTER) || (cluster >= maxCluster)) {
+				continue;
+			}
+			msxDirSector = clusterToSector(cluster);
+		}
+		addNewHostName(hostSubDir, hostName.substr(hostSubDir.size()),
+		               msxDirSector);
+	}
+}
+
 void DirAsDSK::checkDeletedHostFiles()
 {
 	// This handles both host files and directories.
@@ -413,22 +483,26 @@ void DirAsDSK::checkDeletedHostFiles()
 			// mapDirs. Ignore it.
 			continue;
 		}
-		const DirIndex& dirIndex = p.first;
-		MapDir& mapDir = p.second;
-		string fullHostName = hostDir + mapDir.hostName;
-		bool isMSXDirectory = (msxDir(dirIndex).attrib &
-		                       MSXDirEntry::ATT_DIRECTORY) != 0;
-		FileOperations::Stat fst;
-		if ((!FileOperations::getStat(fullHostName, fst)) ||
-		    (FileOperations::isDirectory(fst) != isMSXDirectory)) {
-			// TODO also check access permission
-			// Error stat-ing file, or directory/file type is not
-			// the same on the msx and host side (e.g. a host file
-			// has been removed and a host directory with the same
-			// name has been created). In both cases delete the msx
-			// entry (if needed it will be recreated soon).
-			deleteMSXFile(dirIndex);
-		}
+		checkDeletedHostFile(p.first);
+	}
+}
+
+void DirAsDSK::checkDeletedHostFile(DirIndex dirIndex)
+{
+	const MapDir& mapDir = mapDirs[dirIndex];
+	string fullHostName = hostDir + mapDir.hostName;
+	bool isMSXDirectory = (msxDir(dirIndex).attrib &
+	                       MSXDirEntry::ATT_DIRECTORY) != 0;
+	FileOperations::Stat fst;
+	if ((!FileOperations::getStat(fullHostName, fst)) ||
+	    (FileOperations::isDirectory(fst) != isMSXDirectory)) {
+		// TODO also check access permission
+		// Error stat-ing file, or directory/file type is not
+		// the same on the msx and host side (e.g. a host file
+		// has been removed and a host directory with the same
+		// name has been created). In both cases delete the msx
+		// entry (if needed it will be recreated soon).
+		deleteMSXFile(dirIndex);
 	}
 }
 
@@ -503,33 +577,37 @@ void DirAsDSK::checkModifiedHostFiles()
 			// See comment in checkDeletedHostFiles().
 			continue;
 		}
-		const DirIndex& dirIndex = p.first;
-		MapDir& mapDir = p.second;
-		string fullHostName = hostDir + mapDir.hostName;
-		bool isMSXDirectory = (msxDir(dirIndex).attrib &
-		                       MSXDirEntry::ATT_DIRECTORY) != 0;
-		FileOperations::Stat fst;
-		if (FileOperations::getStat(fullHostName, fst) &&
-		    (FileOperations::isDirectory(fst) == isMSXDirectory)) {
-			// Detect changes in host file.
-			// Heuristic: we use filesize and modification time to detect
-			// changes in file content.
-			//  TODO do we need both filesize and mtime or is mtime alone
-			//       enough?
-			// We ignore time/size changes in directories,
-			// typically such a change indicates one of the files
-			// in that directory is changed/added/removed. But such
-			// changes are handled elsewhere.
-			if (!isMSXDirectory &&
-			    ((mapDir.mtime    != fst.st_mtime) ||
-			     (mapDir.filesize != size_t(fst.st_size)))) {
-				importHostFile(dirIndex, fst);
-			}
-		} else {
-			// Only very rarely happens (because checkDeletedHostFiles()
-			// checked this just recently).
-			deleteMSXFile(dirIndex);
+		checkModifiedHostFile(p.first);
+	}
+}
+
+void DirAsDSK::checkModifiedHostFile(DirIndex dirIndex)
+{
+	const MapDir& mapDir = mapDirs[dirIndex];
+	string fullHostName = hostDir + mapDir.hostName;
+	bool isMSXDirectory = (msxDir(dirIndex).attrib &
+	                       MSXDirEntry::ATT_DIRECTORY) != 0;
+	FileOperations::Stat fst;
+	if (FileOperations::getStat(fullHostName, fst) &&
+	    (FileOperations::isDirectory(fst) == isMSXDirectory)) {
+		// Detect changes in host file.
+		// Heuristic: we use filesize and modification time to detect
+		// changes in file content.
+		//  TODO do we need both filesize and mtime or is mtime alone
+		//       enough?
+		// We ignore time/size changes in directories,
+		// typically such a change indicates one of the files
+		// in that directory is changed/added/removed. But such
+		// changes are handled elsewhere.
+		if (!isMSXDirectory &&
+		    ((mapDir.mtime    != fst.st_mtime) ||
+		     (mapDir.filesize != size_t(fst.st_size)))) {
+			importHostFile(dirIndex, fst);
 		}
+	} else {
+		// Only very rarely happens (because checkDeletedHostFiles()
+		// checked this just recently).
+		deleteMSXFile(dirIndex);
 	}
 }
 
@@ -705,27 +783,36 @@ void DirAsDSK::addNewHostFiles(const string& hostSubDir, unsigned msxDirSector)
 	     [](const string& l, const string& r) { return weight(l) < weight(r); });
 
 	for (auto& hostName : hostNames) {
-		try {
-			if (StringOp::startsWith(hostName, '.')) {
-				// skip '.' and '..'
-				// also skip hidden files on unix
-				continue;
-			}
-			string fullHostName = strCat(hostDir, hostSubDir, hostName);
-			FileOperations::Stat fst;
-			if (!FileOperations::getStat(fullHostName, fst)) {
-				throw MSXException("Error accessing ", fullHostName);
-			}
-			if (FileOperations::isDirectory(fst)) {
-				addNewDirectory(hostSubDir, hostName, msxDirSector, fst);
-			} else if (FileOperations::isRegularFile(fst)) {
-				addNewHostFile(hostSubDir, hostName, msxDirSector, fst);
-			} else {
-				throw MSXException("Not a regular file: ", fullHostName);
-			}
-		} catch (MSXException& e) {
-			cliComm.printWarning(e.getMessage());
+		addNewHostName(hostSubDir, hostName, msxDirSector);
+	}
+}
+
+void DirAsDSK::addNewHostName(const string& hostSubDir, const string& hostName,
+                              unsigned msxDirSector)
+{
+	try {
+		if (StringOp::startsWith(hostName, '.')) {
+			// skip '.' and '..'
+			// also skip hidden files on unix
+			return;
+		}
+		string fullHostName = strCat(hostDir, hostSubDir, hostName);
+		FileOperations::Stat fst;
+		if (!FileOperations::getStat(fullHostName, fst)) {
+			throw MSXException("Error accessing ", fullHostName);
 		}
+		if (FileOperations::isDirectory(fst)) {
+			addNewDirectory(hostSubDir, hostName, msxDirSector, fst);
+		} else if (FileOperations::isRegularFile(fst)) {
+			addNewHostFile(hostSubDir, hostName, msxDirSector, fst);
+		} else {
+			throw MSXException("Not a regular file: ", fullHostName);
+		}
+	} catch (MSXException& e) {
+		cliComm.printWarning(e.getMessage());
+		// Retry on the next sync (e.g. when the disk was full, there
+		// might be room after some other files got removed).
+		needFullSync = true;
 	}
 }
 
@@ -778,6 +865,7 @@ void DirAsDSK::addNewDirectory(const string& hostSubDir, const string& hostName,
 			// directory is *just*recently* created with the same
 			// name as an existing msx file). Ignore, it will be
 			// corrected in the next sync.
+			needFullSync = true;
 			return;
 		}
 		unsigned cluster = msxDir(dirIndex).startCluster;
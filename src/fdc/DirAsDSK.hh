@@ -4,8 +4,11 @@
 #include "SectorBasedDisk.hh"
 #include "DiskImageUtils.hh"
 #include "FileOperations.hh"
+#include "FileSystemWatcher.hh"
 #include "EmuTime.hh"
 #include <map>
+#include <string>
+#include <vector>
 
 namespace openmsx {
 
@@ -61,12 +64,17 @@ private:
 	void writeDataSector(unsigned sector, const SectorBuffer& buf);
 	void writeDIREntry(DirIndex dirIndex, DirIndex dirDirIndex,
 	                   const MSXDirEntry& newEntry);
+	bool syncChangesWithHost();
 	void syncWithHost();
+	void syncWithHost(const std::vector<std::string>& hostNames);
 	void checkDeletedHostFiles();
+	void checkDeletedHostFile(DirIndex dirIndex);
 	void deleteMSXFile(DirIndex dirIndex);
 	void deleteMSXFilesInDir(unsigned msxDirSector);
 	void freeFATChain(unsigned cluster);
 	void addNewHostFiles(const std::string& hostSubDir, unsigned msxDirSector);
+	void addNewHostName(const std::string& hostSubDir, const std::string& hostName,
+	                    unsigned msxDirSector);
 	void addNewDirectory(const std::string& hostSubDir, const std::string& hostName,
                              unsigned msxDirSector, FileOperations::Stat& fst);
 	void addNewHostFile(const std::string& hostSubDir, const std::string& hostName,
@@ -81,6 +89,7 @@ private:
 	bool checkMSXFileExists(const std::string& msxfilename,
 	                        unsigned msxDirSector);
 	void checkModifiedHostFiles();
+	void checkModifiedHostFile(DirIndex dirIndex);
 	void setMSXTimeStamp(DirIndex dirIndex, FileOperations::Stat& fst);
 	void importHostFile(DirIndex dirIndex, FileOperations::Stat& fst);
 	void exportToHost(DirIndex dirIndex, DirIndex dirDirIndex);
@@ -121,6 +130,11 @@ private:
 
 	EmuTime lastAccess; // last time there was a sector read/write
 
+	// Reports which host files changed since the last sync, so that
+	// normally we don't have to stat all host files on each sync.
+	FileSystemWatcher hostWatcher;
+	bool needFullSync; // when set, ignore hostWatcher on the next sync
+
 	// For each directory entry that has a mapped host file/directory we
 	// store the name, last modification time and size of the corresponding
 	// host file/dir.
@@ -14,6 +14,9 @@
 #include "Timer.hh"
 #include "ranges.hh"
 #include "sha1.hh"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <fstream>
 #include <memory>
 
@@ -59,10 +62,13 @@ FilePool::FilePool(CommandController& controller, Reactor& reactor_)
 		"instead use the 'filepool' command.",
 		initialFilePoolSettingValue())
 	, reactor(reactor_)
+	, indexer(reactor_.getEventDistributor())
+	, lastWriteTime(Timer::getTime())
 	, quit(false)
 {
 	filePoolSetting.attach(*this);
 	reactor.getEventDistributor().registerEventListener(OPENMSX_QUIT_EVENT, *this);
+	reactor.getEventDistributor().registerEventListener(OPENMSX_FILEPOOL_INDEXER_EVENT, *this);
 	try {
 		readSha1sums();
 	} catch (MSXException&) {
@@ -75,9 +81,11 @@ FilePool::FilePool(CommandController& controller, Reactor& reactor_)
 
 FilePool::~FilePool()
 {
+	mergeIndexerResults();
 	if (needWrite) {
 		writeSha1sums();
 	}
+	reactor.getEventDistributor().unregisterEventListener(OPENMSX_FILEPOOL_INDEXER_EVENT, *this);
 	reactor.getEventDistributor().unregisterEventListener(OPENMSX_QUIT_EVENT, *this);
 	filePoolSetting.detach(*this);
 }
@@ -304,11 +312,12 @@ File FilePool::getFile(FileType fileType, const Sha1Sum& sha1sum)
 	File result = getFromPool(sha1sum);
 	if (result.is_open()) return result;
 
-	// not found in cache, need to scan directories
-	ScanProgress progress;
-	progress.lastTime = Timer::getTime();
-	progress.amountScanned = 0;
-
+	// Not found in the database, (re)index the directories for this
+	// type. That happens in the background, here we only wait till
+	// either the requested file shows up, or till those directories are
+	// completely indexed (and then the file is not present). A directory
+	// that was indexed before is watched, then only the files that
+	// changed since the previous time are indexed again.
 	Directories directories;
 	try {
 		directories = getDirectories();
@@ -316,15 +325,65 @@ File FilePool::getFile(FileType fileType, const Sha1Sum& sha1sum)
 		reactor.getCliComm().printWarning(
 			"Error while parsing '__filepool' setting", e.getMessage());
 	}
+	std::shared_ptr<const FilePoolIndexer::Known> known;
+	vector<unsigned> ids;
 	for (auto& d : directories) {
-		if (d.types & fileType) {
-			string path = FileOperations::expandTilde(d.path);
-			result = scanDirectory(sha1sum, path, d.path, progress);
-			if (result.is_open()) return result;
+		if (!(d.types & fileType)) continue;
+		string path = FileOperations::expandTilde(d.path);
+		auto& w = watchedDirs[path];
+		if (!w.watcher) {
+			// Subdirectories are added while indexing.
+			w.watcher = std::make_unique<FileSystemWatcher>(path, false);
+		}
+		vector<string> paths;
+		if (!w.indexed) {
+			paths.push_back(path);
+		} else {
+			// Possibly still busy from a previous call.
+			ids.push_back(w.lastRequest);
+			auto changes = w.watcher->getChanges();
+			if (changes.all) {
+				// unknown what changed, index everything again
+				paths.push_back(path);
+			} else {
+				paths = std::move(changes.paths);
+			}
 		}
+		if (paths.empty()) continue;
+		if (!known) known = getKnownFiles();
+		w.lastRequest = indexer.add(std::move(paths), known, w.watcher.get());
+		w.indexed = true;
+		ids.push_back(w.lastRequest);
 	}
 
-	return result; // not found
+	auto lastProgress = Timer::getTime();
+	while (true) {
+		// Check this before taking the results, so that we don't miss
+		// results that become available in between.
+		bool done = indexer.isDone(ids);
+		mergeIndexerResults();
+		result = getFromPool(sha1sum);
+		if (result.is_open() || done) return result;
+
+		// Periodically send a progress message
+		auto now = Timer::getTime();
+		if (now > (lastProgress + 250000)) { // 4Hz
+			lastProgress = now;
+			auto progress = indexer.getProgress();
+			reactor.getCliComm().printProgress(
+				"Searching for file with sha1sum ",
+				sha1sum.toString(), "...\nIndexing filepool: [",
+				progress.hashed, '/', progress.hashed + progress.pending, ']');
+		}
+
+		// Indexing can take a long time. Allow to exit openmsx when
+		// it takes too long, in that case pretend we didn't find the
+		// file.
+		reactor.getEventDistributor().deliverEvents();
+		if (quit) return File();
+
+		indexer.wait(std::chrono::milliseconds(100));
+	}
 }
 
 static void reportProgress(const string& filename, size_t percentage,
@@ -423,99 +482,6 @@ File FilePool::getFromPool(const Sha1Sum& sha1sum)
 	return File(); // not found
 }
 
-File FilePool::scanDirectory(
-	const Sha1Sum& sha1sum, const string& directory, const string& poolPath,
-	ScanProgress& progress)
-{
-	ReadDir dir(directory);
-	while (dirent* d = dir.getEntry()) {
-		if (quit) {
-			// Scanning can take a long time. Allow to exit
-			// openmsx when it takes too long. Stop scanning
-			// by pretending we didn't find the file.
-			return File();
-		}
-		string file = d->d_name;
-		string path = strCat(directory, '/', file);
-		FileOperations::Stat st;
-		if (FileOperations::getStat(path, st)) {
-			File result;
-			if (FileOperations::isRegularFile(st)) {
-				result = scanFile(sha1sum, path, st, poolPath, progress);
-			} else if (FileOperations::isDirectory(st)) {
-				if ((file != ".") && (file != "..")) {
-					result = scanDirectory(sha1sum, path, poolPath, progress);
-				}
-			}
-			if (result.is_open()) return result;
-		}
-	}
-	return File(); // not found
-}
-
-File FilePool::scanFile(const Sha1Sum& sha1sum, const string& filename,
-                        const FileOperations::Stat& st, const string& poolPath,
-                        ScanProgress& progress)
-{
-	++progress.amountScanned;
-	// Periodically send a progress message with the current filename
-	auto now = Timer::getTime();
-	if (now > (progress.lastTime + 250000)) { // 4Hz
-		progress.lastTime = now;
-		reactor.getCliComm().printProgress(
-                        "Searching for file with sha1sum ",
-			sha1sum.toString(), "...\nIndexing filepool ", poolPath,
-			": [", progress.amountScanned, "]: ",
-			string_view(filename).substr(poolPath.size()));
-	}
-
-	// deliverEvents() is relatively cheap when there are no events to
-	// deliver, so it's ok to call on each file.
-	reactor.getEventDistributor().deliverEvents();
-
-	auto it = findInDatabase(filename);
-	if (it == end(pool)) {
-		// not in pool
-		try {
-			File file(filename);
-			auto sum = calcSha1sum(file, reactor);
-			auto time = FileOperations::getModificationDate(st);
-			insert(sum, time, filename);
-			if (sum == sha1sum) {
-				return file;
-			}
-		} catch (FileException&) {
-			// ignore
-		}
-	} else {
-		// already in pool
-		assert(filename == it->filename);
-		assert(it->time != time_t(-1));
-		try {
-			auto time = FileOperations::getModificationDate(st);
-			if (it->time == time) {
-				// db is still up to date
-				if (it->sum == sha1sum) {
-					return File(filename);
-				}
-			} else {
-				// db outdated
-				File file(filename);
-				auto sum = calcSha1sum(file, reactor);
-				it->setTime(time);
-				adjust(it, sum);
-				if (sum == sha1sum) {
-					return file;
-				}
-			}
-		} catch (FileException&) {
-			// error reading file, remove from db
-			remove(it);
-		}
-	}
-	return File(); // not found
-}
-
 FilePool::Pool::iterator FilePool::findInDatabase(const string& filename)
 {
 	// Linear search in pool for filename.
@@ -542,6 +508,69 @@ FilePool::Pool::iterator FilePool::findInDatabase(const string& filename)
 	return end(pool); // not found
 }
 
+std::shared_ptr<const FilePoolIndexer::Known> FilePool::getKnownFiles()
+{
+	auto result = std::make_shared<FilePoolIndexer::Known>();
+	for (auto& p : pool) {
+		auto time = p.getTime();
+		if (time != time_t(-1)) {
+			(*result)[p.filename] = time;
+		}
+	}
+	return result;
+}
+
+void FilePool::mergeIndexerResults()
+{
+	vector<FilePoolIndexer::Result> results;
+	indexer.takeResults(results);
+	if (results.empty()) return;
+
+	// Remove the (outdated) entries for these files and add the new ones.
+	// Do this in bulk, one findInDatabase() per file would make this
+	// quadratic in the size of the pool.
+	struct CompareName {
+		bool operator()(const FilePoolIndexer::Result& x, const char* y) const {
+			return strcmp(x.filename.c_str(), y) < 0;
+		}
+		bool operator()(const char* x, const FilePoolIndexer::Result& y) const {
+			return strcmp(x, y.filename.c_str()) < 0;
+		}
+		bool operator()(const FilePoolIndexer::Result& x,
+		                const FilePoolIndexer::Result& y) const {
+			return x.filename < y.filename;
+		}
+	};
+	// stable: when a file was hashed more than once, the last result wins
+	std::stable_sort(begin(results), end(results), CompareName());
+	pool.erase(std::remove_if(begin(pool), end(pool), [&](const PoolEntry& p) {
+			return std::binary_search(begin(results), end(results),
+			                          p.filename, CompareName());
+		}), end(pool));
+	auto oldSize = pool.size();
+	for (size_t i = 0; i < results.size(); ++i) {
+		auto& r = results[i];
+		if ((i + 1 < results.size()) && (results[i + 1].filename == r.filename)) {
+			continue;
+		}
+		stringBuffer.push_back(std::move(r.filename));
+		pool.emplace_back(r.sum, r.time, stringBuffer.back().c_str());
+	}
+	auto middle = begin(pool) + oldSize;
+	std::stable_sort(middle, end(pool), ComparePool());
+	std::inplace_merge(begin(pool), middle, end(pool), ComparePool());
+	needWrite = true;
+
+	// Persist the results incrementally, so that the work isn't lost when
+	// openMSX is stopped (or crashes) before indexing is finished.
+	auto now = Timer::getTime();
+	if (!indexer.isBusy() || (now > (lastWriteTime + 10000000))) { // 10s
+		lastWriteTime = now;
+		writeSha1sums();
+		needWrite = false;
+	}
+}
+
 Sha1Sum FilePool::getSha1Sum(File& file)
 {
 	auto time = file.getModificationDate();
@@ -570,9 +599,12 @@ Sha1Sum FilePool::getSha1Sum(File& file)
 
 int FilePool::signalEvent(const std::shared_ptr<const Event>& event)
 {
-	(void)event; // avoid warning for non-assert compiles
-	assert(event->getType() == OPENMSX_QUIT_EVENT);
-	quit = true;
+	if (event->getType() == OPENMSX_QUIT_EVENT) {
+		quit = true;
+	} else {
+		assert(event->getType() == OPENMSX_FILEPOOL_INDEXER_EVENT);
+		mergeIndexerResults();
+	}
 	return 0;
 }
 
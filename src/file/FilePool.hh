@@ -2,6 +2,8 @@
 #define FILEPOOL_HH
 
 #include "FileOperations.hh"
+#include "FilePoolIndexer.hh"
+#include "FileSystemWatcher.hh"
 #include "StringSetting.hh"
 #include "Observer.hh"
 #include "EventListener.hh"
@@ -10,6 +12,8 @@
 #include <cassert>
 #include <cstdint>
 #include <ctime>
+#include <deque>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -44,16 +48,18 @@ public:
 	Sha1Sum getSha1Sum(File& file);
 
 private:
-	struct ScanProgress {
-		uint64_t lastTime;
-		unsigned amountScanned;
-	};
 	struct Entry {
 		std::string path;
 		int types;
 	};
 	using Directories = std::vector<Entry>;
 
+	struct WatchedDir {
+		std::unique_ptr<FileSystemWatcher> watcher;
+		unsigned lastRequest; // id of the last FilePoolIndexer request
+		bool indexed = false;
+	};
+
 	struct PoolEntry {
 		PoolEntry(const Sha1Sum& s, time_t t, const char* f)
 			: filename(f), time(t), sum(s)
@@ -97,16 +103,9 @@ private:
 	void writeSha1sums();
 
 	File getFromPool(const Sha1Sum& sha1sum);
-	File scanDirectory(const Sha1Sum& sha1sum,
-	                   const std::string& directory,
-	                   const std::string& poolPath,
-	                   ScanProgress& progress);
-	File scanFile(const Sha1Sum& sha1sum,
-	              const std::string& filename,
-	              const FileOperations::Stat& st,
-	              const std::string& poolPath,
-	              ScanProgress& progress);
 	Pool::iterator findInDatabase(const std::string& filename);
+	std::shared_ptr<const FilePoolIndexer::Known> getKnownFiles();
+	void mergeIndexerResults();
 
 	Directories getDirectories() const;
 
@@ -121,9 +120,13 @@ private:
 	Reactor& reactor;
 	std::unique_ptr<Sha1SumCommand> sha1SumCommand;
 	MemBuffer<char> fileMem; // content of initial .filecache
-	std::vector<std::string> stringBuffer; // owns strings that are not in 'fileMem'
+	std::deque<std::string> stringBuffer; // owns strings that are not in 'fileMem'
 
 	Pool pool;
+	// On (tilde expanded) path. Must be destroyed after 'indexer'.
+	std::map<std::string, WatchedDir> watchedDirs;
+	FilePoolIndexer indexer;
+	uint64_t lastWriteTime;
 	bool quit;
 	bool needWrite;
 };
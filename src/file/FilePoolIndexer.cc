@@ -0,0 +1,219 @@
+#include "FilePoolIndexer.hh"
+#include "EventDistributor.hh"
+#include "Event.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "FileSystemWatcher.hh"
+#include "MSXException.hh"
+#include "ReadDir.hh"
+#include "ranges.hh"
+#include "strCat.hh"
+#include <algorithm>
+#include <cassert>
+
+using std::string;
+
+namespace openmsx {
+
+FilePoolIndexer::FilePoolIndexer(EventDistributor& eventDistributor_)
+	: eventDistributor(eventDistributor_)
+	, hashed(0), busyHashers(0)
+	, walking(false), eventPending(false), exitLoop(false)
+{
+}
+
+FilePoolIndexer::~FilePoolIndexer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		// Don't finish the pending work (that can take very long),
+		// files that are being hashed right now are still finished.
+		exitLoop = true;
+		walkQueue.clear();
+		jobs.clear();
+	}
+	walkCondition.notify_all();
+	jobCondition.notify_all();
+	for (auto& t : threads) t.join();
+}
+
+void FilePoolIndexer::start()
+{
+	// called with 'mutex' locked
+	if (!threads.empty()) return;
+	threads.emplace_back([this]() { walkLoop(); });
+	unsigned numHashers = std::min(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+	for (unsigned i = 0; i < numHashers; ++i) {
+		threads.emplace_back([this]() { hashLoop(); });
+	}
+}
+
+unsigned FilePoolIndexer::add(
+	std::vector<string> paths, std::shared_ptr<const Known> known,
+	FileSystemWatcher* watcher)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	unsigned id = unsigned(requests.size());
+	requests.push_back({std::move(paths), std::move(known), watcher, 0, false});
+	walkQueue.push_back(id);
+	start();
+	walkCondition.notify_one();
+	return id;
+}
+
+bool FilePoolIndexer::isDone(span<const unsigned> ids) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return ranges::all_of(ids, [&](unsigned id) {
+		auto& r = requests[id];
+		return r.walked && (r.pending == 0);
+	});
+}
+
+void FilePoolIndexer::takeResults(std::vector<Result>& out)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::move(begin(results), end(results), std::back_inserter(out));
+	results.clear();
+	eventPending = false;
+}
+
+void FilePoolIndexer::wait(std::chrono::milliseconds timeout)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	resultCondition.wait_for(lock, timeout, [&]() {
+		return !results.empty() || exitLoop ||
+		       (walkQueue.empty() && !walking && jobs.empty() && (busyHashers == 0));
+	});
+}
+
+bool FilePoolIndexer::isBusy() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return !walkQueue.empty() || walking || !jobs.empty() || (busyHashers != 0);
+}
+
+FilePoolIndexer::Progress FilePoolIndexer::getProgress() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return {hashed, unsigned(jobs.size()) + busyHashers};
+}
+
+void FilePoolIndexer::walkLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		walkCondition.wait(lock, [this]() { return !walkQueue.empty() || exitLoop; });
+		if (exitLoop) break;
+
+		unsigned id = walkQueue.front();
+		walkQueue.pop_front();
+		// Work on a copy, 'requests' may grow while the lock is released.
+		Request request = requests[id];
+		walking = true;
+		lock.unlock();
+
+		for (auto& path : request.paths) {
+			indexPath(path, request, id);
+		}
+		request.known.reset();
+
+		lock.lock();
+		walking = false;
+		requests[id].walked = true;
+		requests[id].paths.clear(); // no longer needed
+		requests[id].known.reset();
+		resultCondition.notify_all();
+	}
+}
+
+void FilePoolIndexer::indexPath(const string& path, const Request& request, unsigned id)
+{
+	FileOperations::Stat st;
+	if (!FileOperations::getStat(path, st)) return;
+	if (FileOperations::isDirectory(st)) {
+		walk(path, request, id);
+	} else if (FileOperations::isRegularFile(st)) {
+		auto time = FileOperations::getModificationDate(st);
+		if (time == time_t(-1)) return;
+		auto it = request.known->find(path);
+		if ((it != end(*request.known)) && (it->second == time)) {
+			return; // database is still up-to-date
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		++requests[id].pending;
+		auto& waiting = queued[path];
+		waiting.push_back(id);
+		if (waiting.size() == 1) { // not yet being hashed
+			jobs.push_back({path, time});
+			jobCondition.notify_one();
+		}
+	}
+}
+
+void FilePoolIndexer::walk(const string& path, const Request& request, unsigned id)
+{
+	// Start watching before reading the directory, so that no changes
+	// are missed.
+	if (request.watcher) request.watcher->addDirectory(path, false);
+
+	ReadDir dir(path);
+	while (dirent* d = dir.getEntry()) {
+		if (exitLoop) return;
+
+		string_view file = d->d_name;
+		if ((file == ".") || (file == "..")) continue;
+		indexPath(strCat(path, '/', file), request, id);
+	}
+}
+
+// Same as FilePool's calcSha1sum(), but without progress reporting.
+static Sha1Sum calcSha1sum(const string& filename)
+{
+	File file(filename);
+	auto data = file.mmap();
+	SHA1 sha1;
+	sha1.update(data.data(), data.size());
+	return sha1.digest();
+}
+
+void FilePoolIndexer::hashLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		jobCondition.wait(lock, [this]() { return !jobs.empty() || exitLoop; });
+		if (exitLoop) break;
+
+		Job job = std::move(jobs.front());
+		jobs.pop_front();
+		++busyHashers;
+		lock.unlock();
+
+		bool ok = true;
+		Sha1Sum sum;
+		try {
+			sum = calcSha1sum(job.filename);
+		} catch (MSXException&) {
+			ok = false; // error reading file, ignore it
+		}
+
+		lock.lock();
+		--busyHashers;
+		++hashed;
+		auto it = queued.find(job.filename);
+		assert(it != end(queued));
+		for (auto id : it->second) --requests[id].pending;
+		queued.erase(it);
+		if (ok) {
+			results.push_back({std::move(job.filename), job.time, sum});
+			if (!eventPending) {
+				eventPending = true;
+				eventDistributor.distributeEvent(
+					std::make_shared<SimpleEvent>(OPENMSX_FILEPOOL_INDEXER_EVENT));
+			}
+		}
+		resultCondition.notify_all();
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,132 @@
+#ifndef FILEPOOLINDEXER_HH
+#define FILEPOOLINDEXER_HH
+
+#include "sha1.hh"
+#include "span.hh"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace openmsx {
+
+class EventDistributor;
+class FileSystemWatcher;
+
+/** Calculates the sha1sums of the files in the filepool directories on
+  * background threads.
+  *
+  * One thread walks the requested directories, files that are not yet
+  * known (or that have a different modification time than what's known)
+  * are handed to a set of hashing threads, one per core. So the main
+  * thread never blocks on disk I/O or on the sha1 calculation.
+  *
+  * This class doesn't touch the FilePool database itself, that's only
+  * accessed from the main thread. Instead the results are collected
+  * and an OPENMSX_FILEPOOL_INDEXER_EVENT is sent, FilePool then picks
+  * them up via takeResults().
+  */
+class FilePoolIndexer
+{
+public:
+	/** Modification time of the already indexed files, on filename. */
+	using Known = std::unordered_map<std::string, time_t>;
+
+	struct Result {
+		std::string filename;
+		time_t time;
+		Sha1Sum sum;
+	};
+
+	struct Progress {
+		unsigned hashed;  // number of files hashed so far
+		unsigned pending; // number of files waiting to be hashed
+	};
+
+	explicit FilePoolIndexer(EventDistributor& eventDistributor);
+	~FilePoolIndexer();
+
+	/** Start indexing the given files and directories (recursively).
+	  * Files that are in 'known' with the same modification time are
+	  * skipped, paths that don't exist (anymore) are ignored.
+	  * @param paths Files and directories (with tilde already expanded).
+	  * @param known Snapshot of the database, this is shared between
+	  *        all requests that are added at the same time.
+	  * @param watcher If not nullptr, all walked directories are added
+	  *        to this watcher. It must stay alive till this object is
+	  *        destroyed.
+	  * @result An id that can be passed to isDone().
+	  */
+	unsigned add(std::vector<std::string> paths,
+	             std::shared_ptr<const Known> known,
+	             FileSystemWatcher* watcher);
+
+	/** Are the given requests completely walked and are all their files
+	  * hashed? When this returns true, all results of these requests
+	  * are available via takeResults().
+	  */
+	bool isDone(span<const unsigned> ids) const;
+
+	/** Move all results that are available till now into 'out'. */
+	void takeResults(std::vector<Result>& out);
+
+	/** Block till new results become available, or till all work is
+	  * done, or till the timeout expires. */
+	void wait(std::chrono::milliseconds timeout);
+
+	/** Are there directories or files left to process? */
+	bool isBusy() const;
+
+	Progress getProgress() const;
+
+private:
+	struct Request {
+		std::vector<std::string> paths;
+		std::shared_ptr<const Known> known;
+		FileSystemWatcher* watcher;
+		unsigned pending; // number of files still being hashed
+		bool walked;
+	};
+	struct Job {
+		std::string filename;
+		time_t time;
+	};
+
+	void start();
+	void walkLoop();
+	void indexPath(const std::string& path, const Request& request, unsigned id);
+	void walk(const std::string& path, const Request& request, unsigned id);
+	void hashLoop();
+
+	EventDistributor& eventDistributor;
+
+	mutable std::mutex mutex;
+	std::condition_variable walkCondition;   // new requests
+	std::condition_variable jobCondition;    // new jobs
+	std::condition_variable resultCondition; // new results or idle
+
+	std::vector<std::thread> threads; // walker + hashers, started lazily
+	std::vector<Request> requests; // index is the id
+	std::deque<unsigned> walkQueue;
+	std::deque<Job> jobs;
+	// Filenames in 'jobs' or being hashed, together with the requests
+	// (possibly more than one) that are waiting for it.
+	std::unordered_map<std::string, std::vector<unsigned>> queued;
+	std::vector<Result> results;
+	unsigned hashed;
+	unsigned busyHashers;
+	bool walking;
+	bool eventPending;
+	std::atomic<bool> exitLoop; // also read (unlocked) while walking
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,186 @@
+#include "FileSystemWatcher.hh"
+#include "FileOperations.hh"
+#include "ReadDir.hh"
+#include "ranges.hh"
+#include "strCat.hh"
+#if HAVE_INOTIFY_INIT1
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+using std::string;
+
+namespace openmsx {
+
+#if HAVE_INOTIFY_INIT1
+
+static const uint32_t WATCH_MASK =
+	IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+	IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+	IN_ONLYDIR;
+
+FileSystemWatcher::FileSystemWatcher(string root_, bool recursive)
+	: root(std::move(root_))
+	, fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+	, rootWd(-1)
+	, overflow(false)
+{
+	rootWd = addDirectoryImpl(root, recursive);
+}
+
+FileSystemWatcher::~FileSystemWatcher()
+{
+	if (fd != -1) close(fd);
+}
+
+void FileSystemWatcher::addDirectory(const string& path, bool recursive)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	addDirectoryImpl(path, recursive);
+}
+
+// Returns the watch descriptor, or -1 on error.
+int FileSystemWatcher::addDirectoryImpl(const string& path, bool recursive)
+{
+	// called with 'mutex' locked
+	if (fd == -1) return -1;
+	int wd = inotify_add_watch(fd, path.c_str(), WATCH_MASK);
+	if (wd == -1) {
+		if ((errno == ENOSPC) || (errno == ENOMEM)) {
+			// Too many watches, from now on we can only poll.
+			close(fd);
+			fd = -1;
+			watches.clear();
+		}
+		// Otherwise: e.g. the directory was removed in the mean
+		// time, that will be reported via its parent (or for the
+		// root directory: via 'rootWd').
+		return -1;
+	}
+	watches[wd] = path; // could be a new path for an already watched dir
+
+	if (!recursive) return wd;
+	ReadDir dir(path);
+	while (dirent* d = dir.getEntry()) {
+		string_view name = d->d_name;
+		if ((name == ".") || (name == "..")) continue;
+		string subPath = strCat(path, '/', name);
+		if (FileOperations::isDirectory(subPath)) {
+			addDirectoryImpl(subPath, true);
+		}
+	}
+	return wd;
+}
+
+FileSystemWatcher::Changes FileSystemWatcher::getChanges()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Changes result;
+	if ((fd != -1) && (rootWd == -1)) {
+		// The root directory didn't exist, or it was removed. Retry,
+		// but even when that succeeds, we don't know what's in it.
+		rootWd = addDirectoryImpl(root, true);
+		overflow = true;
+	}
+	if (fd == -1) {
+		result.all = true;
+		return result;
+	}
+
+	alignas(struct inotify_event) char buf[4096];
+	while (true) {
+		auto len = read(fd, buf, sizeof(buf));
+		if (len <= 0) break; // EAGAIN: no more events (or an error)
+		for (char* p = buf; p < (buf + len); ) {
+			auto* event = reinterpret_cast<struct inotify_event*>(p);
+			p += sizeof(struct inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				overflow = true;
+				continue;
+			}
+			auto it = watches.find(event->wd);
+			if (it == end(watches)) continue;
+			if (event->mask & IN_IGNORED) {
+				// watch removed, e.g. because the directory was
+				// removed (that's reported separately)
+				if (event->wd == rootWd) {
+					rootWd = -1;
+					overflow = true;
+				}
+				watches.erase(it);
+				continue;
+			}
+			if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+				result.paths.push_back(it->second);
+				continue;
+			}
+			if (event->len == 0) continue;
+			string path = strCat(it->second, '/', event->name);
+			if ((event->mask & IN_ISDIR) &&
+			    (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+				// Also watch new directories. Files could already
+				// have been created in it, but our user anyway
+				// has to examine the new directory completely.
+				addDirectoryImpl(path, true);
+				if (fd == -1) break;
+			}
+			result.paths.push_back(std::move(path));
+		}
+		if (fd == -1) break;
+	}
+
+	if (overflow || (fd == -1)) {
+		overflow = false;
+		result.paths.clear();
+		result.all = true;
+	} else {
+		ranges::sort(result.paths);
+		result.paths.erase(std::unique(begin(result.paths), end(result.paths)),
+		                   end(result.paths));
+	}
+	return result;
+}
+
+bool FileSystemWatcher::isPolling() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return fd == -1;
+}
+
+#else // HAVE_INOTIFY_INIT1
+
+// No support for file change notifications on this platform, so always
+// report 'unknown changes'.
+
+FileSystemWatcher::FileSystemWatcher(string /*root*/, bool /*recursive*/)
+{
+}
+
+FileSystemWatcher::~FileSystemWatcher() = default;
+
+void FileSystemWatcher::addDirectory(const string& /*path*/, bool /*recursive*/)
+{
+}
+
+int FileSystemWatcher::addDirectoryImpl(const string& /*path*/, bool /*recursive*/)
+{
+	return -1;
+}
+
+FileSystemWatcher::Changes FileSystemWatcher::getChanges()
+{
+	Changes result;
+	result.all = true;
+	return result;
+}
+
+bool FileSystemWatcher::isPolling() const
+{
+	return true;
+}
+
+#endif // HAVE_INOTIFY_INIT1
+
+} // namespace openmsx
@@ -0,0 +1,80 @@
+#ifndef FILESYSTEMWATCHER_HH
+#define FILESYSTEMWATCHER_HH
+
+#include "systemfuncs.hh"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace openmsx {
+
+/** Reports which files in a set of (host) directories were created,
+  * modified or removed, so that users of those directories only have to
+  * re-examine the changed files instead of stat-ing all of them.
+  *
+  * On Linux this uses inotify. Subdirectories that are created later are
+  * added automatically. When inotify isn't available (other platforms, or
+  * when the limit on the number of watches is reached), when the kernel
+  * dropped events or while the root directory doesn't exist (or was
+  * removed and recreated) the changes are reported as 'unknown', the user
+  * then has to fall back to re-examining everything (in other words:
+  * polling).
+  *
+  * getChanges() doesn't block and is meant to be called from the main
+  * thread. addDirectory() may also be called from another thread.
+  */
+class FileSystemWatcher
+{
+public:
+	struct Changes {
+		/** Full paths of the changed (or created or removed) files
+		  * and directories. Sorted, without duplicates. */
+		std::vector<std::string> paths;
+		/** When true it's not known what has changed, 'paths' is
+		  * then empty. */
+		bool all = false;
+
+		bool empty() const { return !all && paths.empty(); }
+	};
+
+	/** Start watching the given directory.
+	  * @param root Directory name (without trailing slash). It's not an
+	  *        error if it doesn't exist (yet).
+	  * @param recursive Also watch all (existing) subdirectories. If
+	  *        false, subdirectories can be added via addDirectory().
+	  */
+	FileSystemWatcher(std::string root, bool recursive);
+	~FileSystemWatcher();
+	FileSystemWatcher(const FileSystemWatcher&) = delete;
+	FileSystemWatcher& operator=(const FileSystemWatcher&) = delete;
+
+	/** Also watch the given directory (normally a subdirectory of the
+	  * root directory).
+	  * @param path Directory name (without trailing slash).
+	  * @param recursive Also watch all (existing) subdirectories.
+	  */
+	void addDirectory(const std::string& path, bool recursive);
+
+	/** Returns the changes since the previous call. */
+	Changes getChanges();
+
+	/** Can changes ever be reported more precise than 'unknown'? */
+	bool isPolling() const;
+
+private:
+	int addDirectoryImpl(const std::string& path, bool recursive);
+
+	mutable std::mutex mutex;
+#if HAVE_INOTIFY_INIT1
+	const std::string root;
+	std::unordered_map<int, std::string> watches; // watch descriptor -> path
+	int fd; // -1 when inotify can't be used (anymore)
+	int rootWd; // -1 while the root directory is not watched
+	bool overflow; // changes since the previous getChanges() are unknown
+#endif
+};
+
+} // namespace openmsx
+
+#endif
@@ -1,16 +1,21 @@
 #include "OggReader.hh"
 #include "MSXException.hh"
+#include "Filename.hh"
 #include "yuv2rgb.hh"
 #include "likely.hh"
 #include "CliComm.hh"
 #include "MemoryOps.hh"
+#include "MemBuffer.hh"
+#include "endian.hh"
 #include "ranges.hh"
 #include "stl.hh"
 #include "stringsp.hh" // for strncasecmp
 #include "view.hh"
+#include <algorithm>
 #include <cstring> // for memcpy, memcmp
 #include <cstdlib> // for atoi
 #include <cctype> // for isspace
+#include <iterator>
 #include <memory>
 
 // TODO
@@ -43,9 +48,16 @@ Frame::~Frame()
 }
 
 
-OggReader::OggReader(const Filename& filename, CliComm& cli_)
+OggReader::OggReader(const Filename& filename_, CliComm& cli_)
 	: cli(cli_)
-	, file(filename)
+	, filename(filename_.getResolved())
+	, file(filename_)
+	, indexedSize(0)
+	, indexedFrames(0)
+	, indexReady(false)
+	, exitIndexer(false)
+	, endOfStream(false)
+	, exitDecoder(false)
 {
 	audioSerial = -1;
 	videoSerial = -1;
@@ -201,6 +213,22 @@ OggReader::OggReader(const Filename& filename, CliComm& cli_)
 	th_setup_free(tsi);
 	th_info_clear(&ti);
 	th_comment_clear(&tc);
+
+	flushWarnings();
+	indexThread  = std::thread([this]() { indexLoop(); });
+	decodeThread = std::thread([this]() { decodeLoop(); });
+}
+
+void OggReader::stopThreads()
+{
+	exitIndexer = true;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		exitDecoder = true;
+	}
+	condition.notify_all();
+	indexThread.join();
+	decodeThread.join();
 }
 
 void OggReader::cleanup()
@@ -227,9 +255,18 @@ void OggReader::cleanup()
 
 OggReader::~OggReader()
 {
+	stopThreads();
 	cleanup();
 }
 
+void OggReader::flushWarnings()
+{
+	for (auto& w : warnings) {
+		cli.printWarning(w);
+	}
+	warnings.clear();
+}
+
 /** Vorbis only records the ogg position (in no. of samples) once per ogg
  * page. After seeking we have already decoded some audio before we encounter
  * the exact position we are at. Fixup the positions and discard any unwanted
@@ -245,7 +282,7 @@ void OggReader::vorbisFoundPosition()
 
 	// last is now the first vorbis audio decoded
 	if (last > currentSample) {
-		cli.printWarning("missing part of audio stream");
+		warning("missing part of audio stream");
 	}
 
 	if (vorbisPos > currentSample) {
@@ -408,9 +445,8 @@ void OggReader::readVorbis(ogg_packet* packet)
 			vorbisFoundPosition();
 		} else {
 			if (vorbisPos != size_t(packet->granulepos)) {
-				cli.printWarning(
-                                        "vorbis audio out of sync, expected ",
-					vorbisPos, ", got ", packet->granulepos);
+				warning("vorbis audio out of sync, expected ",
+				        vorbisPos, ", got ", packet->granulepos);
 				vorbisPos = packet->granulepos;
 			}
 		}
@@ -529,25 +565,25 @@ void OggReader::readTheora(ogg_packet* packet)
 	switch (rc) {
 	case TH_DUPFRAME:
 		if (frameList.empty()) {
-			cli.printWarning("Theora error: dup frame encountered "
-					 "without preceding frame");
+			warning("Theora error: dup frame encountered "
+			        "without preceding frame");
 		} else {
 			frameList.back()->length++;
 		}
 		break;
 	case TH_EIMPL:
-		cli.printWarning("Theora error: not capable of reading this");
+		warning("Theora error: not capable of reading this");
 		break;
 	case TH_EFAULT:
-		cli.printWarning("Theora error: API not used correctly");
+		warning("Theora error: API not used correctly");
 		break;
 	case TH_EBADPACKET:
-		cli.printWarning("Theora error: bad packet");
+		warning("Theora error: bad packet");
 		break;
 	case 0:
 		break;
 	default:
-		cli.printWarning("Theora error: unknown error ", rc);
+		warning("Theora error: unknown error ", rc);
 		break;
 	}
 
@@ -588,7 +624,7 @@ void OggReader::readTheora(ogg_packet* packet)
 	if (last && (last->no != size_t(-1))) {
 		if ((frameno != size_t(-1)) &&
 		    (frameno != last->no + last->length)) {
-			cli.printWarning("Theora frame sequence wrong");
+			warning("Theora frame sequence wrong");
 		} else {
 			frameno = last->no + last->length;
 		}
@@ -613,14 +649,15 @@ void OggReader::readTheora(ogg_packet* packet)
 
 void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 {
-	Frame* frame;
+	std::unique_lock<std::mutex> lock(mutex);
+	Frame* frame = nullptr;
 	while (true) {
 		// If there are no frames or the frames we have read
 		// does not include a proper frame number, just read
 		// more data
 		if (frameList.empty() || (frameList[0]->no == size_t(-1))) {
 			if (!nextPacket()) {
-				return;
+				break;
 			}
 			continue;
 		}
@@ -635,8 +672,7 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		if (!frameList.empty() && frameList[0]->no > frameno) {
 			// we're missing frames!
 			frame = frameList[0].get();
-			cli.printWarning(
-                                "Cannot find frame ", frameno, " using ",
+			warning("Cannot find frame ", frameno, " using ",
 			        frame->no, " instead");
 			break;
 		}
@@ -659,17 +695,24 @@ void OggReader::getFrameNo(RawFrame& rawFrame, size_t frameno)
 		if (frameList.size() > (size_t(2) << granuleShift)) {
 			// We've got more than twice as many frames
 			// as the maximum distance between key frames.
-			cli.printWarning("Cannot find frame ", frameno);
-			return;
+			warning("Cannot find frame ", frameno);
+			break;
 		}
 
 		// ..add read some new ones
 		if (!nextPacket()) {
-			return;
+			break;
 		}
 	}
-
-	yuv2rgb::convert(frame->buffer, rawFrame);
+	flushWarnings();
+	lock.unlock();
+	condition.notify_all(); // possibly room to read ahead again
+
+	// The decoder thread never touches the pixel data of a frame that's
+	// already in the frame list, so this can be done without the lock.
+	if (frame) {
+		yuv2rgb::convert(frame->buffer, rawFrame);
+	}
 }
 
 void OggReader::recycleAudio(std::unique_ptr<AudioFragment> audio)
@@ -679,6 +722,19 @@ void OggReader::recycleAudio(std::unique_ptr<AudioFragment> audio)
 }
 
 const AudioFragment* OggReader::getAudio(size_t sample)
+{
+	// Note: the decoder thread only appends new fragments to the audio
+	// list, so the returned fragment stays valid (and unchanged) until the
+	// next call to getAudio() or seek().
+	std::unique_lock<std::mutex> lock(mutex);
+	auto* result = getAudioImpl(sample);
+	flushWarnings();
+	lock.unlock();
+	condition.notify_all();
+	return result;
+}
+
+const AudioFragment* OggReader::getAudioImpl(size_t sample)
 {
 	// Read while position is unknown
 	while (audioList.empty() ||
@@ -752,15 +808,15 @@ bool OggReader::nextPacket()
 		int serial = ogg_page_serialno(&page);
 		if (serial == audioSerial) {
 			if (ogg_stream_pagein(&vorbisStream, &page)) {
-				cli.printWarning("Failed to submit vorbis page");
+				warning("Failed to submit vorbis page");
 			}
 		} else if (serial == videoSerial) {
 			if (ogg_stream_pagein(&theoraStream, &page)) {
-				cli.printWarning("Failed to submit theora page");
+				warning("Failed to submit theora page");
 			}
 		} else if (serial != skeletonSerial) {
-			cli.printWarning("Unexpected stream with serial ",
-			                 serial, " in ogg file");
+			warning("Unexpected stream with serial ",
+			        serial, " in ogg file");
 		}
 	}
 }
@@ -790,7 +846,7 @@ bool OggReader::nextPage(ogg_page* page)
 		fileOffset += chunk;
 
 		if (ogg_sync_wrote(&sync, long(chunk)) == -1) {
-			cli.printWarning("Internal error: ogg_sync_wrote failed");
+			warning("Internal error: ogg_sync_wrote failed");
 		}
 	}
 
@@ -863,6 +919,9 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 	// we assume that only data will be added to it and the ogg streams
 	// are exactly as before
 	fileSize = file.getSize();
+	if (indexReady && (fileSize == indexedSize)) {
+		return findOffsetIndexed(frame, sample);
+	}
 	auto offset = fileSize - 1;
 
 	while (offset > 0) {
@@ -933,8 +992,252 @@ size_t OggReader::findOffset(size_t frame, size_t sample)
 	return bisection(keyFrame, sample, maxOffset, maxSamples, maxFrames);
 }
 
+size_t OggReader::findOffsetIndexed(size_t frame, size_t sample)
+{
+	// Same result as the bisection in findOffset(), but using the index
+	// instead of reading (parts of) the file.
+	totalFrames = indexedFrames;
+
+	if (sample < getSampleRate() || frame <= 30) {
+		keyFrame = 1;
+		return 0;
+	}
+
+	// Like in findOffset(), don't search past the end of the file.
+	size_t maxSamples = audioIndex.empty() ? 0 : size_t(audioIndex.back().pos);
+	if ((sample > maxSamples) || (frame > indexedFrames)) {
+		sample = maxSamples;
+		frame = indexedFrames;
+	}
+
+	auto comparePos = [](const IndexEntry& e, uint64_t pos) { return e.pos < pos; };
+
+	// Find the key frame for the requested frame. The first page that ends
+	// with a frame at or after the requested one tells the key frame of
+	// that (later) frame. When that key frame is too late, the requested
+	// frame belongs to the key frame of the previous page.
+	auto v = std::lower_bound(begin(videoIndex), end(videoIndex), frame, comparePos);
+	if ((v != end(videoIndex)) && (v->keyFrame <= frame)) {
+		keyFrame = v->keyFrame;
+	} else if (v != begin(videoIndex)) {
+		keyFrame = std::prev(v)->keyFrame;
+	} else {
+		keyFrame = 1;
+	}
+
+	// Start at the last page that ends before the key frame, the key frame
+	// itself starts on that page or on one of the following pages.
+	auto k = std::lower_bound(begin(videoIndex), end(videoIndex), keyFrame, comparePos);
+	uint64_t videoOffset = (k == begin(videoIndex)) ? 0 : std::prev(k)->offset;
+
+	// Similar for audio: start one page before the requested sample, the
+	// vorbis decoder needs the previous packet to produce output.
+	auto a = std::lower_bound(begin(audioIndex), end(audioIndex), sample, comparePos);
+	uint64_t audioOffset = (a == begin(audioIndex)) ? 0 : std::prev(a)->offset;
+
+	return std::min(videoOffset, audioOffset);
+}
+
+bool OggReader::needReadAhead() const
+{
+	// Enough to bridge a hiccup of the host of about half a second.
+	static const size_t READ_AHEAD_FRAMES = 16;
+	static const size_t READ_AHEAD_AUDIO = 64; // fragments of 2048 samples
+
+	return (frameList.size() < READ_AHEAD_FRAMES) &&
+	       (audioList.size() < READ_AHEAD_AUDIO);
+}
+
+void OggReader::decodeLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		condition.wait(lock, [this]() {
+			return exitDecoder || (!endOfStream && needReadAhead());
+		});
+		if (exitDecoder) break;
+
+		if (!nextPacket()) {
+			endOfStream = true;
+		}
+
+		// Give the main thread a chance to grab the lock between two
+		// packets.
+		lock.unlock();
+		std::this_thread::yield();
+		lock.lock();
+	}
+}
+
+// The index is cached in a file next to the ogg file:
+//   8 bytes    magic "OGGIDX01"
+//   8 bytes    size of the ogg file
+//   8 bytes    number of video entries (V)
+//   8 bytes    number of audio entries (A)
+//   V*24 bytes video entries (offset, pos, keyFrame)
+//   A*16 bytes audio entries (offset, pos)
+// All numbers are stored as 64-bit little endian values.
+static const char INDEX_MAGIC[8] = {'O', 'G', 'G', 'I', 'D', 'X', '0', '1'};
+static const size_t INDEX_HEADER_SIZE = 32;
+
+static std::string getIndexFilename(const std::string& filename)
+{
+	return filename + ".idx";
+}
+
+void OggReader::indexLoop()
+{
+	size_t size;
+	try {
+		File f(filename);
+		size = f.getSize();
+	} catch (MSXException&) {
+		return;
+	}
+
+	if (!loadIndex(size)) {
+		if (!buildIndex(size)) return; // aborted or failed
+		saveIndex(size);
+	}
+
+	indexedSize = size;
+	indexedFrames = 0;
+	for (auto& e : videoIndex) {
+		indexedFrames = std::max<size_t>(indexedFrames, e.pos);
+	}
+	indexReady = true;
+}
+
+bool OggReader::loadIndex(size_t size)
+{
+	try {
+		File f(getIndexFilename(filename));
+		size_t idxSize = f.getSize();
+		if (idxSize < INDEX_HEADER_SIZE) return false;
+		MemBuffer<uint8_t> buf(idxSize);
+		f.read(buf.data(), idxSize);
+
+		if (memcmp(buf.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) return false;
+		if (Endian::read_UA_L64(&buf[8]) != size) return false; // ogg file changed
+		uint64_t numVideo = Endian::read_UA_L64(&buf[16]);
+		uint64_t numAudio = Endian::read_UA_L64(&buf[24]);
+		if ((numVideo > idxSize) || (numAudio > idxSize) ||
+		    (INDEX_HEADER_SIZE + numVideo * 24 + numAudio * 16 != idxSize)) {
+			return false;
+		}
+
+		const uint8_t* p = &buf[INDEX_HEADER_SIZE];
+		videoIndex.resize(numVideo);
+		for (auto& e : videoIndex) {
+			e.offset   = Endian::read_UA_L64(p +  0);
+			e.pos      = Endian::read_UA_L64(p +  8);
+			e.keyFrame = Endian::read_UA_L64(p + 16);
+			p += 24;
+		}
+		audioIndex.resize(numAudio);
+		for (auto& e : audioIndex) {
+			e.offset   = Endian::read_UA_L64(p + 0);
+			e.pos      = Endian::read_UA_L64(p + 8);
+			e.keyFrame = 0;
+			p += 16;
+		}
+		return true;
+	} catch (MSXException&) {
+		// no (valid) index file
+		videoIndex.clear();
+		audioIndex.clear();
+		return false;
+	}
+}
+
+bool OggReader::buildIndex(size_t size)
+{
+	// Only look at the page headers, nothing gets decoded. This uses
+	// its own file handle and ogg sync state, so it doesn't interfere
+	// with the decoder.
+	static const size_t CHUNK = 64 * 1024;
+
+	ogg_sync_state idxSync;
+	ogg_sync_init(&idxSync);
+	bool result = true;
+	try {
+		File f(filename);
+		uint64_t pageOffset = 0;
+		size_t offset = 0;
+		while (true) {
+			ogg_page page;
+			long ret = ogg_sync_pageseek(&idxSync, &page);
+			if (ret < 0) {
+				// skipped bytes (not synced to a page yet)
+				pageOffset += -ret;
+				continue;
+			}
+			if (ret > 0) {
+				uint64_t start = pageOffset;
+				pageOffset += ret;
+				ogg_int64_t granule = ogg_page_granulepos(&page);
+				if (granule == -1) continue;
+				int serial = ogg_page_serialno(&page);
+				if (serial == videoSerial) {
+					uint64_t key = uint64_t(granule) >> granuleShift;
+					uint64_t intra = uint64_t(granule) & ((uint64_t(1) << granuleShift) - 1);
+					videoIndex.push_back({start, key + intra, key});
+				} else if (serial == audioSerial) {
+					audioIndex.push_back({start, uint64_t(granule), 0});
+				}
+				continue;
+			}
+
+			// need more data
+			if (exitIndexer || (offset == size)) break;
+			size_t chunk = std::min(CHUNK, size - offset);
+			char* buffer = ogg_sync_buffer(&idxSync, long(chunk));
+			f.read(buffer, chunk);
+			offset += chunk;
+			ogg_sync_wrote(&idxSync, long(chunk));
+		}
+		if (exitIndexer) result = false;
+	} catch (MSXException&) {
+		result = false;
+	}
+	ogg_sync_clear(&idxSync);
+	return result;
+}
+
+void OggReader::saveIndex(size_t size)
+{
+	size_t bufSize = INDEX_HEADER_SIZE +
+	                 videoIndex.size() * 24 + audioIndex.size() * 16;
+	MemBuffer<uint8_t> buf(bufSize);
+	memcpy(buf.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	Endian::write_UA_L64(&buf[ 8], size);
+	Endian::write_UA_L64(&buf[16], videoIndex.size());
+	Endian::write_UA_L64(&buf[24], audioIndex.size());
+	uint8_t* p = &buf[INDEX_HEADER_SIZE];
+	for (auto& e : videoIndex) {
+		Endian::write_UA_L64(p +  0, e.offset);
+		Endian::write_UA_L64(p +  8, e.pos);
+		Endian::write_UA_L64(p + 16, e.keyFrame);
+		p += 24;
+	}
+	for (auto& e : audioIndex) {
+		Endian::write_UA_L64(p + 0, e.offset);
+		Endian::write_UA_L64(p + 8, e.pos);
+		p += 16;
+	}
+	try {
+		File f(getIndexFilename(filename), File::TRUNCATE);
+		f.write(buf.data(), bufSize);
+	} catch (MSXException&) {
+		// Ignore, e.g. the directory is read-only. The index will be
+		// rebuilt next time.
+	}
+}
+
 bool OggReader::seek(size_t frame, size_t samples)
 {
+	std::unique_lock<std::mutex> lock(mutex);
+
 	// Remove all queued frames
 	recycleFrameList.insert(end(recycleFrameList),
 		make_move_iterator(begin(frameList)),
@@ -961,6 +1264,10 @@ bool OggReader::seek(size_t frame, size_t samples)
 
 	vorbis_synthesis_restart(&vd);
 
+	endOfStream = false;
+	flushWarnings();
+	lock.unlock();
+	condition.notify_all();
 	return true;
 }
 
@@ -3,11 +3,18 @@
 
 #include "File.hh"
 #include "circular_buffer.hh"
+#include "strCat.hh"
 #include <ogg/ogg.h>
 #include <vorbis/codec.h>
 #include <theora/theoradec.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <list>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -36,6 +43,20 @@ struct Frame
 	int length;
 };
 
+/** Decodes the audio and video from a laserdisc image (an ogg file with one
+  * theora and one vorbis stream).
+  *
+  * Two helper threads keep this responsive:
+  * - A decoder thread reads (and decodes) ahead of the requested position,
+  *   so that getFrameNo() and getAudio() usually only have to pick up
+  *   already decoded data. All decoder state is protected by a single
+  *   mutex, the public methods can still decode themselves when the data
+  *   isn't available yet (e.g. directly after a seek).
+  * - An indexer thread builds a table with the position of all pages in the
+  *   file. Once it's available, seek() is a table lookup instead of a
+  *   bisection over the file. The table is cached in a file next to the
+  *   ogg file (when possible), so it only needs to be built once.
+  */
 class OggReader
 {
 public:
@@ -57,7 +78,19 @@ public:
 	size_t getChapter(int chapterNo) const;
 
 private:
+	/** The ogg pages of one stream that have a granule position, in file
+	  * order. For video 'pos' is the (last) frame number that ends on the
+	  * page, for audio it's the sample number at the end of the page.
+	  */
+	struct IndexEntry {
+		uint64_t offset;
+		uint64_t pos;
+		uint64_t keyFrame; // video only
+	};
+	using Index = std::vector<IndexEntry>;
+
 	void cleanup();
+	void stopThreads();
 	void readTheora(ogg_packet* packet);
 	void theoraHeaderPage(ogg_page* page, th_info& ti, th_comment& tc,
 	                      th_setup_info*& tsi);
@@ -67,14 +100,36 @@ private:
 	bool nextPage(ogg_page* page);
 	bool nextPacket();
 	void recycleAudio(std::unique_ptr<AudioFragment> audio);
+	const AudioFragment* getAudioImpl(size_t sample);
 	void vorbisFoundPosition();
 	size_t frameNo(ogg_packet* packet);
 
 	size_t findOffset(size_t frame, size_t sample);
+	size_t findOffsetIndexed(size_t frame, size_t sample);
 	size_t bisection(size_t frame, size_t sample,
 	                 size_t maxOffset, size_t maxSamples, size_t maxFrames);
 
+	// decoder thread
+	void decodeLoop();
+	bool needReadAhead() const;
+
+	// indexer thread
+	void indexLoop();
+	bool loadIndex(size_t size);
+	bool buildIndex(size_t size);
+	void saveIndex(size_t size);
+
+	/** Warnings can be generated on the decoder thread. CliComm may only
+	  * be used from the main thread, so they are queued and printed from
+	  * the public methods (see flushWarnings()).
+	  */
+	template<typename... Args> void warning(Args&& ...args) {
+		warnings.push_back(strCat(std::forward<Args>(args)...));
+	}
+	void flushWarnings();
+
 	CliComm& cli;
+	const std::string filename;
 	File file;
 
 	enum State {
@@ -119,6 +174,25 @@ private:
 	// Metadata
 	std::vector<size_t> stopFrames;
 	std::vector<std::pair<int, size_t>> chapters;
+
+	// Seek index, written by the indexer thread, only read by the
+	// other threads after indexReady is set.
+	Index videoIndex;
+	Index audioIndex;
+	size_t indexedSize; // file size when the index was built
+	size_t indexedFrames;
+	std::atomic<bool> indexReady;
+	std::atomic<bool> exitIndexer;
+	std::thread indexThread;
+
+	// Decoder thread. 'mutex' protects all the decoder state above
+	// (everything except the index and metadata).
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<std::string> warnings;
+	bool endOfStream;
+	bool exitDecoder;
+	std::thread decodeThread;
 };
 
 } // namespace openmsx
@@ -32,6 +32,9 @@ public:
 	const byte* getReadCacheLine(word start) const override;
 	byte* getWriteCacheLine(word start) const override;
 	byte peekMem(word address, EmuTime::param time) const override;
+	int getVisibleBlock(word address) const override {
+		return registers[address >> 14];
+	}
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
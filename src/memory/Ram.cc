@@ -1,6 +1,9 @@
 #include "Ram.hh"
 #include "DeviceConfig.hh"
 #include "SimpleDebuggable.hh"
+#include "MSXMotherBoard.hh"
+#include "MSXCPU.hh"
+#include "MemoryCoverage.hh"
 #include "XMLElement.hh"
 #include "Base64.hh"
 #include "HexDump.hh"
@@ -8,6 +11,7 @@
 #include "serialize.hh"
 #include <zlib.h>
 #include <algorithm>
+#include <cassert>
 #include <cstring>
 #include <memory>
 
@@ -20,9 +24,12 @@ class RamDebuggable final : public SimpleDebuggable
 public:
 	RamDebuggable(MSXMotherBoard& motherBoard, const string& name,
 	              const string& description, Ram& ram);
+	~RamDebuggable();
 	byte read(unsigned address) override;
+	void readBlock(unsigned start, byte* output, unsigned num) override;
 	void write(unsigned address, byte value) override;
 private:
+	MemoryCoverage& coverage;
 	Ram& ram;
 };
 
@@ -101,8 +108,15 @@ RamDebuggable::RamDebuggable(MSXMotherBoard& motherBoard_,
                              const string& name_,
                              const string& description_, Ram& ram_)
 	: SimpleDebuggable(motherBoard_, name_, description_, ram_.getSize())
+	, coverage(motherBoard_.getCPU().getCoverage())
 	, ram(ram_)
 {
+	coverage.registerMemory(this, getName(), &ram[0], ram.getSize());
+}
+
+RamDebuggable::~RamDebuggable()
+{
+	coverage.unregisterMemory(this);
 }
 
 byte RamDebuggable::read(unsigned address)
@@ -110,6 +124,12 @@ byte RamDebuggable::read(unsigned address)
 	return ram[address];
 }
 
+void RamDebuggable::readBlock(unsigned start, byte* output, unsigned num)
+{
+	assert((start + num) <= ram.getSize());
+	memcpy(output, &ram[start], num);
+}
+
 void RamDebuggable::write(unsigned address, byte value)
 {
 	ram[address] = value;
@@ -11,6 +11,8 @@
 #include "Reactor.hh"
 #include "Debugger.hh"
 #include "Debuggable.hh"
+#include "MSXCPU.hh"
+#include "MemoryCoverage.hh"
 #include "CliComm.hh"
 #include "FilePool.hh"
 #include "ConfigException.hh"
@@ -31,15 +33,18 @@ namespace openmsx {
 class RomDebuggable final : public Debuggable
 {
 public:
-	RomDebuggable(Debugger& debugger, Rom& rom);
+	RomDebuggable(Debugger& debugger, MemoryCoverage& coverage, Rom& rom);
 	~RomDebuggable();
 	unsigned getSize() const override;
 	const std::string& getDescription() const override;
 	byte read(unsigned address) override;
+	void readBlock(unsigned start, byte* output, unsigned num) override;
 	void write(unsigned address, byte value) override;
 	void moved(Rom& r);
+	void dataChanged();
 private:
 	Debugger& debugger;
+	MemoryCoverage& coverage;
 	Rom* rom;
 };
 
@@ -314,7 +319,8 @@ void Rom::init(MSXMotherBoard& motherBoard, const XMLElement& config,
 
 	// Only create the debuggable once all checks succeeded.
 	if (size) {
-		romDebuggable = std::make_unique<RomDebuggable>(debugger, *this);
+		romDebuggable = std::make_unique<RomDebuggable>(
+			debugger, motherBoard.getCPU().getCoverage(), *this);
 	}
 }
 
@@ -381,16 +387,20 @@ void Rom::addPadding(unsigned newSize, byte filler)
 	extendedRom = std::move(tmp);
 	rom = newData;
 	size = newSize;
+	if (romDebuggable) romDebuggable->dataChanged();
 }
 
-RomDebuggable::RomDebuggable(Debugger& debugger_, Rom& rom_)
-	: debugger(debugger_), rom(&rom_)
+RomDebuggable::RomDebuggable(Debugger& debugger_, MemoryCoverage& coverage_,
+                             Rom& rom_)
+	: debugger(debugger_), coverage(coverage_), rom(&rom_)
 {
 	debugger.registerDebuggable(rom->getName(), *this);
+	coverage.registerMemory(this, rom->getName(), &(*rom)[0], rom->getSize());
 }
 
 RomDebuggable::~RomDebuggable()
 {
+	coverage.unregisterMemory(this);
 	debugger.unregisterDebuggable(rom->getName(), *this);
 }
 
@@ -410,6 +420,12 @@ byte RomDebuggable::read(unsigned address)
 	return (*rom)[address];
 }
 
+void RomDebuggable::readBlock(unsigned start, byte* output, unsigned num)
+{
+	assert((start + num) <= getSize());
+	memcpy(output, &(*rom)[start], num);
+}
+
 void RomDebuggable::write(unsigned /*address*/, byte /*value*/)
 {
 	// ignore
@@ -420,4 +436,10 @@ void RomDebuggable::moved(Rom& r)
 	rom = &r;
 }
 
+void RomDebuggable::dataChanged()
+{
+	coverage.unregisterMemory(this);
+	coverage.registerMemory(this, rom->getName(), &(*rom)[0], rom->getSize());
+}
+
 } // namespace openmsx
@@ -82,7 +82,7 @@ void RomBlocks<BANK_SIZE>::setBank(byte region, const byte* adr, int block)
 	                       (adr <= &(*sram)[sram->getSize() - 1])) ||
 	        ((extraMem <= adr) && (adr <= &extraMem[extraSize - 1]))));
 	bankPtr[region] = adr;
-	blockNr[region] = block; // only for debuggable
+	blockNr[region] = block; // only for debuggable and profiler
 	invalidateMemCache(region * BANK_SIZE, BANK_SIZE);
 }
 
@@ -20,6 +20,10 @@ public:
 	byte readMem(word address, EmuTime::param time) override;
 	byte peekMem(word address, EmuTime::param time) const override;
 	const byte* getReadCacheLine(word address) const override;
+	int getVisibleBlock(word address) const override {
+		// 255 means unmapped (or a non-ROM block, e.g. SRAM)
+		return blockNr[address / BANK_SIZE];
+	}
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
@@ -11,6 +11,7 @@
 #include "BooleanSetting.hh"
 #include "CommandException.hh"
 #include "AviRecorder.hh"
+#include "SharedMemoryExport.hh"
 #include "Filename.hh"
 #include "CliComm.hh"
 #include "Math.hh"
@@ -48,6 +49,7 @@ MSXMixer::MSXMixer(Mixer& mixer_, MSXMotherBoard& motherBoard_,
 	, prevTime(getCurrentTime(), 44100)
 	, soundDeviceInfo(commandController.getMachineInfoCommand())
 	, recorder(nullptr)
+	, shmExport(nullptr)
 	, synchronousCounter(0)
 {
 	hostSampleRate = 44100;
@@ -68,6 +70,9 @@ MSXMixer::~MSXMixer()
 	if (recorder) {
 		recorder->stop();
 	}
+	if (shmExport) {
+		shmExport->stop();
+	}
 	assert(infos.empty());
 
 	throttleManager.detach(*this);
@@ -182,6 +187,9 @@ void MSXMixer::updateStream(EmuTime::param time)
 	if (recorder) {
 		recorder->addWave(count, mixBuffer);
 	}
+	if (shmExport) {
+		shmExport->addWave(count, mixBuffer, prevTime.getTime());
+	}
 
 	prevTime += count;
 }
@@ -603,6 +611,16 @@ void MSXMixer::setRecorder(AviRecorder* newRecorder)
 	recorder = newRecorder;
 }
 
+void MSXMixer::setSharedMemoryExport(SharedMemoryExport* newShmExport)
+{
+	// Like for recording: generate sound independent of the host sound
+	// device, so that the exported audio matches the emulated time.
+	if ((shmExport != nullptr) != (newShmExport != nullptr)) {
+		setSynchronousMode(newShmExport != nullptr);
+	}
+	shmExport = newShmExport;
+}
+
 void MSXMixer::update(const Setting& setting)
 {
 	if (&setting == &masterVolume) {
@@ -23,6 +23,7 @@ class StringSetting;
 class BooleanSetting;
 class Setting;
 class AviRecorder;
+class SharedMemoryExport;
 
 class MSXMixer final : private Schedulable, private Observer<Setting>
                      , private Observer<ThrottleManager>
@@ -107,6 +108,9 @@ public:
 	bool needStereoRecording() const;
 	void setRecorder(AviRecorder* recorder);
 
+	// Called by SharedMemoryExport
+	void setSharedMemoryExport(SharedMemoryExport* shmExport);
+
 	// Returns the nominal host sample rate (not adjusted for speed setting)
 	unsigned getSampleRate() const { return hostSampleRate; }
 
@@ -170,6 +174,7 @@ private:
 	} soundDeviceInfo;
 
 	AviRecorder* recorder;
+	SharedMemoryExport* shmExport;
 	unsigned synchronousCounter;
 
 	unsigned muteCount;
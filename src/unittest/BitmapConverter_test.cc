@@ -0,0 +1,145 @@
+#include "catch.hpp"
+#include "BitmapConverter.hh"
+#include "build-info.hh"
+#include "components.hh"
+#include <cstdint>
+#include <vector>
+
+using namespace openmsx;
+
+// Compare the (possibly SIMD optimized) converters against straightforward
+// palette lookups.
+
+template<typename Pixel> struct Fixture
+{
+	Fixture()
+		: palette16(32), palette256(256), palette32768(32768)
+		, vram0(128), vram1(128), out(512)
+		, converter(palette16.data(), palette256.data(), palette32768.data())
+	{
+		uint32_t seed = 12345;
+		auto rnd = [&]() { seed = seed * 1103515245 + 12345; return seed >> 8; };
+		for (auto& p : palette16)    p = Pixel(rnd());
+		for (auto& p : palette256)   p = Pixel(rnd());
+		for (auto& p : palette32768) p = Pixel(rnd());
+		for (auto& v : vram0) v = byte(rnd());
+		for (auto& v : vram1) v = byte(rnd());
+	}
+
+	std::vector<Pixel> palette16, palette256, palette32768;
+	std::vector<byte> vram0, vram1;
+	std::vector<Pixel> out;
+	BitmapConverter<Pixel> converter;
+};
+
+template<typename Pixel> static void testGraphic4()
+{
+	Fixture<Pixel> f;
+	f.converter.setDisplayMode(DisplayMode(0x06, 0, 0)); // screen 5
+	f.converter.convertLine(f.out.data(), f.vram0.data());
+	for (unsigned i = 0; i < 128; ++i) {
+		byte d = f.vram0[i];
+		CHECK(f.out[2 * i + 0] == f.palette16[d >> 4]);
+		CHECK(f.out[2 * i + 1] == f.palette16[d & 15]);
+	}
+}
+
+template<typename Pixel> static void testGraphic5()
+{
+	Fixture<Pixel> f;
+	f.converter.setDisplayMode(DisplayMode(0x08, 0, 0)); // screen 6
+	f.converter.convertLine(f.out.data(), f.vram0.data());
+	for (unsigned i = 0; i < 128; ++i) {
+		byte d = f.vram0[i];
+		CHECK(f.out[4 * i + 0] == f.palette16[ 0 +  (d >> 6)     ]);
+		CHECK(f.out[4 * i + 1] == f.palette16[16 + ((d >> 4) & 3)]);
+		CHECK(f.out[4 * i + 2] == f.palette16[ 0 + ((d >> 2) & 3)]);
+		CHECK(f.out[4 * i + 3] == f.palette16[16 + ((d >> 0) & 3)]);
+	}
+}
+
+template<typename Pixel> static void testGraphic6()
+{
+	Fixture<Pixel> f;
+	f.converter.setDisplayMode(DisplayMode(0x0A, 0, 0)); // screen 7
+	f.converter.convertLinePlanar(f.out.data(), f.vram0.data(), f.vram1.data());
+	for (unsigned i = 0; i < 128; ++i) {
+		byte d0 = f.vram0[i];
+		byte d1 = f.vram1[i];
+		CHECK(f.out[4 * i + 0] == f.palette16[d0 >> 4]);
+		CHECK(f.out[4 * i + 1] == f.palette16[d0 & 15]);
+		CHECK(f.out[4 * i + 2] == f.palette16[d1 >> 4]);
+		CHECK(f.out[4 * i + 3] == f.palette16[d1 & 15]);
+	}
+}
+
+template<typename Pixel> static void testGraphic7()
+{
+	Fixture<Pixel> f;
+	f.converter.setDisplayMode(DisplayMode(0x0E, 0, 0)); // screen 8
+	f.converter.convertLinePlanar(f.out.data(), f.vram0.data(), f.vram1.data());
+	for (unsigned i = 0; i < 128; ++i) {
+		CHECK(f.out[2 * i + 0] == f.palette256[f.vram0[i]]);
+		CHECK(f.out[2 * i + 1] == f.palette256[f.vram1[i]]);
+	}
+}
+
+#if HAVE_16BPP
+TEST_CASE("BitmapConverter, 16bpp")
+{
+	testGraphic4<uint16_t>();
+	testGraphic5<uint16_t>();
+	testGraphic6<uint16_t>();
+	testGraphic7<uint16_t>();
+}
+#endif
+
+#if HAVE_32BPP || COMPONENT_GL
+TEST_CASE("BitmapConverter, 32bpp")
+{
+	testGraphic4<uint32_t>();
+	testGraphic5<uint32_t>();
+	testGraphic6<uint32_t>();
+	testGraphic7<uint32_t>();
+}
+#endif
+
+
+// Timing per display mode. Hidden, run explicitly with the "[benchmark]" tag.
+// For a before/after comparison of the SIMD code, run it in a build with and
+// one without SSSE3 enabled (e.g. -mssse3).
+
+template<typename Pixel> static void benchmarkModes()
+{
+	Fixture<Pixel> f;
+	f.converter.setDisplayMode(DisplayMode(0x06, 0, 0));
+	BENCHMARK("Graphic4") {
+		f.converter.convertLine(f.out.data(), f.vram0.data());
+	}
+	f.converter.setDisplayMode(DisplayMode(0x08, 0, 0));
+	BENCHMARK("Graphic5") {
+		f.converter.convertLine(f.out.data(), f.vram0.data());
+	}
+	f.converter.setDisplayMode(DisplayMode(0x0A, 0, 0));
+	BENCHMARK("Graphic6") {
+		f.converter.convertLinePlanar(f.out.data(), f.vram0.data(), f.vram1.data());
+	}
+	f.converter.setDisplayMode(DisplayMode(0x0E, 0, 0));
+	BENCHMARK("Graphic7") {
+		f.converter.convertLinePlanar(f.out.data(), f.vram0.data(), f.vram1.data());
+	}
+}
+
+#if HAVE_16BPP
+TEST_CASE("BitmapConverter benchmark, 16bpp", "[.][benchmark]")
+{
+	benchmarkModes<uint16_t>();
+}
+#endif
+
+#if HAVE_32BPP || COMPONENT_GL
+TEST_CASE("BitmapConverter benchmark, 32bpp", "[.][benchmark]")
+{
+	benchmarkModes<uint32_t>();
+}
+#endif
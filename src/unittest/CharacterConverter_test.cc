@@ -0,0 +1,124 @@
+#include "catch.hpp"
+#include "CharacterDraw.hh"
+#include "build-info.hh"
+#include "components.hh"
+#include <cstdint>
+#include <vector>
+
+using namespace openmsx;
+
+// Compare the (possibly SIMD optimized) draw6()/draw8() functions that are
+// used by CharacterConverter against the plain C++ versions, for all
+// foreground/background/pattern combinations.
+
+template<typename Pixel> static std::vector<Pixel> getPalette()
+{
+	uint32_t seed = 12345;
+	auto rnd = [&]() { seed = seed * 1103515245 + 12345; return seed >> 8; };
+	std::vector<Pixel> palette(16);
+	for (auto& p : palette) p = Pixel(rnd());
+	palette[15] = Pixel(~0u); // also test all bits set
+	return palette;
+}
+
+template<typename Pixel, typename Draw, typename DrawCpp>
+static void testDraw(unsigned width, Draw draw, DrawCpp drawCpp)
+{
+	const Pixel GUARD = Pixel(0x5A5A5A5A);
+	auto palette = getPalette<Pixel>();
+	for (auto fg : palette) {
+		for (auto bg : palette) {
+			for (unsigned pattern = 0; pattern < 256; ++pattern) {
+				std::vector<Pixel> expected(8 + 1, GUARD);
+				std::vector<Pixel> out     (8 + 1, GUARD);
+				Pixel* __restrict p1 = expected.data();
+				Pixel* __restrict p2 = out.data();
+				drawCpp(p1, fg, bg, byte(pattern));
+				draw   (p2, fg, bg, byte(pattern));
+				CHECK(p1 == expected.data() + width);
+				CHECK(p2 == out.data() + width);
+				CHECK(out == expected); // also nothing written past the end
+			}
+		}
+	}
+}
+
+template<typename Pixel> static void testDraw6()
+{
+	testDraw<Pixel>(6,
+		[](Pixel* __restrict & p, Pixel fg, Pixel bg, byte pattern) {
+			CharacterDraw::draw6(p, fg, bg, pattern); },
+		[](Pixel* __restrict & p, Pixel fg, Pixel bg, byte pattern) {
+			CharacterDraw::draw6Cpp(p, fg, bg, pattern); });
+}
+
+template<typename Pixel> static void testDraw8()
+{
+	testDraw<Pixel>(8,
+		[](Pixel* __restrict & p, Pixel fg, Pixel bg, byte pattern) {
+			CharacterDraw::draw8(p, fg, bg, pattern); },
+		[](Pixel* __restrict & p, Pixel fg, Pixel bg, byte pattern) {
+			CharacterDraw::draw8Cpp(p, fg, bg, pattern); });
+}
+
+#if HAVE_16BPP
+TEST_CASE("CharacterConverter, 16bpp")
+{
+	testDraw6<uint16_t>();
+	testDraw8<uint16_t>();
+}
+#endif
+
+#if HAVE_32BPP || COMPONENT_GL
+TEST_CASE("CharacterConverter, 32bpp")
+{
+	testDraw6<uint32_t>();
+	testDraw8<uint32_t>();
+}
+#endif
+
+
+// Timing of the plain C++ versions against the (possibly SIMD) versions
+// that are actually used. Hidden, run explicitly with the "[benchmark]" tag.
+
+template<typename Pixel> static void benchmarkDraw()
+{
+	auto palette = getPalette<Pixel>();
+	std::vector<Pixel> out(256 * 8);
+	auto line = [&](auto draw) {
+		Pixel* __restrict p = out.data();
+		for (unsigned i = 0; i < 256; ++i) {
+			draw(p, palette[i & 15], palette[i >> 4], byte(i * 37));
+		}
+	};
+	BENCHMARK("draw6, C++") {
+		line([](Pixel* __restrict & p, Pixel fg, Pixel bg, byte pat) {
+			CharacterDraw::draw6Cpp(p, fg, bg, pat); });
+	}
+	BENCHMARK("draw6") {
+		line([](Pixel* __restrict & p, Pixel fg, Pixel bg, byte pat) {
+			CharacterDraw::draw6(p, fg, bg, pat); });
+	}
+	BENCHMARK("draw8, C++") {
+		line([](Pixel* __restrict & p, Pixel fg, Pixel bg, byte pat) {
+			CharacterDraw::draw8Cpp(p, fg, bg, pat); });
+	}
+	BENCHMARK("draw8") {
+		line([](Pixel* __restrict & p, Pixel fg, Pixel bg, byte pat) {
+			CharacterDraw::draw8(p, fg, bg, pat); });
+	}
+}
+
+#if HAVE_16BPP
+TEST_CASE("CharacterConverter benchmark, 16bpp", "[.][benchmark]")
+{
+	benchmarkDraw<uint16_t>();
+}
+#endif
+
+#if HAVE_32BPP || COMPONENT_GL
+TEST_CASE("CharacterConverter benchmark, 32bpp", "[.][benchmark]")
+{
+	benchmarkDraw<uint32_t>();
+}
+#endif
@@ -0,0 +1,127 @@
+#include "catch.hpp"
+#include "DebugExpression.hh"
+#include "Debuggable.hh"
+#include "CommandException.hh"
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+
+class TestDebuggable final : public Debuggable
+{
+public:
+	explicit TestDebuggable(unsigned size) : data(size) {}
+	unsigned getSize() const override { return unsigned(data.size()); }
+	const std::string& getDescription() const override { return description; }
+	byte read(unsigned address) override { return data[address]; }
+	void write(unsigned address, byte value) override { data[address] = value; }
+
+	std::vector<byte> data;
+	std::string description;
+};
+
+class TestContext final : public DebugExpression::Context
+{
+public:
+	TestContext() : regs(28), memory(0x10000) {}
+	Debuggable* findDebuggable(string_view name) override {
+		if (name == "CPU regs") return &regs;
+		if (name == "memory") return &memory;
+		return nullptr;
+	}
+
+	TestDebuggable regs;
+	TestDebuggable memory;
+};
+
+static int64_t eval(string_view str, TestContext& context)
+{
+	auto expr = DebugExpression::compile(str);
+	REQUIRE(expr);
+	return expr->eval(context);
+}
+
+static int64_t eval(string_view str)
+{
+	TestContext context;
+	return eval(str, context);
+}
+
+static bool supported(string_view str)
+{
+	return DebugExpression::compile(str) != nullptr;
+}
+
+TEST_CASE("DebugExpression: literals and operators")
+{
+	CHECK(eval("42") == 42);
+	CHECK(eval("0x2A") == 42);
+	CHECK(eval("0o52") == 42);
+	CHECK(eval("0b101010") == 42);
+	CHECK(eval(" 1 + 2 - 4 ") == -1);
+	CHECK(eval("-3") == -3);
+	CHECK(eval("~0") == -1);
+	CHECK(eval("!0") == 1);
+	CHECK(eval("!5") == 0);
+	CHECK(eval("1 + 2 == 3") == 1);
+	CHECK(eval("1 != 1") == 0);
+	CHECK(eval("2 < 3 && 3 <= 3 && 4 > 3 && 3 >= 4") == 0);
+	CHECK(eval("0 || 3 > 2") == 1);
+	CHECK(eval("0xF0 & 0x3C") == 0x30);
+	CHECK(eval("0xF0 | 0x0F") == 0xFF);
+	CHECK(eval("0xFF ^ 0x0F") == 0xF0);
+	CHECK(eval("1 | 2 == 2") == 1); // same precedence as in Tcl
+	CHECK(eval("(1 | 2) == 2") == 0);
+	CHECK(eval("1 ? 2 : 3") == 2);
+	CHECK(eval("0 ? 2 : 0 ? 3 : 4") == 4);
+}
+
+TEST_CASE("DebugExpression: registers and memory")
+{
+	TestContext context;
+	context.regs.data[0] = 3;    // A
+	context.regs.data[1] = 0x44; // F
+	context.regs.data[6] = 0x12; // H
+	context.regs.data[7] = 0x34; // L
+	context.memory.data[0xF3AE] = 7;
+	context.memory.data[0x1234] = 0x78;
+	context.memory.data[0x1235] = 0x56;
+
+	CHECK(eval("[reg A]", context) == 3);
+	CHECK(eval("[reg a]", context) == 3);
+	CHECK(eval("[reg AF]", context) == 0x0344);
+	CHECK(eval("[reg HL]", context) == 0x1234);
+	CHECK(eval("[peek 0xF3AE]", context) == 7);
+	CHECK(eval("[peek [reg HL]]", context) == 0x78);
+	CHECK(eval("[peek16 0x1234]", context) == 0x5678);
+	CHECK(eval("[peek16_BE 0x1234]", context) == 0x7856);
+	CHECK(eval("[peek 0x1234 memory]", context) == 0x78);
+	CHECK(eval("[debug read memory 0x1234]", context) == 0x78);
+	CHECK(eval("[debug read {CPU regs} 0]", context) == 3);
+	CHECK(eval("[debug read \"CPU regs\" 0]", context) == 3);
+	CHECK(eval("[reg A] == 3 && [peek 0xF3AE] != 0", context) == 1);
+	CHECK(eval("[reg A]==3&&[peek 0xF3AE]==0", context) == 0);
+
+	CHECK_THROWS_AS(eval("[peek16 0xFFFF]", context), CommandException);
+	CHECK_THROWS_AS(eval("[debug read foo 0]", context), CommandException);
+}
+
+TEST_CASE("DebugExpression: left to Tcl")
+{
+	CHECK(!supported(""));
+	CHECK(!supported("$x == 3"));
+	CHECK(!supported("[reg A] * 2"));
+	CHECK(!supported("[reg A] / 2"));
+	CHECK(!supported("1 << 2"));
+	CHECK(!supported("010")); // octal or decimal, depends on Tcl version
+	CHECK(!supported("[reg A] eq 3"));
+	CHECK(!supported("[reg XYZ]"));
+	CHECK(!supported("[reg A 3]")); // writes the register
+	CHECK(!supported("[peek_s8 0]"));
+	CHECK(!supported("[peek $addr]"));
+	CHECK(!supported("[foo]"));
+	CHECK(!supported("[peek 1; peek 2]"));
+	CHECK(!supported("(1"));
+	CHECK(!supported("1 = 1"));
+	CHECK(!supported("1 2"));
+}
@@ -0,0 +1,100 @@
+#include "catch.hpp"
+#include "FileSystemWatcher.hh"
+#include "FileOperations.hh"
+#include "strCat.hh"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+using std::string;
+using std::vector;
+
+static void writeFile(const string& filename, const char* content)
+{
+	auto file = FileOperations::openFile(filename, "wb");
+	REQUIRE(file);
+	fputs(content, file.get());
+}
+
+TEST_CASE("FileSystemWatcher")
+{
+	string root = strCat(FileOperations::getTempDir(), "/openmsx_FileSystemWatcher_test");
+	FileOperations::deleteRecursive(root);
+	FileOperations::mkdirp(root + "/sub");
+	writeFile(root + "/sub/old", "old");
+
+	FileSystemWatcher watcher(root, true);
+	if (watcher.isPolling()) {
+		// No inotify on this platform, changes are always 'unknown'.
+		CHECK(watcher.getChanges().all);
+		FileOperations::deleteRecursive(root);
+		return;
+	}
+
+	SECTION("no changes") {
+		CHECK(watcher.getChanges().empty());
+	}
+	SECTION("create") {
+		writeFile(root + "/a", "a");
+		writeFile(root + "/sub/b", "b");
+		auto changes = watcher.getChanges();
+		CHECK(!changes.all);
+		CHECK(changes.paths == vector<string>{root + "/a", root + "/sub/b"});
+		CHECK(watcher.getChanges().empty()); // reported only once
+	}
+	SECTION("modify") {
+		writeFile(root + "/sub/old", "new");
+		auto changes = watcher.getChanges();
+		CHECK(changes.paths == vector<string>{root + "/sub/old"});
+	}
+	SECTION("delete") {
+		FileOperations::unlink(root + "/sub/old");
+		auto changes = watcher.getChanges();
+		CHECK(changes.paths == vector<string>{root + "/sub/old"});
+	}
+	SECTION("rename") {
+		REQUIRE(rename((root + "/sub/old").c_str(), (root + "/new").c_str()) == 0);
+		auto changes = watcher.getChanges();
+		CHECK(changes.paths == vector<string>{root + "/new", root + "/sub/old"});
+	}
+	SECTION("new subdirectory") {
+		FileOperations::mkdirp(root + "/dir");
+		auto changes = watcher.getChanges();
+		CHECK(changes.paths == vector<string>{root + "/dir"});
+		// files in the new directory are reported as well
+		writeFile(root + "/dir/c", "c");
+		changes = watcher.getChanges();
+		CHECK(changes.paths == vector<string>{root + "/dir/c"});
+	}
+	SECTION("root removed and recreated") {
+		FileOperations::deleteRecursive(root);
+		CHECK(watcher.getChanges().all);
+		CHECK(watcher.getChanges().all); // as long as it doesn't exist
+		FileOperations::mkdirp(root);
+		CHECK(watcher.getChanges().all); // contents unknown
+		writeFile(root + "/d", "d");
+		auto changes = watcher.getChanges();
+		CHECK(changes.paths == vector<string>{root + "/d"});
+	}
+
+	FileOperations::deleteRecursive(root);
+}
+
+TEST_CASE("FileSystemWatcher: missing root")
+{
+	string root = strCat(FileOperations::getTempDir(), "/openmsx_FileSystemWatcher_test2");
+	FileOperations::deleteRecursive(root);
+
+	FileSystemWatcher watcher(root, false);
+	CHECK(watcher.getChanges().all);
+	FileOperations::mkdirp(root);
+	CHECK(watcher.getChanges().all);
+	if (!watcher.isPolling()) {
+		writeFile(root + "/a", "a");
+		auto changes = watcher.getChanges();
+		CHECK(changes.paths == vector<string>{root + "/a"});
+	}
+
+	FileOperations::deleteRecursive(root);
+}
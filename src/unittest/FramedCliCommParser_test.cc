@@ -0,0 +1,65 @@
+#include "catch.hpp"
+#include "FramedCliCommParser.hh"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static string frame(char type, const string& payload)
+{
+	uint32_t len = uint32_t(payload.size() + 1);
+	string result;
+	result += char(len >> 24);
+	result += char(len >> 16);
+	result += char(len >>  8);
+	result += char(len >>  0);
+	result += type;
+	result += payload;
+	return result;
+}
+
+static vector<string> parse(const string& stream, size_t chunk = string::npos)
+{
+	vector<string> result;
+	FramedCliCommParser parser([&](const string& cmd) { result.push_back(cmd); });
+	for (size_t i = 0; i < stream.size(); i += chunk) {
+		size_t n = std::min(chunk, stream.size() - i);
+		parser.parse(stream.data() + i, n);
+	}
+	return result;
+}
+
+TEST_CASE("FramedCliCommParser")
+{
+	SECTION("single command") {
+		CHECK(parse(frame('C', "foo")) == vector<string>{"foo"});
+		CHECK(parse(frame('C', "")) == vector<string>{""});
+	}
+	SECTION("no escaping") {
+		CHECK(parse(frame('C', "<command>&amp;")) ==
+		      vector<string>{"<command>&amp;"});
+		CHECK(parse(frame('C', string("a\0b", 3))) ==
+		      vector<string>{string("a\0b", 3)});
+	}
+	SECTION("pipelined commands") {
+		string s = frame('C', "foo") + frame('C', "bar") + frame('C', "baz");
+		vector<string> expected = {"foo", "bar", "baz"};
+		CHECK(parse(s) == expected);
+		// split at every possible position
+		for (size_t chunk = 1; chunk < s.size(); ++chunk) {
+			CHECK(parse(s, chunk) == expected);
+		}
+	}
+	SECTION("unknown and empty frames are skipped") {
+		CHECK(parse(frame('X', "foo") + frame('C', "bar")) ==
+		      vector<string>{"bar"});
+		CHECK(parse(string(4, '\0') + frame('C', "bar")) ==
+		      vector<string>{"bar"});
+	}
+	SECTION("too big frames are skipped") {
+		string big = "\x7f\xff\xff\xff";
+		// don't actually send 2GB, only check that the parser doesn't
+		// store anything and still waits for the rest of the frame
+		CHECK(parse(big + frame('C', "foo")) == vector<string>{});
+	}
+}
@@ -0,0 +1,47 @@
+#include "catch.hpp"
+#include "IntervalIndex.hh"
+#include <vector>
+
+using namespace openmsx;
+
+static std::vector<int> query(const IntervalIndex<int>& index, unsigned point)
+{
+	std::vector<int> result;
+	index.query(point, result);
+	return result;
+}
+
+TEST_CASE("IntervalIndex")
+{
+	IntervalIndex<int> index;
+	CHECK(index.empty());
+	CHECK(query(index, 0).empty());
+
+	index.add(0x4000, 0x7FFF, 1);
+	index.add(0x1000, 0x1000, 2);
+	index.add(0x0000, 0xFFFF, 3);
+	index.add(0x5000, 0x5001, 4);
+	index.add(0x1000, 0x10FF, 5);
+	index.build();
+	CHECK(!index.empty());
+
+	CHECK(query(index, 0x0000) == std::vector<int>{3});
+	CHECK(query(index, 0x0FFF) == std::vector<int>{3});
+	CHECK(query(index, 0x1000) == (std::vector<int>{2, 3, 5}));
+	CHECK(query(index, 0x1001) == (std::vector<int>{3, 5}));
+	CHECK(query(index, 0x1100) == std::vector<int>{3});
+	CHECK(query(index, 0x4000) == (std::vector<int>{1, 3}));
+	CHECK(query(index, 0x5001) == (std::vector<int>{1, 3, 4}));
+	CHECK(query(index, 0x5002) == (std::vector<int>{1, 3}));
+	CHECK(query(index, 0xFFFF) == std::vector<int>{3});
+	CHECK(query(index, 0x10000).empty());
+
+	index.clear();
+	CHECK(index.empty());
+	index.add(10, 20, 6);
+	index.build();
+	CHECK(query(index, 9).empty());
+	CHECK(query(index, 10) == std::vector<int>{6});
+	CHECK(query(index, 20) == std::vector<int>{6});
+	CHECK(query(index, 21).empty());
+}
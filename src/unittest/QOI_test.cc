@@ -0,0 +1,131 @@
+#include "catch.hpp"
+#include "QOI.hh"
+#include <cstdint>
+#include <vector>
+
+using namespace openmsx;
+
+static std::vector<uint8_t> encode(unsigned width, unsigned height,
+                                   const std::vector<uint8_t>& rgb)
+{
+	std::vector<const void*> rows(height);
+	for (unsigned y = 0; y < height; ++y) {
+		rows[y] = &rgb[3 * width * y];
+	}
+	return QOI::encode(width, height, rows.data());
+}
+
+// Straightforward decoder, written directly from the specification.
+// Returns RGBA pixels.
+static std::vector<uint8_t> decode(const std::vector<uint8_t>& data)
+{
+	std::vector<uint8_t> result;
+	uint8_t index[64][4] = {};
+	uint8_t px[4] = {0, 0, 0, 255};
+	size_t end = data.size() - 8;
+	for (size_t i = 14; i < end; /**/) {
+		uint8_t b = data[i++];
+		unsigned repeat = 1;
+		if (b == 0xfe) {
+			px[0] = data[i++]; px[1] = data[i++]; px[2] = data[i++];
+		} else if (b == 0xff) {
+			px[0] = data[i++]; px[1] = data[i++]; px[2] = data[i++];
+			px[3] = data[i++];
+		} else if ((b & 0xc0) == 0x00) {
+			for (int c = 0; c < 4; ++c) px[c] = index[b][c];
+		} else if ((b & 0xc0) == 0x40) {
+			px[0] += ((b >> 4) & 3) - 2;
+			px[1] += ((b >> 2) & 3) - 2;
+			px[2] += ((b >> 0) & 3) - 2;
+		} else if ((b & 0xc0) == 0x80) {
+			int vg = (b & 0x3f) - 32;
+			uint8_t b2 = data[i++];
+			px[0] += vg + (b2 >> 4) - 8;
+			px[1] += vg;
+			px[2] += vg + (b2 & 15) - 8;
+		} else {
+			repeat = (b & 0x3f) + 1;
+		}
+		unsigned h = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+		for (int c = 0; c < 4; ++c) index[h][c] = px[c];
+		for (unsigned r = 0; r < repeat; ++r) {
+			result.insert(result.end(), px, px + 4);
+		}
+	}
+	return result;
+}
+
+// Add an opaque alpha channel to RGB pixels.
+static std::vector<uint8_t> toRgba(const std::vector<uint8_t>& rgb)
+{
+	std::vector<uint8_t> result;
+	for (size_t i = 0; i < rgb.size(); i += 3) {
+		result.insert(result.end(), {rgb[i + 0], rgb[i + 1], rgb[i + 2], 255});
+	}
+	return result;
+}
+
+TEST_CASE("QOI")
+{
+	SECTION("small image") {
+		// Expected output worked out by hand from the specification.
+		std::vector<uint8_t> rgb = {
+			0, 0, 0,    0, 0, 0,
+			1, 2, 3,  200, 0, 0,
+		};
+		std::vector<uint8_t> expected = {
+			'q', 'o', 'i', 'f', 0, 0, 0, 2, 0, 0, 0, 2, 3, 0,
+			0xc1,             // run of 2 (same as initial black)
+			0xa2, 0x79,       // luma: dg=2, dr-dg=-1, db-dg=1
+			0xfe, 200, 0, 0,  // full rgb
+			0, 0, 0, 0, 0, 0, 0, 1,
+		};
+		CHECK(encode(2, 2, rgb) == expected);
+	}
+	SECTION("long run") {
+		std::vector<uint8_t> rgb(3 * 100, 0);
+		rgb[3 * 99 + 1] = 1;
+		std::vector<uint8_t> expected = {
+			'q', 'o', 'i', 'f', 0, 0, 0, 100, 0, 0, 0, 1, 3, 0,
+			0xfd,             // run of 62
+			0xe4,             // run of 37
+			0x6e,             // diff: dr=0, dg=1, db=0
+			0, 0, 0, 0, 0, 0, 0, 1,
+		};
+		CHECK(encode(100, 1, rgb) == expected);
+	}
+	SECTION("round trip") {
+		uint32_t seed = 1;
+		auto rnd = [&]() { seed = seed * 1103515245 + 12345; return seed >> 16; };
+		std::vector<uint8_t> rgb(3 * 37 * 23);
+		uint8_t prev[3] = {0, 0, 0};
+		for (size_t i = 0; i < rgb.size(); i += 3) {
+			// mix of runs, small and large differences
+			unsigned kind = rnd() % 4;
+			for (int c = 0; c < 3; ++c) {
+				if (kind == 1) prev[c] += rnd() % 4 - 2;
+				if (kind == 2) prev[c] += rnd() % 16 - 8;
+				if (kind == 3) prev[c] = rnd();
+				rgb[i + c] = prev[c];
+			}
+		}
+		CHECK(decode(encode(37, 23, rgb)) == toRgba(rgb));
+	}
+	SECTION("black after other color") {
+		// Opaque black isn't in the (zero-filled, so transparent)
+		// initial index, it must not be encoded as an index reference.
+		std::vector<uint8_t> rgb = {
+			10, 10, 10,   0,  0,  0,  50, 60, 70,
+			 0,  0,  0,  10, 10, 10,  50, 60, 70,
+		};
+		auto data = encode(6, 1, rgb);
+		// first pixel: luma (2 bytes), then the black pixel
+		CHECK(data[16] == 0x96); // luma dg=-10 (not OP_INDEX 53)
+		auto rgba = decode(data);
+		REQUIRE(rgba.size() == 6 * 4);
+		for (unsigned i = 0; i < 6; ++i) {
+			CHECK(rgba[4 * i + 3] == 255);
+		}
+		CHECK(rgba == toRgba(rgb));
+	}
+}
@@ -156,6 +156,31 @@ TEST_CASE("TclObject, operator=")
 		buf[0] = 99;
 		CHECK(result[0] == 1);
 	}
+	SECTION("setBinary") {
+		TclObject t2 = t; // shared
+		uint8_t* p = t.setBinary(3);
+		p[0] = 4; p[1] = 5; p[2] = 6;
+		auto result = t.getBinary();
+		REQUIRE(result.size() == 3);
+		CHECK(result.data() == p);
+		CHECK(result[2] == 6);
+		CHECK(t2.getString() == "123");
+	}
+	SECTION("clear") {
+		Tcl_Obj* p = t.getTclObject();
+		t.clear(); // not shared, reused
+		CHECK(t.getTclObject() == p);
+		CHECK(t.getString() == "");
+		t = 42;
+		CHECK(t.getTclObject() == p);
+		CHECK(t.getString() == "42");
+
+		TclObject t2 = t; // shared
+		t.clear();
+		CHECK(t.getTclObject() != p);
+		CHECK(t.getString() == "");
+		CHECK(t2.getString() == "42");
+	}
 	SECTION("copy") {
 		TclObject t2(true);
 		REQUIRE(t2.getString() == "1");
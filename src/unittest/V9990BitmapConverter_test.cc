@@ -0,0 +1,72 @@
+#include "catch.hpp"
+#include "V9990BitmapConverter.hh"
+#include "Math.hh"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace openmsx;
+
+// Straightforward implementation of the YUV/YJK formulas, the (possibly SIMD
+// optimized) convertYUV() function must produce identical output.
+template<bool YJK, bool PAL>
+static void reference(const byte* in, uint16_t* out, unsigned num)
+{
+	for (unsigned i = 0; i < num; i += 4) {
+		const byte* data = in + i;
+		int u = (data[2] & 7) + ((data[3] & 3) << 3) - ((data[3] & 4) << 3);
+		int v = (data[0] & 7) + ((data[1] & 3) << 3) - ((data[1] & 4) << 3);
+		for (int j = 0; j < 4; ++j) {
+			if (PAL && (data[j] & 0x08)) {
+				out[i + j] = 0x8000 | (data[j] >> 4);
+			} else {
+				int y = (data[j] & 0xF8) >> 3;
+				int r = Math::clip<0, 31>(y + u);
+				int g = Math::clip<0, 31>((5 * y - 2 * u - v) / 4);
+				int b = Math::clip<0, 31>(y + v);
+				if (YJK) std::swap(g, b);
+				out[i + j] = (g << 10) + (r << 5) + b;
+			}
+		}
+	}
+}
+
+template<bool YJK, bool PAL>
+static void test(const std::vector<byte>& in)
+{
+	unsigned num = unsigned(in.size());
+	std::vector<uint16_t> expected(num), actual(num);
+	reference<YJK, PAL>(in.data(), expected.data(), num);
+	convertYUV<YJK, PAL>(in.data(), actual.data(), num);
+	CHECK(actual == expected);
+}
+
+TEST_CASE("V9990BitmapConverter, convertYUV")
+{
+	// All combinations of U and V, each with a range of Y values, palette
+	// bits and a few odd block counts (to exercise the non-SIMD tail).
+	std::vector<byte> in;
+	for (unsigned uv = 0; uv < 64 * 64; ++uv) {
+		unsigned u = uv & 63;
+		unsigned v = uv >> 6;
+		for (unsigned k = 0; k < 32; k += 3) {
+			for (unsigned j = 0; j < 4; ++j) {
+				unsigned uvBits = (j < 2) ? (v >> (3 * j))
+				                          : (u >> (3 * (j - 2)));
+				unsigned yBits = ((k + 11 * j) & 31) << 3;
+				in.push_back(byte(yBits | (uvBits & 7)));
+			}
+		}
+	}
+	for (unsigned n : {4u, 12u, 20u, 1028u}) {
+		std::vector<byte> part(begin(in), begin(in) + n);
+		test<false, false>(part);
+		test<false, true >(part);
+		test<true,  false>(part);
+		test<true,  true >(part);
+	}
+	test<false, false>(in);
+	test<false, true >(in);
+	test<true,  false>(in);
+	test<true,  true >(in);
+}
@@ -0,0 +1,89 @@
+#ifndef INTERVALINDEX_HH
+#define INTERVALINDEX_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace openmsx {
+
+/** A (static) index on a set of closed intervals [begin, end], to quickly
+  * find all intervals that contain a given point.
+  *
+  * The intervals are kept sorted on their begin point, together with the
+  * maximum end point of all intervals up to that position. A query does a
+  * binary search for the last interval that starts at or before the point
+  * and then walks back as long as an earlier interval can still reach the
+  * point. So a query is O(log(n) + k) when the intervals don't nest too
+  * deeply, which is the typical case (and never worse than a linear scan).
+  *
+  * Modifications are relatively expensive (the index is rebuilt), this is
+  * meant for sets that are queried a lot more often than they change.
+  */
+template<typename T> class IntervalIndex
+{
+public:
+	void clear() {
+		entries.clear();
+		maxEnd.clear();
+	}
+
+	bool empty() const { return entries.empty(); }
+
+	/** Add an interval, call build() before doing queries. */
+	void add(unsigned begin, unsigned end, const T& value) {
+		assert(begin <= end);
+		entries.push_back({begin, end, entries.size(), value});
+	}
+
+	/** (Re)build the index after adding intervals. */
+	void build() {
+		std::sort(entries.begin(), entries.end(),
+		          [](const Entry& x, const Entry& y) {
+			return x.begin < y.begin;
+		});
+		maxEnd.resize(entries.size());
+		unsigned m = 0;
+		for (size_t i = 0; i < entries.size(); ++i) {
+			m = std::max(m, entries[i].end);
+			maxEnd[i] = m;
+		}
+	}
+
+	/** Append the values of all intervals that contain 'point' to
+	  * 'result', in the order in which they were added. */
+	void query(unsigned point, std::vector<T>& result) const {
+		auto it = std::upper_bound(entries.begin(), entries.end(), point,
+		                           [](unsigned p, const Entry& e) {
+			return p < e.begin;
+		});
+		size_t i = it - entries.begin();
+		while ((i != 0) && (maxEnd[i - 1] >= point)) {
+			--i;
+			if (entries[i].end >= point) {
+				found.push_back(i);
+			}
+		}
+		std::sort(found.begin(), found.end(), [&](size_t x, size_t y) {
+			return entries[x].seq < entries[y].seq;
+		});
+		for (auto f : found) result.push_back(entries[f].value);
+		found.clear();
+	}
+
+private:
+	struct Entry {
+		unsigned begin;
+		unsigned end;
+		size_t seq; // order of insertion
+		T value;
+	};
+	std::vector<Entry> entries; // sorted on begin (after build())
+	std::vector<unsigned> maxEnd; // max 'end' in entries[0..i]
+	mutable std::vector<size_t> found; // only to avoid reallocations
+};
+
+} // namespace openmsx
+
+#endif
@@ -1,6 +1,7 @@
 #include "Poller.hh"
 
 #ifndef _WIN32
+#include <cerrno>
 #include <cstdio>
 #include <poll.h>
 #include <unistd.h>
@@ -59,6 +60,41 @@ bool Poller::poll(int fd)
 		}
 	}
 }
+
+bool Poller::poll(std::vector<pollfd>& fds)
+{
+	fds.push_back({ .fd = wakeupPipe[0], .events = POLLIN, .revents = 0 });
+	while (true) {
+		int pollResult = ::poll(fds.data(), fds.size(), 1000);
+		if (abortFlag) {
+			fds.pop_back();
+			return true;
+		}
+		if ((pollResult == -1) && (errno != EINTR)) { // error
+			fds.pop_back();
+			return true;
+		}
+		if (pollResult > 0) { // no timeout
+			if (fds.back().revents) {
+				// consume the wakeup() calls
+				char dummy[16];
+				if (read(wakeupPipe[0], dummy, sizeof(dummy)) == -1) {
+					// ignore
+				}
+			}
+			fds.pop_back();
+			return false;
+		}
+	}
+}
+
+void Poller::wakeup()
+{
+	char dummy = 'W';
+	if (write(wakeupPipe[1], &dummy, sizeof(dummy)) == -1) {
+		// Nothing we can do here; we'll have to rely on the poll() timeout.
+	}
+}
 #endif
 
 } // namespace openmsx
@@ -2,6 +2,10 @@
 #define POLLER_HH
 
 #include <atomic>
+#ifndef _WIN32
+#include <poll.h>
+#include <vector>
+#endif
 
 namespace openmsx {
 
@@ -21,6 +25,19 @@ public:
 	  * Returns true iff abort() was called or an error occurred.
 	  */
 	bool poll(int fd);
+
+	/** Waits for an event to occur on any of the given file descriptors
+	  * (entries with a negative fd are ignored), the 'revents' fields are
+	  * filled in. Also returns when wakeup() is called.
+	  * Returns true iff abort() was called or an error occurred.
+	  */
+	bool poll(std::vector<pollfd>& fds);
+
+	/** Makes a poll in progress (or the next one) return, without
+	  * aborting future poll attempts. E.g. to let it wait for a
+	  * different set of file descriptors.
+	  */
+	void wakeup();
 #endif
 
 	/** Returns true iff abort() was called.
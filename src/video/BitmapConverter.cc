@@ -6,8 +6,73 @@
 #include "components.hh"
 #include <cstdint>
 
+#ifdef __SSSE3__
+#include "tmmintrin.h"
+#endif
+
 namespace openmsx {
 
+#ifdef __SSSE3__
+/** Palette lookup of 16 pixels at once using pshufb: the palette (at most
+  * 16 entries) is split in byte planes, each plane is then a 16-entry byte
+  * lookup table.
+  */
+template<typename Pixel> class PaletteLUT
+{
+public:
+	PaletteLUT(const Pixel* palette, unsigned num)
+	{
+		byte tmp[4][16] = {};
+		for (unsigned i = 0; i < num; ++i) {
+			Pixel p = palette[i];
+			for (unsigned k = 0; k < sizeof(Pixel); ++k) {
+				tmp[k][i] = (p >> (8 * k)) & 0xFF;
+			}
+		}
+		for (unsigned k = 0; k < 4; ++k) {
+			plane[k] = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(tmp[k]));
+		}
+	}
+
+	/** Write the pixels for 16 palette indices. */
+	inline void lookup(Pixel* out, __m128i idx) const
+	{
+		auto* o = reinterpret_cast<__m128i*>(out);
+		__m128i b0 = _mm_shuffle_epi8(plane[0], idx);
+		__m128i b1 = _mm_shuffle_epi8(plane[1], idx);
+		__m128i l01 = _mm_unpacklo_epi8(b0, b1);
+		__m128i h01 = _mm_unpackhi_epi8(b0, b1);
+		if (sizeof(Pixel) == 2) {
+			_mm_storeu_si128(o + 0, l01);
+			_mm_storeu_si128(o + 1, h01);
+		} else {
+			__m128i b2 = _mm_shuffle_epi8(plane[2], idx);
+			__m128i b3 = _mm_shuffle_epi8(plane[3], idx);
+			__m128i l23 = _mm_unpacklo_epi8(b2, b3);
+			__m128i h23 = _mm_unpackhi_epi8(b2, b3);
+			_mm_storeu_si128(o + 0, _mm_unpacklo_epi16(l01, l23));
+			_mm_storeu_si128(o + 1, _mm_unpackhi_epi16(l01, l23));
+			_mm_storeu_si128(o + 2, _mm_unpacklo_epi16(h01, h23));
+			_mm_storeu_si128(o + 3, _mm_unpackhi_epi16(h01, h23));
+		}
+	}
+
+private:
+	__m128i plane[4]; // only 2 used for 16bpp
+};
+
+// Split 16 bytes in their high and low nibbles.
+static inline __m128i highNibbles(__m128i v)
+{
+	return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+static inline __m128i lowNibbles(__m128i v)
+{
+	return _mm_and_si128(v, _mm_set1_epi8(0x0F));
+}
+#endif
+
 template <class Pixel>
 BitmapConverter<Pixel>::BitmapConverter(
 	const Pixel* palette16_, const Pixel* palette256_,
@@ -121,6 +186,20 @@ void BitmapConverter<Pixel>::renderGraphic4(
 		pixelPtr[2 * i + 3] = palette16[data1 & 15];
 	}*/
 
+#ifdef __SSSE3__
+	PaletteLUT<Pixel> lut(palette16, 16);
+	auto vin = reinterpret_cast<const __m128i*>(vramPtr0);
+	for (unsigned i = 0; i < 128 / 16; ++i) {
+		// 32 pixels per iteration
+		__m128i v = _mm_loadu_si128(vin + i);
+		__m128i h = highNibbles(v);
+		__m128i l = lowNibbles(v);
+		lut.lookup(pixelPtr + 32 * i +  0, _mm_unpacklo_epi8(h, l));
+		lut.lookup(pixelPtr + 32 * i + 16, _mm_unpackhi_epi8(h, l));
+	}
+	return;
+#endif
+
 	if (unlikely(!dPaletteValid)) {
 		calcDPalette();
 	}
@@ -205,6 +284,36 @@ void BitmapConverter<Pixel>::renderGraphic5(
 	Pixel*      __restrict pixelPtr,
 	const byte* __restrict vramPtr0)
 {
+#ifdef __SSSE3__
+	// Even pixels use palette entries 0-3, odd pixels use 16-19.
+	Pixel tab[8] = {
+		palette16[ 0], palette16[ 1], palette16[ 2], palette16[ 3],
+		palette16[16], palette16[17], palette16[18], palette16[19]
+	};
+	PaletteLUT<Pixel> lut(tab, 8);
+	auto vin = reinterpret_cast<const __m128i*>(vramPtr0);
+	const __m128i m3 = _mm_set1_epi8(3);
+	const __m128i m4 = _mm_set1_epi8(4);
+	for (unsigned i = 0; i < 128 / 16; ++i) {
+		// 64 pixels per iteration
+		__m128i v = _mm_loadu_si128(vin + i);
+		__m128i s6 =                _mm_and_si128(_mm_srli_epi16(v, 6), m3);
+		__m128i s4 = _mm_or_si128(m4, _mm_and_si128(_mm_srli_epi16(v, 4), m3));
+		__m128i s2 =                _mm_and_si128(_mm_srli_epi16(v, 2), m3);
+		__m128i s0 = _mm_or_si128(m4, _mm_and_si128(v, m3));
+		__m128i a0 = _mm_unpacklo_epi8(s6, s4);
+		__m128i b0 = _mm_unpacklo_epi8(s2, s0);
+		__m128i a1 = _mm_unpackhi_epi8(s6, s4);
+		__m128i b1 = _mm_unpackhi_epi8(s2, s0);
+		Pixel* out = pixelPtr + 64 * i;
+		lut.lookup(out +  0, _mm_unpacklo_epi16(a0, b0));
+		lut.lookup(out + 16, _mm_unpackhi_epi16(a0, b0));
+		lut.lookup(out + 32, _mm_unpacklo_epi16(a1, b1));
+		lut.lookup(out + 48, _mm_unpackhi_epi16(a1, b1));
+	}
+	return;
+#endif
+
 	for (unsigned i = 0; i < 128; ++i) {
 		unsigned data = vramPtr0[i];
 		pixelPtr[4 * i + 0] = palette16[ 0 +  (data >> 6)     ];
@@ -228,6 +337,30 @@ void BitmapConverter<Pixel>::renderGraphic6(
 		pixelPtr[4 * i + 2] = palette16[data1 >> 4];
 		pixelPtr[4 * i + 3] = palette16[data1 & 15];
 	}*/
+#ifdef __SSSE3__
+	PaletteLUT<Pixel> lut(palette16, 16);
+	auto vin0 = reinterpret_cast<const __m128i*>(vramPtr0);
+	auto vin1 = reinterpret_cast<const __m128i*>(vramPtr1);
+	for (unsigned i = 0; i < 128 / 16; ++i) {
+		// 64 pixels per iteration
+		__m128i v0 = _mm_loadu_si128(vin0 + i);
+		__m128i v1 = _mm_loadu_si128(vin1 + i);
+		__m128i h0 = highNibbles(v0);
+		__m128i l0 = lowNibbles (v0);
+		__m128i h1 = highNibbles(v1);
+		__m128i l1 = lowNibbles (v1);
+		__m128i a0 = _mm_unpacklo_epi8(h0, l0);
+		__m128i b0 = _mm_unpacklo_epi8(h1, l1);
+		__m128i a1 = _mm_unpackhi_epi8(h0, l0);
+		__m128i b1 = _mm_unpackhi_epi8(h1, l1);
+		Pixel* out = pixelPtr + 64 * i;
+		lut.lookup(out +  0, _mm_unpacklo_epi16(a0, b0));
+		lut.lookup(out + 16, _mm_unpackhi_epi16(a0, b0));
+		lut.lookup(out + 32, _mm_unpacklo_epi16(a1, b1));
+		lut.lookup(out + 48, _mm_unpackhi_epi16(a1, b1));
+	}
+	return;
+#endif
 	if (unlikely(!dPaletteValid)) {
 		calcDPalette();
 	}
@@ -73,6 +73,15 @@ public:
 		dPaletteValid = false;
 	}
 
+	/** Bring lazily calculated internal state up-to-date. Must be called
+	  * before convertLine() or convertLinePlanar() is called from
+	  * multiple threads at the same time.
+	  */
+	inline void prepareConcurrentConvert()
+	{
+		if (!dPaletteValid) calcDPalette();
+	}
+
 private:
 	void calcDPalette();
 
@@ -8,16 +8,13 @@ TODO:
 */
 
 #include "CharacterConverter.hh"
+#include "CharacterDraw.hh"
 #include "VDP.hh"
 #include "VDPVRAM.hh"
 #include "build-info.hh"
 #include "components.hh"
 #include <cstdint>
 
-#ifdef __SSE2__
-#include "emmintrin.h" // SSE2
-#endif
-
 namespace openmsx {
 
 template <class Pixel>
@@ -81,62 +78,8 @@ void CharacterConverter<Pixel>::convertLine(Pixel* linePtr, int line)
 	}
 }
 
-#ifdef __SSE2__
-// Copied from Scale2xScaler.cc, TODO move to common location?
-static inline __m128i select(__m128i a0, __m128i a1, __m128i mask)
-{
-	return _mm_xor_si128(_mm_and_si128(_mm_xor_si128(a0, a1), mask), a0);
-}
-#endif
-
-template<typename Pixel> static inline void draw6(
-	Pixel* __restrict & pixelPtr, Pixel fg, Pixel bg, byte pattern)
-{
-	pixelPtr[0] = (pattern & 0x80) ? fg : bg;
-	pixelPtr[1] = (pattern & 0x40) ? fg : bg;
-	pixelPtr[2] = (pattern & 0x20) ? fg : bg;
-	pixelPtr[3] = (pattern & 0x10) ? fg : bg;
-	pixelPtr[4] = (pattern & 0x08) ? fg : bg;
-	pixelPtr[5] = (pattern & 0x04) ? fg : bg;
-	pixelPtr += 6;
-}
-
-template<typename Pixel> static inline void draw8(
-	Pixel* __restrict & pixelPtr, Pixel fg, Pixel bg, byte pattern)
-{
-#ifdef __SSE2__
-	// SSE2 version, 32bpp  (16bpp is possible, but not worth it anymore)
-	if (sizeof(Pixel) == 4) {
-		const __m128i m74 = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
-		const __m128i m30 = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
-		const __m128i zero = _mm_setzero_si128();
-
-		__m128i fg4 = _mm_set1_epi32(fg);
-		__m128i bg4 = _mm_set1_epi32(bg);
-		__m128i pat = _mm_set1_epi32(pattern);
-
-		__m128i b74 = _mm_cmpeq_epi32(_mm_and_si128(pat, m74), zero);
-		__m128i b30 = _mm_cmpeq_epi32(_mm_and_si128(pat, m30), zero);
-
-		auto* out = reinterpret_cast<__m128i*>(pixelPtr);
-		_mm_storeu_si128(out + 0, select(fg4, bg4, b74));
-		_mm_storeu_si128(out + 1, select(fg4, bg4, b30));
-		pixelPtr += 8;
-		return;
-	}
-#endif
-
-	// C++ version
-	pixelPtr[0] = (pattern & 0x80) ? fg : bg;
-	pixelPtr[1] = (pattern & 0x40) ? fg : bg;
-	pixelPtr[2] = (pattern & 0x20) ? fg : bg;
-	pixelPtr[3] = (pattern & 0x10) ? fg : bg;
-	pixelPtr[4] = (pattern & 0x08) ? fg : bg;
-	pixelPtr[5] = (pattern & 0x04) ? fg : bg;
-	pixelPtr[6] = (pattern & 0x02) ? fg : bg;
-	pixelPtr[7] = (pattern & 0x01) ? fg : bg;
-	pixelPtr += 8;
-}
+using CharacterDraw::draw6;
+using CharacterDraw::draw8;
 
 template <class Pixel>
 void CharacterConverter<Pixel>::renderText1(
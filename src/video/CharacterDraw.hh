@@ -0,0 +1,137 @@
+#ifndef CHARACTERDRAW_HH
+#define CHARACTERDRAW_HH
+
+#include "openmsx.hh"
+#include <cstdint>
+
+#ifdef __SSE2__
+#include "emmintrin.h" // SSE2
+#endif
+
+namespace openmsx {
+
+/** Draw one line of a character pattern: the pixels for which the pattern
+  * bit is set get the foreground color, the others the background color.
+  * draw6() draws the 6 most significant bits (text modes), draw8() all 8.
+  * 'pixelPtr' is advanced past the drawn pixels.
+  *
+  * There's a plain C++ version (draw6Cpp()/draw8Cpp()) and where it's
+  * worth it an SSE2 version. draw6()/draw8() select the best version. This
+  * is only used by CharacterConverter, it's in a header so that the unit
+  * test can compare both versions.
+  */
+namespace CharacterDraw {
+
+template<typename Pixel> inline void draw6Cpp(
+	Pixel* __restrict & pixelPtr, Pixel fg, Pixel bg, byte pattern)
+{
+	pixelPtr[0] = (pattern & 0x80) ? fg : bg;
+	pixelPtr[1] = (pattern & 0x40) ? fg : bg;
+	pixelPtr[2] = (pattern & 0x20) ? fg : bg;
+	pixelPtr[3] = (pattern & 0x10) ? fg : bg;
+	pixelPtr[4] = (pattern & 0x08) ? fg : bg;
+	pixelPtr[5] = (pattern & 0x04) ? fg : bg;
+	pixelPtr += 6;
+}
+
+template<typename Pixel> inline void draw8Cpp(
+	Pixel* __restrict & pixelPtr, Pixel fg, Pixel bg, byte pattern)
+{
+	pixelPtr[0] = (pattern & 0x80) ? fg : bg;
+	pixelPtr[1] = (pattern & 0x40) ? fg : bg;
+	pixelPtr[2] = (pattern & 0x20) ? fg : bg;
+	pixelPtr[3] = (pattern & 0x10) ? fg : bg;
+	pixelPtr[4] = (pattern & 0x08) ? fg : bg;
+	pixelPtr[5] = (pattern & 0x04) ? fg : bg;
+	pixelPtr[6] = (pattern & 0x02) ? fg : bg;
+	pixelPtr[7] = (pattern & 0x01) ? fg : bg;
+	pixelPtr += 8;
+}
+
+// Generic version, overloaded below for the pixel types that have an
+// SSE2 version.
+template<typename Pixel> inline void draw6(
+	Pixel* __restrict & pixelPtr, Pixel fg, Pixel bg, byte pattern)
+{
+	draw6Cpp(pixelPtr, fg, bg, pattern);
+}
+
+template<typename Pixel> inline void draw8(
+	Pixel* __restrict & pixelPtr, Pixel fg, Pixel bg, byte pattern)
+{
+	draw8Cpp(pixelPtr, fg, bg, pattern);
+}
+
+#ifdef __SSE2__
+// Copied from Scale2xScaler.cc, TODO move to common location?
+inline __m128i select(__m128i a0, __m128i a1, __m128i mask)
+{
+	return _mm_xor_si128(_mm_and_si128(_mm_xor_si128(a0, a1), mask), a0);
+}
+
+// SSE2 version, 32bpp  (16bpp is possible, but not worth it)
+inline void draw6(
+	uint32_t* __restrict & pixelPtr, uint32_t fg, uint32_t bg, byte pattern)
+{
+	const __m128i m74 = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+	const __m128i m32 = _mm_set_epi32(0x00, 0x00, 0x04, 0x08);
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i fg4 = _mm_set1_epi32(fg);
+	__m128i bg4 = _mm_set1_epi32(bg);
+	__m128i pat = _mm_set1_epi32(pattern);
+
+	__m128i b74 = _mm_cmpeq_epi32(_mm_and_si128(pat, m74), zero);
+	__m128i b32 = _mm_cmpeq_epi32(_mm_and_si128(pat, m32), zero);
+
+	auto* out = reinterpret_cast<__m128i*>(pixelPtr);
+	_mm_storeu_si128(out + 0, select(fg4, bg4, b74));
+	_mm_storel_epi64(out + 1, select(fg4, bg4, b32));
+	pixelPtr += 6;
+}
+
+// SSE2 version, 32bpp
+inline void draw8(
+	uint32_t* __restrict & pixelPtr, uint32_t fg, uint32_t bg, byte pattern)
+{
+	const __m128i m74 = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+	const __m128i m30 = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i fg4 = _mm_set1_epi32(fg);
+	__m128i bg4 = _mm_set1_epi32(bg);
+	__m128i pat = _mm_set1_epi32(pattern);
+
+	__m128i b74 = _mm_cmpeq_epi32(_mm_and_si128(pat, m74), zero);
+	__m128i b30 = _mm_cmpeq_epi32(_mm_and_si128(pat, m30), zero);
+
+	auto* out = reinterpret_cast<__m128i*>(pixelPtr);
+	_mm_storeu_si128(out + 0, select(fg4, bg4, b74));
+	_mm_storeu_si128(out + 1, select(fg4, bg4, b30));
+	pixelPtr += 8;
+}
+
+// SSE2 version, 16bpp
+inline void draw8(
+	uint16_t* __restrict & pixelPtr, uint16_t fg, uint16_t bg, byte pattern)
+{
+	const __m128i m70 = _mm_set_epi16(
+		0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i fg8 = _mm_set1_epi16(fg);
+	__m128i bg8 = _mm_set1_epi16(bg);
+	__m128i pat = _mm_set1_epi16(pattern);
+
+	__m128i b70 = _mm_cmpeq_epi16(_mm_and_si128(pat, m70), zero);
+
+	auto* out = reinterpret_cast<__m128i*>(pixelPtr);
+	_mm_storeu_si128(out, select(fg8, bg8, b70));
+	pixelPtr += 8;
+}
+#endif
+
+} // namespace CharacterDraw
+} // namespace openmsx
+
+#endif
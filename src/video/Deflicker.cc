@@ -135,6 +135,8 @@ const void* DeflickerImpl<Pixel>::getLineInfo(
 		return line0;
 	}
 
+	const Pixel* orig0 = line0;
+
 	// Prefer to write directly to the output buffer, if that's not
 	// possible store the intermediate result in a temp buffer.
 	VLA_SSE_ALIGNED(Pixel, buf2, width0);
@@ -148,6 +150,7 @@ const void* DeflickerImpl<Pixel>::getLineInfo(
 	// "A A A A" as alternating between "A" and "A", but that's fine.
 	Pixel* dst = out;
 	unsigned remaining = width0;
+	bool changed = false; // any pixel different from line0?
 #ifdef __SSE2__
 	size_t pixelsPerSSE = sizeof(__m128i) / sizeof(Pixel);
 	size_t widthSSE = remaining & ~(pixelsPerSSE - 1); // rounded down to a multiple of pixels in a SSE register
@@ -159,6 +162,7 @@ const void* DeflickerImpl<Pixel>::getLineInfo(
 	auto byteOffst = -ptrdiff_t(widthSSE * sizeof(Pixel));
 
 	Pixel blendMask = pixelOps.getBlendMask();
+	__m128i changedSSE = _mm_setzero_si128();
 	while (byteOffst < 0) {
 		__m128i a0 = uload(line0, byteOffst);
 		__m128i a1 = uload(line1, byteOffst);
@@ -173,16 +177,29 @@ const void* DeflickerImpl<Pixel>::getLineInfo(
 		__m128i p = _mm_xor_si128(a0, a01);
 		__m128i q = _mm_and_si128(p, cnd);
 		__m128i r = _mm_xor_si128(q, a0); // select(a0, a01, cnd)
+		changedSSE = _mm_or_si128(changedSSE, q); // q != 0 -> r != a0
 
 		ustore(dst, byteOffst, r);
 		byteOffst += sizeof(__m128i);
 	}
+	__m128i zero = _mm_setzero_si128();
+	changed = _mm_movemask_epi8(_mm_cmpeq_epi8(changedSSE, zero)) != 0xFFFF;
 	remaining &= pixelsPerSSE - 1;
 #endif
 	for (unsigned x = 0; x < remaining; ++x) {
 		dst[x] = ((line0[x] == line2[x]) && (line1[x] == line3[x]))
 		       ? pixelOps.template blend<1, 1>(line0[x], line1[x])
 	               : line0[x];
+		changed |= dst[x] != line0[x];
+	}
+
+	if (!changed) {
+		// Nothing flickers on this line (e.g. a static image), so the
+		// result is identical to the most recent frame. Return that line
+		// directly, then the caller doesn't need to go via our (copied
+		// and possibly rescaled) buffer.
+		width = width0;
+		return orig0;
 	}
 
 	if (width0 <= bufWidth) {
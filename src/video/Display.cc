@@ -3,6 +3,7 @@
 #include "Layer.hh"
 #include "VideoSystem.hh"
 #include "VideoLayer.hh"
+#include "PostProcessor.hh"
 #include "EventDistributor.hh"
 #include "FinishFrameEvent.hh"
 #include "FileOperations.hh"
@@ -39,9 +40,13 @@ Display::Display(Reactor& reactor_)
 	: RTSchedulable(reactor_.getRTScheduler())
 	, screenShotCmd(reactor_.getCommandController())
 	, fpsInfo(reactor_.getOpenMSXInfoCommand())
+	, frameHashInfo(reactor_.getOpenMSXInfoCommand())
 	, osdGui(reactor_.getCommandController(), *this)
 	, reactor(reactor_)
 	, renderSettings(reactor.getCommandController())
+	, screenShotWriter(reactor.getCommandController(),
+	                   reactor.getEventDistributor(),
+	                   reactor.getCliComm())
 	, commandConsole(reactor.getGlobalCommandController(),
 	                 reactor.getEventDistributor(), *this)
 	, currentRenderer(RenderSettings::UNINITIALIZED)
@@ -461,7 +466,8 @@ void Display::ScreenShotCmd::execute(span<const TclObject> tokens, TclObject& re
 		throw SyntaxError();
 	}
 	string filename = FileOperations::parseCommandFileArgument(
-		fname, "screenshots", prefix, ".png");
+		fname, "screenshots", prefix,
+		display.getScreenShotWriter().getExtension());
 
 	if (!rawShot) {
 		// include all layers (OSD stuff, console)
@@ -495,6 +501,7 @@ string Display::ScreenShotCmd::help(const vector<string>& /*tokens*/) const
 {
 	// Note: -no-sprites option is implemented in Tcl
 	return "screenshot                   Write screenshot to file \"openmsxNNNN.png\"\n"
+	       "                             (or .qoi, see 'screenshot_format' setting)\n"
 	       "screenshot <filename>        Write screenshot to indicated file\n"
 	       "screenshot -prefix foo       Write screenshot to file \"fooNNNN.png\"\n"
 	       "screenshot -raw              320x240 raw screenshot (of MSX screen only)\n"
@@ -531,4 +538,38 @@ string Display::FpsInfoTopic::help(const vector<string>& /*tokens*/) const
 	return "Returns the current rendering speed in frames per second.";
 }
 
+
+// FrameHashInfoTopic
+
+Display::FrameHashInfoTopic::FrameHashInfoTopic(InfoCommand& openMSXInfoCommand)
+	: InfoTopic(openMSXInfoCommand, "frame_hash")
+{
+}
+
+void Display::FrameHashInfoTopic::execute(span<const TclObject> /*tokens*/,
+                                          TclObject& result) const
+{
+	auto& display = OUTER(Display, frameHashInfo);
+	auto* postProcessor = dynamic_cast<PostProcessor*>(
+		display.findActiveLayer());
+	if (!postProcessor) {
+		throw CommandException(
+			"Current renderer doesn't support frame hashing.");
+	}
+	auto hash = postProcessor->getFrameHash();
+	if (hash.empty()) {
+		throw CommandException(
+			"No frame hash available, frame hashing can be "
+			"enabled with the 'frame_hash' setting.");
+	}
+	result = hash;
+}
+
+string Display::FrameHashInfoTopic::help(const vector<string>& /*tokens*/) const
+{
+	return "Returns the number and the hash of the most recently rendered "
+	       "frame: \"<frame-number> <hash>\". Requires the 'frame_hash' "
+	       "setting to be enabled.";
+}
+
 } // namespace openmsx
@@ -2,6 +2,7 @@
 #define DISPLAY_HH
 
 #include "RenderSettings.hh"
+#include "ScreenShotWriter.hh"
 #include "Command.hh"
 #include "CommandConsole.hh"
 #include "InfoTopic.hh"
@@ -42,6 +43,7 @@ public:
 
 	CliComm& getCliComm() const;
 	RenderSettings& getRenderSettings() { return renderSettings; }
+	ScreenShotWriter& getScreenShotWriter() { return screenShotWriter; }
 	OSDGUI& getOSDGUI() { return osdGui; }
 	CommandConsole& getCommandConsole() { return commandConsole; }
 
@@ -112,10 +114,18 @@ private:
 		std::string help(const std::vector<std::string>& tokens) const override;
 	} fpsInfo;
 
+	struct FrameHashInfoTopic final : InfoTopic {
+		explicit FrameHashInfoTopic(InfoCommand& openMSXInfoCommand);
+		void execute(span<const TclObject> tokens,
+			     TclObject& result) const override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+	} frameHashInfo;
+
 	OSDGUI osdGui;
 
 	Reactor& reactor;
 	RenderSettings renderSettings;
+	ScreenShotWriter screenShotWriter;
 	CommandConsole commandConsole;
 
 	// the current renderer
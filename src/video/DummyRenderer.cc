@@ -16,6 +16,9 @@ void DummyRenderer::frameStart(EmuTime::param /*time*/) {
 void DummyRenderer::frameEnd(EmuTime::param /*time*/) {
 }
 
+void DummyRenderer::getFrameSkipStats(TclObject& /*result*/) const {
+}
+
 void DummyRenderer::updateTransparency(bool /*enabled*/, EmuTime::param /*time*/) {
 }
 
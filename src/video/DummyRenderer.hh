@@ -16,6 +16,7 @@ public:
 	void reInit() override;
 	void frameStart(EmuTime::param time) override;
 	void frameEnd(EmuTime::param time) override;
+	void getFrameSkipStats(TclObject& result) const override;
 	void updateTransparency(bool enabled, EmuTime::param time) override;
 	void updateSuperimposing(const RawFrame* videoSource, EmuTime::param time) override;
 	void updateForegroundColor(int color, EmuTime::param time) override;
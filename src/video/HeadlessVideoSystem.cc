@@ -0,0 +1,129 @@
+#include "HeadlessVideoSystem.hh"
+#include "SDLOffScreenSurface.hh"
+#include "SDLSurfacePtr.hh"
+#include "SDLRasterizer.hh"
+#include "V9990SDLRasterizer.hh"
+#include "PostProcessor.hh"
+#include "VideoLayer.hh"
+#include "Display.hh"
+#include "MSXException.hh"
+#include "VDP.hh"
+#include "V9990.hh"
+#include "build-info.hh"
+#include <cstdint>
+#include <memory>
+
+#include "components.hh"
+#if COMPONENT_LASERDISC
+#include "LaserdiscPlayer.hh"
+#include "LDSDLRasterizer.hh"
+#endif
+
+namespace openmsx {
+
+// Use the same pixel format as the SDL renderer typically gets.
+#if HAVE_32BPP
+using Pixel = uint32_t;
+#else
+using Pixel = uint16_t;
+#endif
+
+/** Post processor that only keeps track of the last frames (needed for
+  * screenshots, recording, frame hashes, ...), but never paints them.
+  */
+class HeadlessPostProcessor final : public PostProcessor
+{
+public:
+	HeadlessPostProcessor(
+		MSXMotherBoard& motherBoard_, Display& display_,
+		OutputSurface& screen_, const std::string& videoSource,
+		unsigned maxWidth_, unsigned height_, bool canDoInterlace_)
+		: PostProcessor(motherBoard_, display_, screen_, videoSource,
+		                maxWidth_, height_, canDoInterlace_)
+	{
+	}
+
+	// Layer interface:
+	void paint(OutputSurface& /*output*/) override
+	{
+	}
+};
+
+HeadlessVideoSystem::HeadlessVideoSystem(Display& display_)
+	: display(display_)
+{
+#if HAVE_32BPP
+	SDLSurfacePtr proto(320, 240, 32,
+		0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+#else
+	SDLSurfacePtr proto(320, 240, 16, 0xF800, 0x07E0, 0x001F, 0x0000);
+#endif
+	surface = std::make_unique<SDLOffScreenSurface>(*proto.get());
+}
+
+HeadlessVideoSystem::~HeadlessVideoSystem() = default;
+
+std::unique_ptr<Rasterizer> HeadlessVideoSystem::createRasterizer(VDP& vdp)
+{
+	std::string videoSource = (vdp.getName() == "VDP")
+	                        ? "MSX" // for backwards compatibility
+	                        : vdp.getName();
+	auto& motherBoard = vdp.getMotherBoard();
+	return std::make_unique<SDLRasterizer<Pixel>>(
+		vdp, display, *surface,
+		std::make_unique<HeadlessPostProcessor>(
+			motherBoard, display, *surface,
+			videoSource, 640, 240, true));
+}
+
+std::unique_ptr<V9990Rasterizer> HeadlessVideoSystem::createV9990Rasterizer(
+	V9990& vdp)
+{
+	std::string videoSource = (vdp.getName() == "Sunrise GFX9000")
+	                        ? "GFX9000" // for backwards compatibility
+	                        : vdp.getName();
+	MSXMotherBoard& motherBoard = vdp.getMotherBoard();
+	return std::make_unique<V9990SDLRasterizer<Pixel>>(
+		vdp, display, *surface,
+		std::make_unique<HeadlessPostProcessor>(
+			motherBoard, display, *surface,
+			videoSource, 1280, 240, true));
+}
+
+#if COMPONENT_LASERDISC
+std::unique_ptr<LDRasterizer> HeadlessVideoSystem::createLDRasterizer(
+	LaserdiscPlayer& ld)
+{
+	std::string videoSource = "Laserdisc"; // TODO handle multiple???
+	MSXMotherBoard& motherBoard = ld.getMotherBoard();
+	return std::make_unique<LDSDLRasterizer<Pixel>>(
+		*surface,
+		std::make_unique<HeadlessPostProcessor>(
+			motherBoard, display, *surface,
+			videoSource, 640, 480, false));
+}
+#endif
+
+void HeadlessVideoSystem::flush()
+{
+}
+
+void HeadlessVideoSystem::takeScreenShot(
+	const std::string& filename, bool /*withOsd*/)
+{
+	// There is no scaled output and there are no OSD layers, so this is
+	// the same as a raw screenshot of the active video source.
+	auto* videoLayer = dynamic_cast<VideoLayer*>(display.findActiveLayer());
+	if (!videoLayer) {
+		throw MSXException("No active video source.");
+	}
+	videoLayer->takeRawScreenShot(240, filename);
+}
+
+OutputSurface* HeadlessVideoSystem::getOutputSurface()
+{
+	// Nothing is painted.
+	return nullptr;
+}
+
+} // namespace openmsx
@@ -0,0 +1,47 @@
+#ifndef HEADLESSVIDEOSYSTEM_HH
+#define HEADLESSVIDEOSYSTEM_HH
+
+#include "VideoSystem.hh"
+#include "components.hh"
+#include <memory>
+
+namespace openmsx {
+
+class Display;
+class OutputSurface;
+
+/** Video system without any output window, meant for automated tests.
+  * The VDPs are rendered exactly like with the SDL renderer (same
+  * PixelRenderer and rasterizers), but only into in-memory frames. Those
+  * frames are never scaled or painted. They can be grabbed with
+  * 'screenshot', recorded, hashed ('frame_hash' setting) or exported.
+  */
+class HeadlessVideoSystem final : public VideoSystem
+{
+public:
+	explicit HeadlessVideoSystem(Display& display);
+	~HeadlessVideoSystem() override;
+
+	// VideoSystem interface:
+	std::unique_ptr<Rasterizer> createRasterizer(VDP& vdp) override;
+	std::unique_ptr<V9990Rasterizer> createV9990Rasterizer(
+		V9990& vdp) override;
+#if COMPONENT_LASERDISC
+	std::unique_ptr<LDRasterizer> createLDRasterizer(
+		LaserdiscPlayer& ld) override;
+#endif
+	void flush() override;
+	void takeScreenShot(const std::string& filename, bool withOsd) override;
+	OutputSurface* getOutputSurface() override;
+
+private:
+	Display& display;
+
+	/** Only used to define the pixel format of the rendered frames,
+	  * it's never painted on. */
+	std::unique_ptr<OutputSurface> surface;
+};
+
+} // namespace openmsx
+
+#endif
@@ -8,6 +8,8 @@
 
 namespace openmsx {
 
+class ScreenShotWriter;
+
 /** A frame buffer where pixels can be written to.
   * It could be an in-memory buffer or a video buffer visible to the user
   * (see VisibleSurface subclass).
@@ -126,10 +128,11 @@ public:
 	  */
 	virtual void flushFrameBuffer();
 
-	/** Save the content of this OutputSurface to a PNG file.
-	  * @throws MSXException If creating the PNG file fails.
+	/** Save the content of this OutputSurface to an image file.
+	  * @throws MSXException If creating the image file fails.
 	  */
-	virtual void saveScreenshot(const std::string& filename) = 0;
+	virtual void saveScreenshot(ScreenShotWriter& writer,
+	                            const std::string& filename) = 0;
 
 	/** Clear screen (paint it black).
 	 */
@@ -295,7 +295,8 @@ static void flushData(png_structp ctx)
 }
 
 static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
-                           const std::string& filename, bool color)
+                           const std::string& filename, bool color,
+                           int compressionLevel = -1)
 {
 	try {
 		File file(filename, File::TRUNCATE);
@@ -349,6 +350,16 @@ static void IMG_SavePNG_RW(int width, int height, const void** row_pointers,
 					PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
 					PNG_FILTER_TYPE_BASE);
 
+		if (compressionLevel >= 0) {
+			png_set_compression_level(png.ptr, compressionLevel);
+			if (compressionLevel == 0) {
+				// Filtering only helps the deflate step, no point
+				// in spending time on it when not compressing.
+				png_set_filter(png.ptr, PNG_FILTER_TYPE_BASE,
+				               PNG_FILTER_NONE);
+			}
+		}
+
 		// Write the file header information.  REQUIRED
 		png_write_info(png.ptr, png.info);
 
@@ -394,9 +405,11 @@ void save(unsigned width, unsigned height, const void** rowPointers,
 }
 
 void save(unsigned width, unsigned height,
-          const void** rowPointers, const std::string& filename)
+          const void** rowPointers, const std::string& filename,
+          int compressionLevel)
 {
-	IMG_SavePNG_RW(width, height, rowPointers, filename, true);
+	IMG_SavePNG_RW(width, height, rowPointers, filename, true,
+	               compressionLevel);
 }
 
 void saveGrayscale(unsigned width, unsigned height,
@@ -21,8 +21,12 @@ namespace PNG {
 
 	void save(unsigned width, unsigned height, const void** rowPointers,
 	          const SDL_PixelFormat& format, const std::string& filename);
+	/** Save an image given as rows of 24bpp RGB pixels.
+	 * @param compressionLevel zlib compression level (0-9), or -1 to use
+	 *                         the libpng default.
+	 */
 	void save(unsigned width, unsigned height, const void** rowPointers,
-	          const std::string& filename);
+	          const std::string& filename, int compressionLevel = -1);
 	void saveGrayscale(unsigned width, unsigned height,
 	                   const void** rowPointers, const std::string& filename);
 
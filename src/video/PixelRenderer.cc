@@ -19,13 +19,23 @@ TODO:
 #include "RealTime.hh"
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
+#include "TclObject.hh"
 #include "Timer.hh"
 #include "unreachable.hh"
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace openmsx {
 
+// Adaptive frameskip: number of frames over which the host times are measured.
+const unsigned FRAMESKIP_WINDOW = 16;
+// Windows that take longer than this (in real time) are not measured, most
+// likely emulation was paused or blocked (in us).
+const uint64_t MAX_WINDOW_TIME = 1000000;
+// Fraction of the real time per frame we aim to use, leave some headroom.
+const float TARGET_LOAD = 0.9f;
+
 void PixelRenderer::draw(
 	int startX, int startY, int endX, int endY, DrawType drawType, bool atEnd)
 {
@@ -112,6 +122,7 @@ PixelRenderer::PixelRenderer(VDP& vdp_, Display& display)
 	, videoSourceSetting(vdp.getMotherBoard().getVideoSource())
 	, spriteChecker(vdp.getSpriteChecker())
 	, rasterizer(display.getVideoSystem().createRasterizer(vdp))
+	, windowStartEmuTime(EmuTime::zero)
 {
 	// In case of loadstate we can't yet query any state from the VDP
 	// (because that object is not yet fully deserialized). But
@@ -123,6 +134,19 @@ PixelRenderer::PixelRenderer(VDP& vdp_, Display& display)
 	frameSkipCounter = 999; // force drawing of frame
 	prevRenderFrame = false;
 
+	windowStartTime = 0;
+	windowStartSleep = 0;
+	windowDrawTime = 0;
+	windowFrames = 0; // start a new window on next frame
+	windowRendered = 0;
+	renderCost = 0.0f;
+	emuCost = 0.0f;
+	frameBudget = 0.0f;
+	slack = 0;
+	skipLevel = 0;
+	renderedFrames = 0;
+	skippedFrames = 0;
+
 	renderSettings.getMaxFrameSkipSetting().attach(*this);
 	renderSettings.getMinFrameSkipSetting().attach(*this);
 }
@@ -144,6 +168,7 @@ void PixelRenderer::reInit()
 	// This for example can happen after a loadstate or after switching
 	// renderer in the middle of a frame.
 	renderFrame = false;
+	windowFrames = 0;
 
 	rasterizer->reset();
 	displayEnabled = vdp.isDisplayEnabled();
@@ -159,14 +184,27 @@ void PixelRenderer::frameStart(EmuTime::param time)
 {
 	if (!rasterizer->isActive()) {
 		frameSkipCounter = 999;
+		windowFrames = 0;
 		renderFrame = false;
 		prevRenderFrame = false;
+		rasterizer->getPostProcessor()->skipFrame();
 		return;
 	}
+	if (windowFrames == FRAMESKIP_WINDOW) endFrameSkipWindow(time);
+	if (windowFrames == 0) startFrameSkipWindow(time);
+	++windowFrames;
+
 	prevRenderFrame = renderFrame;
 	if (vdp.isInterlaced() && renderSettings.getDeinterlace() &&
 	    vdp.getEvenOdd() && vdp.isEvenOddEnabled()) {
 		// deinterlaced odd frame, do same as even frame
+	} else if (renderSettings.getFrameHash()) {
+		// Every frame must be hashed, independent of the host speed.
+		frameSkipCounter = 0;
+		renderFrame = true;
+	} else if (renderSettings.getFrameSkipMode() ==
+	           RenderSettings::FRAMESKIP_ADAPTIVE) {
+		renderFrame = adaptiveRenderFrame();
 	} else {
 		if (frameSkipCounter < renderSettings.getMinFrameSkip()) {
 			++frameSkipCounter;
@@ -187,9 +225,17 @@ void PixelRenderer::frameStart(EmuTime::param time)
 			}
 		}
 	}
-	if (!renderFrame) return;
+	if (!renderFrame) {
+		++skippedFrames;
+		rasterizer->getPostProcessor()->skipFrame();
+		return;
+	}
+	++renderedFrames;
+	++windowRendered;
 
+	auto time1 = Timer::getTime();
 	rasterizer->frameStart(time);
+	windowDrawTime += Timer::getTime() - time1;
 
 	accuracy = renderSettings.getAccuracy();
 
@@ -212,6 +258,7 @@ void PixelRenderer::frameEnd(EmuTime::param time)
 		rasterizer->frameEnd();
 		auto time2 = Timer::getTime();
 		auto current = time2 - time1;
+		windowDrawTime += current;
 		const float ALPHA = 0.2f;
 		finishFrameDuration = finishFrameDuration * (1 - ALPHA) +
 		                      current * ALPHA;
@@ -234,6 +281,97 @@ void PixelRenderer::frameEnd(EmuTime::param time)
 	}
 }
 
+bool PixelRenderer::adaptiveRenderFrame()
+{
+	// When recording, render as many frames as allowed. The skip level is
+	// clamped again because min/maxframeskip may have changed since it
+	// was calculated.
+	int minSkip = renderSettings.getMinFrameSkip();
+	int maxSkip = renderSettings.getMaxFrameSkip();
+	int level = rasterizer->isRecording() ? minSkip
+	          : std::min(std::max(skipLevel, minSkip), maxSkip);
+	if (frameSkipCounter >= level) {
+		frameSkipCounter = 0;
+		return true;
+	} else {
+		++frameSkipCounter;
+		return false;
+	}
+}
+
+void PixelRenderer::startFrameSkipWindow(EmuTime::param time)
+{
+	windowStartEmuTime = time;
+	windowStartTime = Timer::getTime();
+	windowStartSleep = realTime.getSleepTime();
+	windowDrawTime = 0;
+	windowRendered = 0;
+}
+
+void PixelRenderer::endFrameSkipWindow(EmuTime::param time)
+{
+	windowFrames = 0; // start a new window
+
+	auto elapsed = Timer::getTime() - windowStartTime;
+	auto slept = std::min(realTime.getSleepTime() - windowStartSleep, elapsed);
+	frameBudget = float(realTime.getRealDuration(windowStartEmuTime, time) *
+	                    1000000.0 / double(FRAMESKIP_WINDOW));
+	slack = realTime.getSlack(time);
+	if (elapsed < MAX_WINDOW_TIME) {
+		// Busy host time is split in time spent drawing (only for
+		// rendered frames) and the rest (emulation, sound, painting
+		// the previous frame, ...), which is needed for every frame.
+		if (windowRendered) {
+			float current = float(windowDrawTime) / windowRendered;
+			const float ALPHA = 0.5f;
+			renderCost = (renderCost == 0.0f) ? current
+			           : renderCost * (1 - ALPHA) + current * ALPHA;
+		}
+		emuCost = std::max(0.0f,
+			(float(elapsed - slept) - float(windowDrawTime)) / float(FRAMESKIP_WINDOW));
+	}
+
+	if (renderSettings.getFrameSkipMode() !=
+	    RenderSettings::FRAMESKIP_ADAPTIVE) {
+		return;
+	}
+	// Find the smallest skip level N for which rendering one out of N+1
+	// frames still fits in the budget:
+	//    emuCost + renderCost / (N + 1) <= TARGET_LOAD * frameBudget
+	int minSkip = renderSettings.getMinFrameSkip();
+	int maxSkip = renderSettings.getMaxFrameSkip();
+	float avail = TARGET_LOAD * frameBudget - emuCost;
+	int wanted = (avail <= 0.0f) ? maxSkip
+	           : int(std::min(std::ceil(renderCost / avail), 1000.0f)) - 1;
+	if (slack < 0) {
+		// Lagging behind real time (or throttle is off), whatever the
+		// measurements say, skip more frames.
+		wanted = std::max(wanted, skipLevel + 1);
+	} else if (wanted < skipLevel) {
+		// Only lower the skip level one step at a time, and only when
+		// there's some slack left, to avoid oscillation.
+		wanted = (slack > int64_t(frameBudget / 2)) ? skipLevel - 1
+		                                           : skipLevel;
+	}
+	skipLevel = std::min(std::max(wanted, minSkip), maxSkip);
+}
+
+void PixelRenderer::getFrameSkipStats(TclObject& result) const
+{
+	bool adaptive = renderSettings.getFrameSkipMode() ==
+	                RenderSettings::FRAMESKIP_ADAPTIVE;
+	result.addDictKeyValues("mode", adaptive ? "adaptive" : "fixed",
+	                        "rendered", renderedFrames,
+	                        "skipped", skippedFrames,
+	                        "render_time", renderCost,
+	                        "emu_time", emuCost,
+	                        "frame_budget", frameBudget,
+	                        "slack", int(slack));
+	if (adaptive) {
+		result.addDictKeyValue("skip_level", skipLevel);
+	}
+}
+
 void PixelRenderer::updateHorizontalScrollLow(
 	byte scroll, EmuTime::param time)
 {
@@ -563,6 +701,7 @@ void PixelRenderer::renderUntil(EmuTime::param time)
 	// Also it is a small performance optimisation.
 	if (limitX == nextX && limitY == nextY) return;
 
+	auto startTime = Timer::getTime();
 	if (displayEnabled) {
 		if (vdp.spritesEnabled()) {
 			// Update sprite checking, so that rasterizer can call getSprites.
@@ -595,6 +734,7 @@ void PixelRenderer::renderUntil(EmuTime::param time)
 		subdivide(nextX, nextY, limitX, limitY,
 			0, VDP::TICKS_PER_LINE, DRAW_BORDER);
 	}
+	windowDrawTime += Timer::getTime() - startTime;
 
 	nextX = limitX;
 	nextY = limitY;
@@ -4,7 +4,9 @@
 #include "Renderer.hh"
 #include "Observer.hh"
 #include "RenderSettings.hh"
+#include "EmuTime.hh"
 #include "openmsx.hh"
+#include <cstdint>
 #include <memory>
 
 namespace openmsx {
@@ -34,6 +36,7 @@ public:
 	void reInit() override;
 	void frameStart(EmuTime::param time) override;
 	void frameEnd(EmuTime::param time) override;
+	void getFrameSkipStats(TclObject& result) const override;
 	void updateHorizontalScrollLow(byte scroll, EmuTime::param time) override;
 	void updateHorizontalScrollHigh(byte scroll, EmuTime::param time) override;
 	void updateBorderMask(bool masked, EmuTime::param time) override;
@@ -82,6 +85,18 @@ private:
 		int startX, int startY, int endX, int endY,
 		int clipL, int clipR, DrawType drawType );
 
+	/** Frameskip decision for the 'adaptive' frameskip mode: render one
+	  * frame, then skip 'skipLevel' frames.
+	  */
+	bool adaptiveRenderFrame();
+
+	/** Called at the end of a measurement window (a fixed number of
+	  * frames). Updates the measured host times and, in adaptive
+	  * frameskip mode, picks a new skip level.
+	  */
+	void endFrameSkipWindow(EmuTime::param time);
+	void startFrameSkipWindow(EmuTime::param time);
+
 	inline bool checkSync(int offset, EmuTime::param time);
 
 	/** Update renderer state to specified moment in time.
@@ -121,6 +136,26 @@ private:
 	float finishFrameDuration;
 	int frameSkipCounter;
 
+	/** Frameskip measurement window, see endFrameSkipWindow().
+	  */
+	EmuTime windowStartEmuTime;
+	uint64_t windowStartTime;  // host time (us) at start of the window
+	uint64_t windowStartSleep; // RealTime::getSleepTime() at that moment
+	uint64_t windowDrawTime;   // host time (us) spent drawing in the window
+	unsigned windowFrames;     // number of frames started in the window
+	unsigned windowRendered;   // of which this many were rendered
+
+	/** Measurements and state of the adaptive frameskip controller.
+	  */
+	float renderCost;  // host time (us) spent drawing one frame
+	float emuCost;     // other busy host time (us) per emulated frame
+	float frameBudget; // real time (us) available per emulated frame
+	int64_t slack;     // see RealTime::getSlack()
+	int skipLevel;     // number of frames to skip after a rendered frame
+
+	unsigned renderedFrames;
+	unsigned skippedFrames;
+
 	/** Number of the next position within a line to render.
 	  * Expressed in VDP clock ticks since start of line.
 	  */
@@ -5,10 +5,10 @@
 #include "DoubledFrame.hh"
 #include "Deflicker.hh"
 #include "SuperImposedFrame.hh"
-#include "PNG.hh"
 #include "RenderSettings.hh"
 #include "RawFrame.hh"
 #include "AviRecorder.hh"
+#include "SharedMemoryExport.hh"
 #include "CliComm.hh"
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
@@ -16,8 +16,10 @@
 #include "FinishFrameEvent.hh"
 #include "CommandException.hh"
 #include "MemBuffer.hh"
+#include "strCat.hh"
 #include "vla.hh"
 #include "likely.hh"
+#include "xxhash.hh"
 #include "build-info.hh"
 #include <algorithm>
 #include <cassert>
@@ -35,6 +37,7 @@ PostProcessor::PostProcessor(MSXMotherBoard& motherBoard_,
 	, screen(screen_)
 	, paintFrame(nullptr)
 	, recorder(nullptr)
+	, shmExport(nullptr)
 	, superImposeVideoFrame(nullptr)
 	, superImposeVdpFrame(nullptr)
 	, interleaveCount(0)
@@ -45,6 +48,11 @@ PostProcessor::PostProcessor(MSXMotherBoard& motherBoard_,
 	, canDoInterlace(canDoInterlace_)
 	, lastRotate(motherBoard_.getCurrentTime())
 	, eventDistributor(motherBoard_.getReactor().getEventDistributor())
+	, msxCliComm(motherBoard_.getMSXCliComm())
+	, videoSourceName(videoSource)
+	, frameCounter(0)
+	, frameHash(0)
+	, frameHashValid(false)
 {
 	if (canDoInterlace) {
 		deinterlacedFrame = std::make_unique<DeinterlacedFrame>(
@@ -73,6 +81,13 @@ PostProcessor::~PostProcessor()
 			"during recording.");
 		recorder->stop();
 	}
+	if (shmExport) {
+		getCliComm().printWarning(
+			"Shared memory export stopped, because you "
+			"changed machine or changed a video setting "
+			"during export.");
+		shmExport->stop();
+	}
 }
 
 CliComm& PostProcessor::getCliComm()
@@ -90,6 +105,29 @@ unsigned PostProcessor::getLineWidth(
 	return result;
 }
 
+// Hash the pixels of each line (only the pixels that are actually in use) and
+// then hash the sequence of (line-width, line-hash) pairs.
+static uint32_t calcFrameHash(RawFrame& frame, unsigned bytesPerPixel)
+{
+	unsigned height = frame.getHeight();
+	VLA(uint32_t, lineHashes, 2 * height);
+	for (unsigned y = 0; y < height; ++y) {
+		unsigned width = frame.getLineWidthDirect(y);
+		auto* pixels = frame.getLinePtrDirect<char>(y);
+		lineHashes[2 * y + 0] = width;
+		lineHashes[2 * y + 1] = xxhash(string_view(
+			pixels, width * bytesPerPixel));
+	}
+	return xxhash(string_view(reinterpret_cast<const char*>(lineHashes),
+	                          2 * height * sizeof(uint32_t)));
+}
+
+std::string PostProcessor::getFrameHash() const
+{
+	if (!frameHashValid) return {};
+	return strCat(frameCounter, ' ', hex_string<8>(frameHash));
+}
+
 std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 	std::unique_ptr<RawFrame> finishedFrame, EmuTime::param time)
 {
@@ -134,6 +172,14 @@ std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 	                   lastFrames + recycleIdx + 1);
 	lastFrames[0] = std::move(finishedFrame);
 
+	++frameCounter;
+	frameHashValid = renderSettings.getFrameHash();
+	if (frameHashValid) {
+		frameHash = calcFrameHash(*lastFrames[0], getBpp() == 32 ? 4 : 2);
+		msxCliComm.update(CliComm::FRAMEHASH, videoSourceName,
+		                  getFrameHash());
+	}
+
 	// Are enough frames available?
 	if (lastFramesCount >= numRequired) {
 		// Only the last 'numRequired' are kept up to date.
@@ -191,6 +237,11 @@ std::unique_ptr<RawFrame> PostProcessor::rotateFrames(
 		}
 	}
 
+	// Possibly export this frame
+	if (shmExport && needRecord()) {
+		shmExport->addImage(*lastFrames[0], time);
+	}
+
 	// Return recycled frame to the caller
 	if (canDoInterlace) {
 		if (unlikely(!recycleFrame)) {
@@ -265,7 +316,8 @@ void PostProcessor::takeRawScreenShot(unsigned height2, const std::string& filen
 	WorkBuffer workBuffer;
 	getScaledFrame(*paintFrame, getBpp(), height2, lines, workBuffer);
 	unsigned width = (height2 == 240) ? 320 : 640;
-	PNG::save(width, height2, lines, paintFrame->getSDLPixelFormat(), filename);
+	display.getScreenShotWriter().save(
+		width, height2, lines, paintFrame->getSDLPixelFormat(), filename);
 }
 
 unsigned PostProcessor::getBpp() const
@@ -273,4 +325,9 @@ unsigned PostProcessor::getBpp() const
 	return screen.getSDLFormat().BitsPerPixel;
 }
 
+const SDL_PixelFormat& PostProcessor::getSDLFormat() const
+{
+	return screen.getSDLFormat();
+}
+
 } // namespace openmsx
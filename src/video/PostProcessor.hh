@@ -4,7 +4,11 @@
 #include "VideoLayer.hh"
 #include "Schedulable.hh"
 #include "EmuTime.hh"
+#include <cstdint>
 #include <memory>
+#include <string>
+
+struct SDL_PixelFormat;
 
 namespace openmsx {
 
@@ -18,6 +22,7 @@ class EventDistributor;
 class FrameSource;
 class RawFrame;
 class RenderSettings;
+class SharedMemoryExport;
 class SuperImposedFrame;
 
 /** Abstract base class for post processors.
@@ -75,17 +80,43 @@ public:
 	  */
 	bool isRecording() const { return recorder != nullptr; }
 
+	/** Start/stop exporting frames to shared memory.
+	  * @param shmExport_ Finished frames should be pushed to this
+	  *                   SharedMemoryExport. Can also be nullptr, meaning
+	  *                   exporting is stopped.
+	  */
+	void setSharedMemoryExport(SharedMemoryExport* shmExport_) {
+		shmExport = shmExport_;
+	}
+
 	/** Get the number of bits per pixel for the pixels in these frames.
 	  * @return Possible values are 15, 16 or 32
 	  */
 	unsigned getBpp() const;
 
+	/** Get the pixel format of the pixels in these frames. */
+	const SDL_PixelFormat& getSDLFormat() const;
+
 	/** Get the frame that would be displayed. E.g. so that it can be
 	  * superimposed over the output of another PostProcessor, see
 	  * setSuperimposeVdpFrame().
 	  */
 	FrameSource* getPaintFrame() const { return paintFrame; }
 
+	/** Get the hash of the most recently finished frame, formatted as
+	  * "<frame-number> <hash>". The frame number counts all frames of
+	  * this video source (also the skipped ones, see skipFrame()), so it
+	  * doesn't depend on the host speed. Returns an empty string when
+	  * the 'frame_hash' setting was disabled for that frame.
+	  */
+	std::string getFrameHash() const;
+
+	/** Called by the renderer for each frame that it doesn't render (so
+	  * for which rotateFrames() isn't called), to keep the frame number
+	  * in sync with the emulated frames.
+	  */
+	void skipFrame() { ++frameCounter; }
+
 	// VideoLayer
 	void takeRawScreenShot(unsigned height, const std::string& filename) override;
 
@@ -132,6 +163,9 @@ protected:
 	/** Video recorder, nullptr when not recording. */
 	AviRecorder* recorder;
 
+	/** Shared memory exporter, nullptr when not exporting. */
+	SharedMemoryExport* shmExport;
+
 	/** Video frame on which to superimpose the (VDP) output.
 	  * nullptr when not superimposing. */
 	const RawFrame* superImposeVideoFrame;
@@ -156,6 +190,16 @@ private:
 
 	EmuTime lastRotate;
 	EventDistributor& eventDistributor;
+
+	/** For the 'framehash' CliComm updates. */
+	CliComm& msxCliComm;
+	const std::string videoSourceName;
+
+	/** Number of frames of this video source (rendered or skipped). */
+	unsigned frameCounter;
+	/** Hash of the last finished frame, only valid if 'frameHashValid'. */
+	uint32_t frameHash;
+	bool frameHashValid;
 };
 
 } // namespace openmsx
@@ -0,0 +1,120 @@
+#include "QOI.hh"
+#include "File.hh"
+#include "MSXException.hh"
+
+namespace openmsx {
+namespace QOI {
+
+static const uint8_t OP_INDEX = 0x00; // 00xxxxxx
+static const uint8_t OP_DIFF  = 0x40; // 01xxxxxx
+static const uint8_t OP_LUMA  = 0x80; // 10xxxxxx
+static const uint8_t OP_RUN   = 0xc0; // 11xxxxxx
+static const uint8_t OP_RGB   = 0xfe; // 11111110
+
+static const unsigned MAX_RUN = 62;
+
+// We only write opaque pixels, but the alpha channel still matters: the
+// index starts zero-filled, so also with alpha 0.
+struct Rgba { uint8_t r, g, b, a; };
+
+static inline bool operator==(Rgba x, Rgba y)
+{
+	return (x.r == y.r) && (x.g == y.g) && (x.b == y.b) && (x.a == y.a);
+}
+
+static inline unsigned hash(Rgba p)
+{
+	return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t v)
+{
+	out.push_back(v >> 24);
+	out.push_back(v >> 16);
+	out.push_back(v >>  8);
+	out.push_back(v >>  0);
+}
+
+std::vector<uint8_t> encode(unsigned width, unsigned height,
+                            const void** rowPointers)
+{
+	std::vector<uint8_t> out;
+	// worst case is 4 bytes per pixel, typical is much less
+	out.reserve(14 + width * height + 8);
+
+	// header
+	out.insert(out.end(), {'q', 'o', 'i', 'f'});
+	put32(out, width);
+	put32(out, height);
+	out.push_back(3); // channels: RGB
+	out.push_back(0); // colorspace: sRGB with linear alpha
+
+	Rgba index[64] = {}; // all (0, 0, 0, 0)
+	Rgba prev = {0, 0, 0, 255};
+	unsigned run = 0;
+	for (unsigned y = 0; y < height; ++y) {
+		auto* line = static_cast<const uint8_t*>(rowPointers[y]);
+		for (unsigned x = 0; x < width; ++x) {
+			Rgba px = {line[3 * x + 0], line[3 * x + 1], line[3 * x + 2], 255};
+			if (px == prev) {
+				if (++run == MAX_RUN) {
+					out.push_back(OP_RUN | (run - 1));
+					run = 0;
+				}
+				continue;
+			}
+			if (run) {
+				out.push_back(OP_RUN | (run - 1));
+				run = 0;
+			}
+
+			unsigned h = hash(px);
+			if (index[h] == px) {
+				out.push_back(OP_INDEX | h);
+			} else {
+				index[h] = px;
+				int vr = int8_t(px.r - prev.r);
+				int vg = int8_t(px.g - prev.g);
+				int vb = int8_t(px.b - prev.b);
+				int vgr = vr - vg;
+				int vgb = vb - vg;
+				if ((-2 <= vr) && (vr <= 1) &&
+				    (-2 <= vg) && (vg <= 1) &&
+				    (-2 <= vb) && (vb <= 1)) {
+					out.push_back(OP_DIFF | ((vr + 2) << 4) |
+					              ((vg + 2) << 2) | (vb + 2));
+				} else if ((-32 <= vg ) && (vg  <= 31) &&
+				           ( -8 <= vgr) && (vgr <=  7) &&
+				           ( -8 <= vgb) && (vgb <=  7)) {
+					out.push_back(OP_LUMA | (vg + 32));
+					out.push_back(((vgr + 8) << 4) | (vgb + 8));
+				} else {
+					out.insert(out.end(), {OP_RGB, px.r, px.g, px.b});
+				}
+			}
+			prev = px;
+		}
+	}
+	if (run) out.push_back(OP_RUN | (run - 1));
+
+	// end marker
+	out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+	return out;
+}
+
+void save(unsigned width, unsigned height, const void** rowPointers,
+          const std::string& filename)
+{
+	auto data = encode(width, height, rowPointers);
+	try {
+		File file(filename, File::TRUNCATE);
+		file.write(data.data(), data.size());
+	} catch (MSXException& e) {
+		throw MSXException(
+			"Error while writing QOI file \"", filename, "\": ",
+			e.getMessage());
+	}
+}
+
+} // namespace QOI
+} // namespace openmsx
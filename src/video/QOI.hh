@@ -0,0 +1,29 @@
+#ifndef QOI_HH
+#define QOI_HH
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace openmsx {
+
+/** Utility functions to save images in the "Quite OK Image" format.
+  * QOI is a lossless format that compresses about as well as PNG with a
+  * fast deflate setting, but encodes an order of magnitude faster. That
+  * makes it well suited for capturing many screenshots in a row.
+  * See https://qoiformat.org/ for the specification.
+  */
+namespace QOI {
+	/** Encode an image given as rows of 24bpp RGB pixels.
+	  * @return The complete content of the QOI file.
+	  */
+	std::vector<uint8_t> encode(unsigned width, unsigned height,
+	                            const void** rowPointers);
+
+	void save(unsigned width, unsigned height, const void** rowPointers,
+	          const std::string& filename);
+
+} // namespace QOI
+} // namespace openmsx
+
+#endif // QOI_HH
@@ -1,9 +1,58 @@
 #include "RawFrame.hh"
 #include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
 #include <SDL.h>
 
 namespace openmsx {
 
+// RawFrames are typically (re)created in batches with identical dimensions:
+// each time a renderer, rasterizer or post processor is (re)created, for
+// example when switching renderer, scaler or video source. Instead of
+// freeing the (big) pixel buffers and allocating them again a moment later,
+// keep a few released buffers around for reuse.
+class FrameBufferPool
+{
+public:
+	MemBuffer<char, 64> acquire(size_t size)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto it = begin(buffers); it != end(buffers); ++it) {
+			if (it->first == size) {
+				auto result = std::move(it->second);
+				buffers.erase(it);
+				return result;
+			}
+		}
+		return MemBuffer<char, 64>(size);
+	}
+
+	void release(size_t size, MemBuffer<char, 64> buffer)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (buffers.size() == MAX_BUFFERS) {
+			// drop the oldest one
+			buffers.erase(begin(buffers));
+		}
+		buffers.emplace_back(size, std::move(buffer));
+	}
+
+private:
+	// Enough for a post processor (4 past frames) plus its rasterizer
+	// (1 work frame), and then some.
+	static const size_t MAX_BUFFERS = 8;
+
+	std::mutex mutex;
+	std::vector<std::pair<size_t, MemBuffer<char, 64>>> buffers;
+};
+
+static FrameBufferPool& getFrameBufferPool()
+{
+	static FrameBufferPool pool;
+	return pool;
+}
+
 RawFrame::RawFrame(
 		const SDL_PixelFormat& format, unsigned maxWidth_, unsigned height_)
 	: FrameSource(format)
@@ -17,7 +66,7 @@ RawFrame::RawFrame(
 	// - SSE instructions need 16 byte aligned data
 	// - cache line size on many CPUs is 64 bytes
 	pitch = ((bytesPerPixel * maxWidth) + 63) & ~63;
-	data.resize(pitch * height_);
+	data = getFrameBufferPool().acquire(pitch * height_);
 
 	maxWidth = pitch / bytesPerPixel; // adjust maxWidth
 
@@ -32,6 +81,11 @@ RawFrame::RawFrame(
 	}
 }
 
+RawFrame::~RawFrame()
+{
+	getFrameBufferPool().release(pitch * getHeight(), std::move(data));
+}
+
 unsigned RawFrame::getLineWidth(unsigned line) const
 {
 	assert(line < getHeight());
@@ -26,6 +26,7 @@ class RawFrame final : public FrameSource
 {
 public:
 	RawFrame(const SDL_PixelFormat& format, unsigned maxWidth, unsigned height);
+	~RawFrame();
 
 	template<typename Pixel>
 	Pixel* getLinePtrDirect(unsigned y) {
@@ -38,6 +38,7 @@ EnumSetting<RenderSettings::RendererID>::Map RenderSettings::getRendererMap()
 {
 	EnumSetting<RendererID>::Map rendererMap = {
 		{ "none", DUMMY },// TODO: only register when in CliComm mode
+		{ "headless", HEADLESS },
 		{ "SDL", SDL } };
 #if COMPONENT_GL
 	// compiled with OpenGL-2.0, still need to test whether
@@ -69,12 +70,27 @@ RenderSettings::RenderSettings(CommandController& commandController)
 	, deflickerSetting(commandController,
 		"deflicker", "deflicker on/off", false)
 
+	, frameHashSetting(commandController,
+		"frame_hash", "calculate a hash of each frame (this disables "
+		"frame skipping), see 'openmsx_info frame_hash'. The hash is "
+		"calculated on the host pixels, so it also depends on the pixel "
+		"format (16/32bpp) and on the gamma and color settings", false)
+
 	, maxFrameSkipSetting(commandController,
 		"maxframeskip", "set the max amount of frameskip", 3, 0, 100)
 
 	, minFrameSkipSetting(commandController,
 		"minframeskip", "set the min amount of frameskip", 0, 0, 100)
 
+	, frameSkipModeSetting(commandController,
+		"frameskip_mode", "how to decide which frames to skip: "
+		"'fixed' renders whenever there's time left for it, 'adaptive' "
+		"picks a skip rate based on the measured host load",
+		FRAMESKIP_FIXED,
+		EnumSetting<FrameSkipMode>::Map{
+			{"fixed",    FRAMESKIP_FIXED},
+			{"adaptive", FRAMESKIP_ADAPTIVE}})
+
 	, fullScreenSetting(commandController,
 		"fullscreen", "full screen display on/off", false)
 
@@ -185,6 +201,12 @@ RenderSettings::RenderSettings(CommandController& commandController)
 		"Useful on (100Hz+) lightboost enabled monitors to reduce "
 		"motion blur and double frame artifacts.",
 		false)
+
+	, renderThreadSetting(commandController,
+		"render_thread",
+		"Use a separate thread to help converting VRAM to pixels. "
+		"Speeds up emulation on hosts with multiple CPU cores.",
+		false)
 {
 	brightnessSetting.attach(*this);
 	contrastSetting  .attach(*this);
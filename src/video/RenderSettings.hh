@@ -24,7 +24,7 @@ public:
 	/** Enumeration of Renderers known to openMSX.
 	  * This is the full list, the list of available renderers may be smaller.
 	  */
-	enum RendererID { UNINITIALIZED, DUMMY, SDL,
+	enum RendererID { UNINITIALIZED, DUMMY, HEADLESS, SDL,
 	                  SDLGL_PP, SDLGL_FB16, SDLGL_FB32 };
 	using RendererSetting = EnumSetting<RendererID>;
 
@@ -32,6 +32,10 @@ public:
 	  */
 	enum Accuracy { ACC_SCREEN, ACC_LINE, ACC_PIXEL };
 
+	/** Frameskip strategy.
+	  */
+	enum FrameSkipMode { FRAMESKIP_FIXED, FRAMESKIP_ADAPTIVE };
+
 	/** Scaler algorithm
 	  */
 	enum ScaleAlgorithm {
@@ -56,6 +60,9 @@ public:
 	/** Deflicker [on, off]. */
 	bool getDeflicker() const { return deflickerSetting.getBoolean(); }
 
+	/** Calculate a hash of each rendered frame [on, off]. */
+	bool getFrameHash() const { return frameHashSetting.getBoolean(); }
+
 	/** The current max frameskip. */
 	IntegerSetting& getMaxFrameSkipSetting() { return maxFrameSkipSetting; }
 	int getMaxFrameSkip() const { return maxFrameSkipSetting.getInt(); }
@@ -64,6 +71,10 @@ public:
 	IntegerSetting& getMinFrameSkipSetting() { return minFrameSkipSetting; }
 	int getMinFrameSkip() const { return minFrameSkipSetting.getInt(); }
 
+	/** Frameskip strategy [fixed, adaptive]. */
+	EnumSetting<FrameSkipMode>& getFrameSkipModeSetting() { return frameSkipModeSetting; }
+	FrameSkipMode getFrameSkipMode() const { return frameSkipModeSetting.getEnum(); }
+
 	/** Full screen [on, off]. */
 	BooleanSetting& getFullScreenSetting() { return fullScreenSetting; }
 	bool getFullScreen() const { return fullScreenSetting.getBoolean(); }
@@ -169,6 +180,10 @@ public:
 		return interleaveBlackFrameSetting.getBoolean();
 	}
 
+	/** Use a separate thread to help rasterizing the VDP output? */
+	BooleanSetting& getRenderThreadSetting() { return renderThreadSetting; }
+	bool getRenderThread() const { return renderThreadSetting.getBoolean(); }
+
 	/** Apply brightness, contrast and gamma transformation on the input
 	  * color component. The component is expected to be in the range
 	  * [0.0 .. 1.0] but it's not an error if it lays outside of this range.
@@ -203,8 +218,10 @@ private:
 	EnumSetting<Accuracy> accuracySetting;
 	BooleanSetting deinterlaceSetting;
 	BooleanSetting deflickerSetting;
+	BooleanSetting frameHashSetting;
 	IntegerSetting maxFrameSkipSetting;
 	IntegerSetting minFrameSkipSetting;
+	EnumSetting<FrameSkipMode> frameSkipModeSetting;
 	BooleanSetting fullScreenSetting;
 	FloatSetting gammaSetting;
 	FloatSetting brightnessSetting;
@@ -225,6 +242,7 @@ private:
 	FloatSetting horizontalStretchSetting;
 	FloatSetting pointerHideDelaySetting;
 	BooleanSetting interleaveBlackFrameSetting;
+	BooleanSetting renderThreadSetting;
 
 	float brightness;
 	float contrast;
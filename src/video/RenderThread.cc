@@ -0,0 +1,57 @@
+#include "RenderThread.hh"
+#include <cassert>
+
+namespace openmsx {
+
+RenderThread::RenderThread()
+	: busy(false), exitLoop(false)
+{
+	thread = std::thread([this]() { run(); });
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		assert(!busy);
+		exitLoop = true;
+	}
+	condition.notify_all();
+	thread.join();
+}
+
+void RenderThread::start(std::function<void()> job_)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		assert(!busy);
+		job = std::move(job_);
+		busy = true;
+	}
+	condition.notify_all();
+}
+
+void RenderThread::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [this]() { return !busy; });
+}
+
+void RenderThread::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		condition.wait(lock, [this]() { return busy || exitLoop; });
+		if (exitLoop) break;
+
+		lock.unlock();
+		job();
+		lock.lock();
+
+		job = nullptr;
+		busy = false;
+		condition.notify_all();
+	}
+}
+
+} // namespace openmsx
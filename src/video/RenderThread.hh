@@ -0,0 +1,76 @@
+#ifndef RENDERTHREAD_HH
+#define RENDERTHREAD_HH
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace openmsx {
+
+/** Helper thread that lets a rasterizer produce part of the pixels of a
+  * draw request while the emulation thread produces the rest.
+  *
+  * The rasterizers read VDP registers and VRAM directly while drawing, so
+  * all rendering must be finished before the emulation thread continues
+  * (the next VDP or VRAM change may follow immediately). That's why this
+  * is a fork/join helper: start() hands a job to the render thread,
+  * wait() blocks until that job is done.
+  */
+class RenderThread final
+{
+public:
+	RenderThread();
+	~RenderThread();
+
+	/** Start executing the given job on the render thread. Returns
+	  * immediately. A started job must be finished (see wait()) before
+	  * a new job can be started.
+	  */
+	void start(std::function<void()> job);
+
+	/** Block until the job passed to start() has finished.
+	  */
+	void wait();
+
+	/** Render the lines in the range [begin, end): the lower half of the
+	  * range is rendered by the render thread, the upper half by the
+	  * calling thread. Small ranges are completely rendered by the
+	  * calling thread.
+	  * @param begin First line to render (inclusive).
+	  * @param end Last line to render (exclusive).
+	  * @param render Functor taking a (begin, end) sub-range of lines.
+	  *               It must be safe to call this functor concurrently
+	  *               for disjoint ranges.
+	  */
+	template<typename F> void split(int begin, int end, F render)
+	{
+		if ((end - begin) < MIN_SPLIT_LINES) {
+			render(begin, end);
+			return;
+		}
+		int middle = begin + (end - begin) / 2;
+		start([&]() { render(middle, end); });
+		render(begin, middle);
+		wait();
+	}
+
+private:
+	/** Below this many lines, the synchronization overhead outweighs the
+	  * gain of rendering in parallel.
+	  */
+	static const int MIN_SPLIT_LINES = 32;
+
+	void run();
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::function<void()> job;
+	bool busy;
+	bool exitLoop;
+};
+
+} // namespace openmsx
+
+#endif
@@ -10,6 +10,7 @@ namespace openmsx {
 class PostProcessor;
 class DisplayMode;
 class RawFrame;
+class TclObject;
 
 /** Abstract base class for Renderers.
   * A Renderer is a class that converts VDP state to visual
@@ -44,6 +45,11 @@ public:
 	  */
 	virtual void frameEnd(EmuTime::param time) = 0;
 
+	/** Frameskip statistics, for debugging and tuning.
+	  * @param result Tcl dict that is filled in with the statistics.
+	  */
+	virtual void getFrameSkipStats(TclObject& result) const = 0;
+
 	/** Informs the renderer of a VDP transparency enable/disable change.
 	  * @param enabled The new transparency state.
 	  * @param time The moment in emulated time this change occurs.
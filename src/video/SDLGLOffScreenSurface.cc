@@ -40,9 +40,10 @@ void SDLGLOffScreenSurface::clearScreen()
 	SDLGLOutputSurface::clearScreen();
 }
 
-void SDLGLOffScreenSurface::saveScreenshot(const std::string& filename)
+void SDLGLOffScreenSurface::saveScreenshot(
+	ScreenShotWriter& writer, const std::string& filename)
 {
-	SDLGLOutputSurface::saveScreenshot(filename, *this);
+	SDLGLOutputSurface::saveScreenshot(writer, filename, *this);
 }
 
 } // namespace openmsx
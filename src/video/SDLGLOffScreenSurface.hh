@@ -19,7 +19,8 @@ public:
 
 private:
 	// OutputSurface
-	void saveScreenshot(const std::string& filename) override;
+	void saveScreenshot(ScreenShotWriter& writer,
+	                    const std::string& filename) override;
 	void flushFrameBuffer() override;
 	void clearScreen() override;
 
@@ -1,7 +1,7 @@
 #include "SDLGLOutputSurface.hh"
 #include "GLContext.hh"
 #include "OutputSurface.hh"
-#include "PNG.hh"
+#include "ScreenShotWriter.hh"
 #include "build-info.hh"
 #include "Math.hh"
 #include "MemBuffer.hh"
@@ -104,7 +104,8 @@ void SDLGLOutputSurface::clearScreen()
 }
 
 void SDLGLOutputSurface::saveScreenshot(
-	const std::string& filename, const OutputSurface& output) const
+	ScreenShotWriter& writer, const std::string& filename,
+	const OutputSurface& output) const
 {
 	gl::ivec2 offset = output.getViewOffset();
 	gl::ivec2 size   = output.getViewSize();
@@ -115,7 +116,7 @@ void SDLGLOutputSurface::saveScreenshot(
 		rowPointers[size[1] - 1 - i] = &buffer[size[0] * 3 * i];
 	}
 	glReadPixels(offset[0], offset[1], size[0], size[1], GL_RGB, GL_UNSIGNED_BYTE, buffer.data());
-	PNG::save(size[0], size[1], rowPointers, filename);
+	writer.save(size[0], size[1], rowPointers, filename);
 }
 
 } // namespace openmsx
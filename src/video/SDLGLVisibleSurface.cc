@@ -96,9 +96,10 @@ void SDLGLVisibleSurface::clearScreen()
 	SDLGLOutputSurface::clearScreen();
 }
 
-void SDLGLVisibleSurface::saveScreenshot(const std::string& filename)
+void SDLGLVisibleSurface::saveScreenshot(
+	ScreenShotWriter& writer, const std::string& filename)
 {
-	SDLGLOutputSurface::saveScreenshot(filename, *this);
+	SDLGLOutputSurface::saveScreenshot(writer, filename, *this);
 }
 
 void SDLGLVisibleSurface::finish()
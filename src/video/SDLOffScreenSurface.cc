@@ -34,9 +34,10 @@ SDLOffScreenSurface::SDLOffScreenSurface(const SDL_Surface& proto)
 	setSDLRenderer(renderer.get());
 }
 
-void SDLOffScreenSurface::saveScreenshot(const std::string& filename)
+void SDLOffScreenSurface::saveScreenshot(
+	ScreenShotWriter& writer, const std::string& filename)
 {
-	SDLVisibleSurface::saveScreenshotSDL(*this, filename);
+	SDLVisibleSurface::saveScreenshotSDL(*this, writer, filename);
 }
 
 void SDLOffScreenSurface::clearScreen()
@@ -14,7 +14,8 @@ public:
 
 private:
 	// OutputSurface
-	void saveScreenshot(const std::string& filename) override;
+	void saveScreenshot(ScreenShotWriter& writer,
+	                    const std::string& filename) override;
 	void clearScreen() override;
 
 	MemBuffer<char, SSE2_ALIGNMENT> buffer;
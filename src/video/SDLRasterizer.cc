@@ -6,8 +6,9 @@
 #include "Renderer.hh"
 #include "RenderSettings.hh"
 #include "PostProcessor.hh"
+#include "RenderThread.hh"
 #include "MemoryOps.hh"
-#include "VisibleSurface.hh"
+#include "OutputSurface.hh"
 #include "build-info.hh"
 #include "components.hh"
 #include <algorithm>
@@ -67,9 +68,32 @@ inline void SDLRasterizer<Pixel>::renderBitmapLine(Pixel* buf, unsigned vramLine
 	}
 }
 
+template <class Pixel>
+template <typename F>
+void SDLRasterizer<Pixel>::renderLines(int fromY, int limitY, F render)
+{
+	if (renderThread) {
+		renderThread->split(fromY, limitY, render);
+	} else {
+		render(fromY, limitY);
+	}
+}
+
+template <class Pixel>
+void SDLRasterizer<Pixel>::updateRenderThread()
+{
+	if (renderSettings.getRenderThread()) {
+		if (!renderThread) {
+			renderThread = std::make_unique<RenderThread>();
+		}
+	} else {
+		renderThread.reset();
+	}
+}
+
 template <class Pixel>
 SDLRasterizer<Pixel>::SDLRasterizer(
-		VDP& vdp_, Display& display, VisibleSurface& screen_,
+		VDP& vdp_, Display& display, OutputSurface& screen_,
 		std::unique_ptr<PostProcessor> postProcessor_)
 	: vdp(vdp_), vram(vdp.getVRAM())
 	, screen(screen_)
@@ -91,19 +115,22 @@ SDLRasterizer<Pixel>::SDLRasterizer(
 		}
 	}
 
-	renderSettings.getGammaSetting()      .attach(*this);
-	renderSettings.getBrightnessSetting() .attach(*this);
-	renderSettings.getContrastSetting()   .attach(*this);
-	renderSettings.getColorMatrixSetting().attach(*this);
+	renderSettings.getGammaSetting()       .attach(*this);
+	renderSettings.getBrightnessSetting()  .attach(*this);
+	renderSettings.getContrastSetting()    .attach(*this);
+	renderSettings.getColorMatrixSetting() .attach(*this);
+	renderSettings.getRenderThreadSetting().attach(*this);
+	updateRenderThread();
 }
 
 template <class Pixel>
 SDLRasterizer<Pixel>::~SDLRasterizer()
 {
-	renderSettings.getColorMatrixSetting().detach(*this);
-	renderSettings.getGammaSetting()      .detach(*this);
-	renderSettings.getBrightnessSetting() .detach(*this);
-	renderSettings.getContrastSetting()   .detach(*this);
+	renderSettings.getRenderThreadSetting().detach(*this);
+	renderSettings.getColorMatrixSetting() .detach(*this);
+	renderSettings.getGammaSetting()       .detach(*this);
+	renderSettings.getBrightnessSetting()  .detach(*this);
+	renderSettings.getContrastSetting()    .detach(*this);
 }
 
 template <class Pixel>
@@ -551,62 +578,71 @@ void SDLRasterizer<Pixel>::drawDisplay(
 		                 ? (pageMaskOdd & ~0x100)
 		                 : pageMaskOdd;
 
-		for (int y = screenY; y < screenLimitY; y++) {
-			const int vramLine[2] = {
-				(vram.nameTable.getMask() >> 7) & (pageMaskEven | displayY),
-				(vram.nameTable.getMask() >> 7) & (pageMaskOdd  | displayY)
-			};
-
-			Pixel buf[512];
-			int lineInBuf = -1; // buffer data not valid
-			Pixel* dst = workFrame->getLinePtrDirect<Pixel>(y)
-			           + leftBackground + displayX;
-			int firstPageWidth = pageBorder - displayX;
-			if (firstPageWidth > 0) {
-				if (((displayX + hScroll) == 0) &&
-				    (firstPageWidth == lineWidth)) {
-					// fast-path, directly render to destination
-					renderBitmapLine(dst, vramLine[scrollPage1]);
+		// The lazily calculated parts of the palette must be up-to-date
+		// before lines are converted concurrently.
+		if (renderThread) bitmapConverter.prepareConcurrentConvert();
+		renderLines(screenY, screenLimitY, [&](int fromLine, int limitLine) {
+			int dispY = (displayY + (fromLine - screenY)) & 255;
+			for (int y = fromLine; y < limitLine; y++) {
+				const int vramLine[2] = {
+					(vram.nameTable.getMask() >> 7) & (pageMaskEven | dispY),
+					(vram.nameTable.getMask() >> 7) & (pageMaskOdd  | dispY)
+				};
+
+				Pixel buf[512];
+				int lineInBuf = -1; // buffer data not valid
+				Pixel* dst = workFrame->getLinePtrDirect<Pixel>(y)
+				           + leftBackground + displayX;
+				int firstPageWidth = pageBorder - displayX;
+				if (firstPageWidth > 0) {
+					if (((displayX + hScroll) == 0) &&
+					    (firstPageWidth == lineWidth)) {
+						// fast-path, directly render to destination
+						renderBitmapLine(dst, vramLine[scrollPage1]);
+					} else {
+						lineInBuf = vramLine[scrollPage1];
+						renderBitmapLine(buf, vramLine[scrollPage1]);
+						const Pixel* src = buf + displayX + hScroll;
+						memcpy(dst, src, firstPageWidth * sizeof(Pixel));
+					}
 				} else {
-					lineInBuf = vramLine[scrollPage1];
-					renderBitmapLine(buf, vramLine[scrollPage1]);
-					const Pixel* src = buf + displayX + hScroll;
-					memcpy(dst, src, firstPageWidth * sizeof(Pixel));
+					firstPageWidth = 0;
 				}
-			} else {
-				firstPageWidth = 0;
-			}
-			if (firstPageWidth < displayWidth) {
-				if (lineInBuf != vramLine[scrollPage2]) {
-					renderBitmapLine(buf, vramLine[scrollPage2]);
+				if (firstPageWidth < displayWidth) {
+					if (lineInBuf != vramLine[scrollPage2]) {
+						renderBitmapLine(buf, vramLine[scrollPage2]);
+					}
+					unsigned x = displayX < pageBorder
+						   ? 0 : displayX + hScroll - lineWidth;
+					memcpy(dst + firstPageWidth,
+					       buf + x,
+					       (displayWidth - firstPageWidth) * sizeof(Pixel));
 				}
-				unsigned x = displayX < pageBorder
-					   ? 0 : displayX + hScroll - lineWidth;
-				memcpy(dst + firstPageWidth,
-				       buf + x,
-				       (displayWidth - firstPageWidth) * sizeof(Pixel));
-			}
 
-			displayY = (displayY + 1) & 255;
-		}
+				dispY = (dispY + 1) & 255;
+			}
+		});
 	} else {
 		// horizontal scroll (high) is implemented in CharacterConverter
-		for (int y = screenY; y < screenLimitY; y++) {
-			assert(!vdp.isMSX1VDP() || displayY < 192);
+		renderLines(screenY, screenLimitY, [&](int fromLine, int limitLine) {
+			int dispY = (displayY + (fromLine - screenY)) & 255;
+			for (int y = fromLine; y < limitLine; y++) {
+				assert(!vdp.isMSX1VDP() || dispY < 192);
+
+				Pixel* dst = workFrame->getLinePtrDirect<Pixel>(y)
+				           + leftBackground + displayX;
+				if ((displayX == 0) && (displayWidth == lineWidth)){
+					characterConverter.convertLine(dst, dispY);
+				} else {
+					Pixel buf[512];
+					characterConverter.convertLine(buf, dispY);
+					const Pixel* src = buf + displayX;
+					memcpy(dst, src, displayWidth * sizeof(Pixel));
+				}
 
-			Pixel* dst = workFrame->getLinePtrDirect<Pixel>(y)
-			           + leftBackground + displayX;
-			if ((displayX == 0) && (displayWidth == lineWidth)){
-				characterConverter.convertLine(dst, displayY);
-			} else {
-				Pixel buf[512];
-				characterConverter.convertLine(buf, displayY);
-				const Pixel* src = buf + displayX;
-				memcpy(dst, src, displayWidth * sizeof(Pixel));
+				dispY = (dispY + 1) & 255;
 			}
-
-			displayY = (displayY + 1) & 255;
-		}
+		});
 	}
 }
 
@@ -635,37 +671,37 @@ void SDLRasterizer<Pixel>::drawSprites(
 	//       pixels in this display mode?
 	int spriteMode = vdp.getDisplayMode().getSpriteMode(vdp.isMSX1VDP());
 	int displayLimitX = displayX + displayWidth;
-	int limitY = fromY + displayHeight;
 	int screenX = translateX(
 		vdp.getLeftSprites(),
 		vdp.getDisplayMode().getLineWidth() == 512);
-	if (spriteMode == 1) {
-		for (int y = fromY; y < limitY; y++, screenY++) {
-			Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(screenY) + screenX;
-			spriteConverter.drawMode1(y, displayX, displayLimitX, pixelPtr);
-		}
-	} else {
-		byte mode = vdp.getDisplayMode().getByte();
-		if (mode == DisplayMode::GRAPHIC5) {
-			for (int y = fromY; y < limitY; y++, screenY++) {
-				Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(screenY) + screenX;
+	byte mode = vdp.getDisplayMode().getByte();
+	renderLines(screenY, screenLimitY, [&](int fromLine, int limitLine) {
+		int y = fromY + (fromLine - screenY);
+		if (spriteMode == 1) {
+			for (int sy = fromLine; sy < limitLine; y++, sy++) {
+				Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(sy) + screenX;
+				spriteConverter.drawMode1(y, displayX, displayLimitX, pixelPtr);
+			}
+		} else if (mode == DisplayMode::GRAPHIC5) {
+			for (int sy = fromLine; sy < limitLine; y++, sy++) {
+				Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(sy) + screenX;
 				spriteConverter.template drawMode2<DisplayMode::GRAPHIC5>(
 					y, displayX, displayLimitX, pixelPtr);
 			}
 		} else if (mode == DisplayMode::GRAPHIC6) {
-			for (int y = fromY; y < limitY; y++, screenY++) {
-				Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(screenY) + screenX;
+			for (int sy = fromLine; sy < limitLine; y++, sy++) {
+				Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(sy) + screenX;
 				spriteConverter.template drawMode2<DisplayMode::GRAPHIC6>(
 					y, displayX, displayLimitX, pixelPtr);
 			}
 		} else {
-			for (int y = fromY; y < limitY; y++, screenY++) {
-				Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(screenY) + screenX;
+			for (int sy = fromLine; sy < limitLine; y++, sy++) {
+				Pixel* pixelPtr = workFrame->getLinePtrDirect<Pixel>(sy) + screenX;
 				spriteConverter.template drawMode2<DisplayMode::GRAPHIC4>(
 					y, displayX, displayLimitX, pixelPtr);
 			}
 		}
-	}
+	});
 }
 
 template <class Pixel>
@@ -683,6 +719,8 @@ void SDLRasterizer<Pixel>::update(const Setting& setting)
 	    (&setting == &renderSettings.getColorMatrixSetting())) {
 		precalcPalette();
 		resetPalette();
+	} else if (&setting == &renderSettings.getRenderThreadSetting()) {
+		updateRenderThread();
 	}
 }
 
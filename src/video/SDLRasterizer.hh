@@ -15,11 +15,11 @@ class Display;
 class VDP;
 class VDPVRAM;
 class OutputSurface;
-class VisibleSurface;
 class RawFrame;
 class RenderSettings;
 class Setting;
 class PostProcessor;
+class RenderThread;
 
 /** Rasterizer using a frame buffer approach: it writes pixels to a single
   * rectangular pixel buffer.
@@ -33,7 +33,7 @@ public:
 	SDLRasterizer& operator=(const SDLRasterizer&) = delete;
 
 	SDLRasterizer(
-		VDP& vdp, Display& display, VisibleSurface& screen,
+		VDP& vdp, Display& display, OutputSurface& screen,
 		std::unique_ptr<PostProcessor> postProcessor);
 	~SDLRasterizer() override;
 
@@ -65,6 +65,17 @@ public:
 private:
 	inline void renderBitmapLine(Pixel* buf, unsigned vramLine);
 
+	/** Render the screen lines [fromY, limitY) using the given functor.
+	  * When the render thread is enabled, the work is divided between
+	  * that thread and the calling thread.
+	  */
+	template<typename F> void renderLines(int fromY, int limitY, F render);
+
+	/** (Re)create or destroy the render thread, depending on the
+	  * current value of the "render_thread" setting.
+	  */
+	void updateRenderThread();
+
 	/** Reload entire palette from VDP.
 	  */
 	void resetPalette();
@@ -128,6 +139,11 @@ private:
 	  */
 	SpriteConverter<Pixel> spriteConverter;
 
+	/** Helper thread to render part of the lines of large draw requests,
+	  * nullptr when the "render_thread" setting is disabled.
+	  */
+	std::unique_ptr<RenderThread> renderThread;
+
 	/** Line to render at top of display.
 	  * After all, our screen is 240 lines while display is 262 or 313.
 	  */
@@ -233,7 +233,7 @@ void SDLVideoSystem::takeScreenShot(const std::string& filename, bool withOsd)
 {
 	if (withOsd) {
 		// we can directly save current content as screenshot
-		screen->saveScreenshot(filename);
+		screen->saveScreenshot(display.getScreenShotWriter(), filename);
 	} else {
 		// we first need to re-render to an off-screen surface
 		// with OSD layers disabled
@@ -241,7 +241,7 @@ void SDLVideoSystem::takeScreenShot(const std::string& filename, bool withOsd)
 		ScopedLayerHider hideOsd(*osdGuiLayer);
 		std::unique_ptr<OutputSurface> surf = screen->createOffScreenSurface();
 		display.repaint(*surf);
-		surf->saveScreenshot(filename);
+		surf->saveScreenshot(display.getScreenShotWriter(), filename);
 	}
 }
 
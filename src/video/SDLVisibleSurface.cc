@@ -1,6 +1,6 @@
 #include "SDLVisibleSurface.hh"
 #include "SDLOffScreenSurface.hh"
-#include "PNG.hh"
+#include "ScreenShotWriter.hh"
 #include "SDLSnow.hh"
 #include "OSDConsoleRenderer.hh"
 #include "OSDGUILayer.hh"
@@ -82,13 +82,15 @@ std::unique_ptr<OutputSurface> SDLVisibleSurface::createOffScreenSurface()
 	return std::make_unique<SDLOffScreenSurface>(*getSDLSurface());
 }
 
-void SDLVisibleSurface::saveScreenshot(const std::string& filename)
+void SDLVisibleSurface::saveScreenshot(
+	ScreenShotWriter& writer, const std::string& filename)
 {
-	saveScreenshotSDL(*this, filename);
+	saveScreenshotSDL(*this, writer, filename);
 }
 
 void SDLVisibleSurface::saveScreenshotSDL(
-	OutputSurface& output, const std::string& filename)
+	OutputSurface& output, ScreenShotWriter& writer,
+	const std::string& filename)
 {
 	unsigned width = output.getWidth();
 	unsigned height = output.getHeight();
@@ -102,7 +104,7 @@ void SDLVisibleSurface::saveScreenshotSDL(
 			SDL_PIXELFORMAT_RGB24, buffer.data(), width * 3)) {
 		throw MSXException("Couldn't acquire screenshot pixels: ", SDL_GetError());
 	}
-	PNG::save(width, height, rowPointers, filename);
+	writer.save(width, height, rowPointers, filename);
 }
 
 void SDLVisibleSurface::clearScreen()
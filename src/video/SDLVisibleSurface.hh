@@ -16,11 +16,13 @@ public:
 	                  CliComm& cliComm);
 
 	static void saveScreenshotSDL(OutputSurface& output,
+	                              ScreenShotWriter& writer,
 	                              const std::string& filename);
 
 private:
 	// OutputSurface
-	void saveScreenshot(const std::string& filename) override;
+	void saveScreenshot(ScreenShotWriter& writer,
+	                    const std::string& filename) override;
 	void clearScreen() override;
 
 	// VisibleSurface
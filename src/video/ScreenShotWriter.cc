@@ -0,0 +1,187 @@
+#include "ScreenShotWriter.hh"
+#include "PNG.hh"
+#include "QOI.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "EventDistributor.hh"
+#include "Event.hh"
+#include "CliComm.hh"
+#include "MSXException.hh"
+#include "StringOp.hh"
+#include "build-info.hh"
+#include "vla.hh"
+#include <cstring>
+#include <iostream>
+#include <SDL.h>
+
+namespace openmsx {
+
+ScreenShotWriter::ScreenShotWriter(
+		CommandController& commandController,
+		EventDistributor& eventDistributor_, CliComm& cliComm_)
+	: eventDistributor(eventDistributor_), cliComm(cliComm_)
+	, formatSetting(commandController, "screenshot_format",
+		"file format for new screenshots: PNG or the much faster "
+		"to encode (but less widely supported) QOI format",
+		FORMAT_PNG,
+		EnumSetting<Format>::Map{{"png", FORMAT_PNG}, {"qoi", FORMAT_QOI}})
+	, compressionSetting(commandController, "screenshot_compression",
+		"compression level for PNG screenshots, from 0 (fastest, "
+		"largest files) to 9 (slowest, smallest files)", 6, 0, 9)
+	, asyncSetting(commandController, "screenshot_async",
+		"encode and write screenshots in the background, so that "
+		"taking a screenshot doesn't stall the emulation", false)
+	, exitLoop(false)
+{
+	eventDistributor.registerEventListener(OPENMSX_SCREENSHOT_WRITER_EVENT, *this);
+}
+
+ScreenShotWriter::~ScreenShotWriter()
+{
+	if (thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			exitLoop = true; // but first finish all pending jobs
+		}
+		condition.notify_all();
+		thread.join();
+	}
+	eventDistributor.unregisterEventListener(OPENMSX_SCREENSHOT_WRITER_EVENT, *this);
+
+	// Too late to report these via CliComm.
+	for (auto& e : errors) {
+		std::cerr << e << '\n';
+	}
+}
+
+void ScreenShotWriter::save(unsigned width, unsigned height,
+                            const void** rowPointers, const std::string& filename)
+{
+	Job job;
+	job.width = width;
+	job.height = height;
+	job.pixels.resize(width * height * 3);
+	for (unsigned y = 0; y < height; ++y) {
+		memcpy(&job.pixels[width * 3 * y], rowPointers[y], width * 3);
+	}
+	job.filename = filename;
+	submit(std::move(job));
+}
+
+void ScreenShotWriter::save(unsigned width, unsigned height,
+                            const void** rowPointers,
+                            const SDL_PixelFormat& format,
+                            const std::string& filename)
+{
+	Job job;
+	job.width = width;
+	job.height = height;
+	job.pixels.resize(width * height * 3);
+	auto dstFormat = OPENMSX_BIGENDIAN ? SDL_PIXELFORMAT_BGR24
+	                                   : SDL_PIXELFORMAT_RGB24;
+	for (unsigned y = 0; y < height; ++y) {
+		if (SDL_ConvertPixels(width, 1, format.format,
+		                      rowPointers[y], width * format.BytesPerPixel,
+		                      dstFormat, &job.pixels[width * 3 * y],
+		                      width * 3)) {
+			throw MSXException("Couldn't convert screenshot pixels: ",
+			                   SDL_GetError());
+		}
+	}
+	job.filename = filename;
+	submit(std::move(job));
+}
+
+const char* ScreenShotWriter::getExtension() const
+{
+	return (formatSetting.getEnum() == FORMAT_QOI) ? ".qoi" : ".png";
+}
+
+void ScreenShotWriter::submit(Job job)
+{
+	// The 'screenshot_format' setting only selects the extension of
+	// generated filenames. The actual format follows the extension, so
+	// that an explicitly given "foo.png" is always a PNG file.
+	auto ext = FileOperations::getExtension(job.filename);
+	job.format = StringOp::casecmp()(ext, "qoi") ? FORMAT_QOI : FORMAT_PNG;
+	job.compressionLevel = compressionSetting.getInt();
+
+	if (!asyncSetting.getBoolean()) {
+		write(job);
+		return;
+	}
+
+	// Already create the (empty) file. This reports errors (e.g. an
+	// invalid path) to the caller, and it reserves the filename, so that
+	// the next 'screenshot' command picks a different one even when this
+	// job is still pending.
+	File(job.filename, File::TRUNCATE);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(std::move(job));
+	}
+	if (!thread.joinable()) {
+		thread = std::thread([this]() { run(); });
+	}
+	condition.notify_all();
+}
+
+void ScreenShotWriter::write(const Job& job)
+{
+	VLA(const void*, rowPointers, job.height);
+	for (unsigned y = 0; y < job.height; ++y) {
+		rowPointers[y] = &job.pixels[job.width * 3 * y];
+	}
+	switch (job.format) {
+	case FORMAT_PNG:
+		PNG::save(job.width, job.height, rowPointers, job.filename,
+		          job.compressionLevel);
+		break;
+	case FORMAT_QOI:
+		QOI::save(job.width, job.height, rowPointers, job.filename);
+		break;
+	}
+}
+
+void ScreenShotWriter::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		condition.wait(lock, [this]() { return !queue.empty() || exitLoop; });
+		if (queue.empty()) break; // exitLoop and no more pending jobs
+
+		Job job = std::move(queue.front());
+		queue.pop_front();
+		lock.unlock();
+
+		std::string error;
+		try {
+			write(job);
+		} catch (MSXException& e) {
+			error = e.getMessage();
+		}
+
+		lock.lock();
+		if (!error.empty()) {
+			errors.push_back(std::move(error));
+			eventDistributor.distributeEvent(
+				std::make_shared<SimpleEvent>(OPENMSX_SCREENSHOT_WRITER_EVENT));
+		}
+	}
+}
+
+int ScreenShotWriter::signalEvent(const std::shared_ptr<const Event>& /*event*/)
+{
+	std::vector<std::string> errors2;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::swap(errors, errors2);
+	}
+	for (auto& e : errors2) {
+		cliComm.printWarning("Failed to write screenshot: ", e);
+	}
+	return 0;
+}
+
+} // namespace openmsx
@@ -0,0 +1,95 @@
+#ifndef SCREENSHOTWRITER_HH
+#define SCREENSHOTWRITER_HH
+
+#include "EventListener.hh"
+#include "BooleanSetting.hh"
+#include "EnumSetting.hh"
+#include "IntegerSetting.hh"
+#include "MemBuffer.hh"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SDL_PixelFormat;
+
+namespace openmsx {
+
+class CommandController;
+class EventDistributor;
+class CliComm;
+
+/** Writes screenshot images to disk.
+  *
+  * The pixels are always copied on the calling (emulation) thread, so the
+  * caller can immediately continue to modify its buffers. Encoding and
+  * writing the file is the expensive part; depending on the
+  * 'screenshot_async' setting that is either done immediately or handed to
+  * a background thread. Errors from the background thread are reported
+  * (as a warning) from the main thread.
+  */
+class ScreenShotWriter final : private EventListener
+{
+public:
+	enum Format { FORMAT_PNG, FORMAT_QOI };
+
+	ScreenShotWriter(CommandController& commandController,
+	                 EventDistributor& eventDistributor, CliComm& cliComm);
+	~ScreenShotWriter();
+
+	/** Save an image given as rows of 24bpp RGB pixels.
+	  * @throws MSXException If the file can't be created, or (when
+	  *         writing synchronously) if encoding fails.
+	  */
+	void save(unsigned width, unsigned height, const void** rowPointers,
+	          const std::string& filename);
+
+	/** Same as above, but the rows are in the given pixel format.
+	  */
+	void save(unsigned width, unsigned height, const void** rowPointers,
+	          const SDL_PixelFormat& format, const std::string& filename);
+
+	/** File extension (including the dot) for the format selected by
+	  * the 'screenshot_format' setting. The format of a written file is
+	  * determined by its extension: ".qoi" for QOI, anything else is PNG.
+	  */
+	const char* getExtension() const;
+
+private:
+	struct Job {
+		unsigned width;
+		unsigned height;
+		MemBuffer<uint8_t> pixels; // 24bpp RGB, no padding between rows
+		std::string filename;
+		Format format;
+		int compressionLevel;
+	};
+
+	void submit(Job job);
+	static void write(const Job& job);
+	void run();
+
+	// EventListener
+	int signalEvent(const std::shared_ptr<const Event>& event) override;
+
+	EventDistributor& eventDistributor;
+	CliComm& cliComm;
+
+	EnumSetting<Format> formatSetting;
+	IntegerSetting compressionSetting;
+	BooleanSetting asyncSetting;
+
+	std::thread thread; // only started on first background write
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<Job> queue;    // protected by mutex
+	std::vector<std::string> errors; // protected by mutex
+	bool exitLoop; // protected by mutex
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,348 @@
+#include "SharedMemoryExport.hh"
+#include "Reactor.hh"
+#include "MSXMotherBoard.hh"
+#include "CommandException.hh"
+#include "Display.hh"
+#include "PostProcessor.hh"
+#include "RawFrame.hh"
+#include "MSXMixer.hh"
+#include "TclObject.hh"
+#include "outer.hh"
+#include "strCat.hh"
+#include "systemfuncs.hh"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <SDL.h>
+#if HAVE_SHM_OPEN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+
+namespace openmsx {
+
+static uint64_t toTicks(EmuTime::param time)
+{
+	return (time - EmuTime::zero).length();
+}
+
+SharedMemoryExport::SharedMemoryExport(Reactor& reactor_)
+	: reactor(reactor_)
+	, shmExportCommand(reactor.getCommandController())
+	, mixer(nullptr)
+	, header(nullptr)
+	, shmSize(0)
+	, fd(-1)
+{
+}
+
+SharedMemoryExport::~SharedMemoryExport()
+{
+	assert(shmName.empty());
+}
+
+void SharedMemoryExport::start(bool exportVideo, bool exportAudio,
+                               const string& name)
+{
+	stop();
+#if HAVE_SHM_OPEN
+	MSXMotherBoard* motherBoard = reactor.getMotherBoard();
+	if (!motherBoard) {
+		throw CommandException("No active MSX machine.");
+	}
+	vector<PostProcessor*> newPostProcessors;
+	unsigned bytesPerPixel = 0;
+	uint32_t redMask = 0, greenMask = 0, blueMask = 0;
+	if (exportVideo) {
+		// Like for 'record': hook into all video sources, only the
+		// active one actually sends frames.
+		for (auto* l : reactor.getDisplay().getAllLayers()) {
+			if (auto* pp = dynamic_cast<PostProcessor*>(l)) {
+				newPostProcessors.push_back(pp);
+			}
+		}
+		if (newPostProcessors.empty()) {
+			throw CommandException(
+				"Current renderer doesn't support video export.");
+		}
+		// any source is fine because they all have the same format
+		const auto& format = newPostProcessors.front()->getSDLFormat();
+		bytesPerPixel = (format.BitsPerPixel == 32) ? 4 : 2;
+		redMask   = format.Rmask;
+		greenMask = format.Gmask;
+		blueMask  = format.Bmask;
+	}
+
+	// Calculate the layout, see class comment.
+	size_t framePitch = FRAME_MAX_WIDTH * bytesPerPixel;
+	size_t frameSlotSize = sizeof(FrameSlot) +
+		FRAME_MAX_HEIGHT * (sizeof(uint32_t) + framePitch);
+	size_t audioSlotSize = sizeof(AudioSlot) +
+		MAX_AUDIO_SAMPLES * 2 * sizeof(int16_t);
+	unsigned numFrameSlots = exportVideo ? NUM_FRAME_SLOTS : 0;
+	unsigned numAudioSlots = exportAudio ? NUM_AUDIO_SLOTS : 0;
+	size_t frameOffset = sizeof(Header);
+	size_t audioOffset = frameOffset + numFrameSlots * frameSlotSize;
+	size_t size = audioOffset + numAudioSlots * audioSlotSize;
+
+	int newFd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (newFd == -1) {
+		throw CommandException("Couldn't create shared memory object ",
+		                       name, ": ", strerror(errno));
+	}
+	if (ftruncate(newFd, size) == -1) {
+		int err = errno;
+		close(newFd);
+		shm_unlink(name.c_str());
+		throw CommandException("Couldn't resize shared memory object ",
+		                       name, ": ", strerror(err));
+	}
+	void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+	                 newFd, 0);
+	if (mem == MAP_FAILED) {
+		int err = errno;
+		close(newFd);
+		shm_unlink(name.c_str());
+		throw CommandException("Couldn't map shared memory object ",
+		                       name, ": ", strerror(err));
+	}
+
+	// ftruncate() zero-filled the object, so all sequence numbers are
+	// already 0, only the header needs to be filled in.
+	header = new (mem) Header();
+	memcpy(header->magic, "openMSX", 8);
+	header->version = VERSION;
+	header->headerSize = sizeof(Header);
+	header->ticksPerSecond = MAIN_FREQ;
+	header->numFrameSlots = numFrameSlots;
+	header->frameMaxWidth = FRAME_MAX_WIDTH;
+	header->frameMaxHeight = FRAME_MAX_HEIGHT;
+	header->framePitch = framePitch;
+	header->bytesPerPixel = bytesPerPixel;
+	header->redMask   = redMask;
+	header->greenMask = greenMask;
+	header->blueMask  = blueMask;
+	header->frameOffset = frameOffset;
+	header->frameSlotSize = frameSlotSize;
+	header->numAudioSlots = numAudioSlots;
+	header->maxAudioSamples = MAX_AUDIO_SAMPLES;
+	header->audioOffset = audioOffset;
+	header->audioSlotSize = audioSlotSize;
+	header->frameSequence.store(0, std::memory_order_release);
+	header->audioSequence.store(0, std::memory_order_release);
+
+	shmName = name;
+	shmSize = size;
+	fd = newFd;
+	frameSequence = 0;
+	audioSequence = 0;
+
+	// only set hooks when all errors are checked for
+	postProcessors = std::move(newPostProcessors);
+	for (auto* pp : postProcessors) {
+		pp->setSharedMemoryExport(this);
+	}
+	if (exportAudio) {
+		mixer = &motherBoard->getMSXMixer();
+		mixer->setSharedMemoryExport(this);
+	}
+#else
+	(void)exportVideo; (void)exportAudio; (void)name;
+	throw CommandException(
+		"Shared memory export is not supported on this platform.");
+#endif
+}
+
+void SharedMemoryExport::stop()
+{
+	for (auto* pp : postProcessors) {
+		pp->setSharedMemoryExport(nullptr);
+	}
+	postProcessors.clear();
+	if (mixer) {
+		mixer->setSharedMemoryExport(nullptr);
+		mixer = nullptr;
+	}
+#if HAVE_SHM_OPEN
+	if (!shmName.empty()) {
+		munmap(header, shmSize);
+		close(fd);
+		// Processes that still have the object mapped can keep on
+		// using it, it only disappears from the namespace.
+		shm_unlink(shmName.c_str());
+	}
+#endif
+	header = nullptr;
+	shmSize = 0;
+	fd = -1;
+	shmName.clear();
+}
+
+void SharedMemoryExport::addImage(RawFrame& frame, EmuTime::param time)
+{
+	assert(header && header->numFrameSlots);
+	auto seq = ++frameSequence;
+	auto* base = reinterpret_cast<char*>(header) + header->frameOffset +
+	             (seq % header->numFrameSlots) * header->frameSlotSize;
+	auto* slot = reinterpret_cast<FrameSlot*>(base);
+	auto* lineWidths = reinterpret_cast<uint32_t*>(base + sizeof(FrameSlot));
+	auto* pixels = reinterpret_cast<char*>(lineWidths + FRAME_MAX_HEIGHT);
+
+	slot->sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	unsigned height = std::min(frame.getHeight(), unsigned(FRAME_MAX_HEIGHT));
+	unsigned pitch = header->framePitch;
+	unsigned bytesPerPixel = header->bytesPerPixel;
+	slot->emuTime = toTicks(time);
+	slot->height = height;
+	slot->field = frame.getField();
+	for (unsigned y = 0; y < height; ++y) {
+		unsigned width = std::min(frame.getLineWidthDirect(y),
+		                          unsigned(FRAME_MAX_WIDTH));
+		lineWidths[y] = width;
+		memcpy(pixels + y * pitch, frame.getLinePtrDirect<char>(y),
+		       width * bytesPerPixel);
+	}
+
+	slot->sequence.store(seq, std::memory_order_release);
+	header->frameSequence.store(seq, std::memory_order_release);
+}
+
+void SharedMemoryExport::addWave(unsigned num, const int16_t* data,
+                                 EmuTime::param time)
+{
+	assert(header && header->numAudioSlots);
+	assert(num <= MAX_AUDIO_SAMPLES);
+	if (num == 0) return;
+
+	auto seq = ++audioSequence;
+	auto* base = reinterpret_cast<char*>(header) + header->audioOffset +
+	             (seq % header->numAudioSlots) * header->audioSlotSize;
+	auto* slot = reinterpret_cast<AudioSlot*>(base);
+
+	slot->sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot->emuTime = toTicks(time);
+	slot->numSamples = num;
+	slot->sampleRate = mixer->getSampleRate();
+	memcpy(base + sizeof(AudioSlot), data, num * 2 * sizeof(int16_t));
+
+	slot->sequence.store(seq, std::memory_order_release);
+	header->audioSequence.store(seq, std::memory_order_release);
+}
+
+void SharedMemoryExport::processStart(span<const TclObject> tokens, TclObject& result)
+{
+	bool exportVideo = true;
+	bool exportAudio = true;
+	string name = "/openmsx";
+	bool nameGiven = false;
+	for (size_t i = 2; i < tokens.size(); ++i) {
+		string_view token = tokens[i].getString();
+		if (token == "-videoonly") {
+			exportAudio = false;
+		} else if (token == "-audioonly") {
+			exportVideo = false;
+		} else if (token.starts_with('-')) {
+			throw CommandException("Invalid option: ", token);
+		} else if (!nameGiven) {
+			name = token.str();
+			nameGiven = true;
+		} else {
+			throw SyntaxError();
+		}
+	}
+	if (!exportAudio && !exportVideo) {
+		throw CommandException("Can't have both -videoonly and -audioonly.");
+	}
+	// Portable shared memory object names start with a single slash.
+	if (!string_view(name).starts_with('/')) {
+		name = '/' + name;
+	}
+	start(exportVideo, exportAudio, name);
+	result = "Exporting to shared memory object " + name;
+}
+
+void SharedMemoryExport::status(span<const TclObject> tokens, TclObject& result) const
+{
+	if (tokens.size() != 2) {
+		throw SyntaxError();
+	}
+	if (shmName.empty()) {
+		result.addDictKeyValue("status", "idle");
+	} else {
+		result.addDictKeyValue("status", "exporting");
+		result.addDictKeyValue("name", shmName);
+		result.addDictKeyValue("frames", int(frameSequence));
+		result.addDictKeyValue("fragments", int(audioSequence));
+	}
+}
+
+
+// class SharedMemoryExport::Cmd
+
+SharedMemoryExport::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "shm_export")
+{
+}
+
+void SharedMemoryExport::Cmd::execute(span<const TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() < 2) {
+		throw CommandException("Missing argument");
+	}
+	auto& shmExport = OUTER(SharedMemoryExport, shmExportCommand);
+	const string_view subcommand = tokens[1].getString();
+	if (subcommand == "start") {
+		shmExport.processStart(tokens, result);
+	} else if (subcommand == "stop") {
+		if (tokens.size() != 2) {
+			throw SyntaxError();
+		}
+		shmExport.stop();
+	} else if (subcommand == "status") {
+		shmExport.status(tokens, result);
+	} else {
+		throw SyntaxError();
+	}
+}
+
+string SharedMemoryExport::Cmd::help(const vector<string>& /*tokens*/) const
+{
+	return "Publish video frames and audio in a POSIX shared memory object, "
+	       "for external applications.\n"
+	       "shm_export start           Export to shared memory object '/openmsx'\n"
+	       "shm_export start <name>    Export to the given shared memory object\n"
+	       "shm_export stop            Stop exporting\n"
+	       "shm_export status          Query export state\n"
+	       "\n"
+	       "The start subcommand also accepts an optional -audioonly or "
+	       "-videoonly flag. See SharedMemoryExport.hh in the openMSX "
+	       "sources for the layout of the shared memory object.";
+}
+
+void SharedMemoryExport::Cmd::tabCompletion(vector<string>& tokens) const
+{
+	if (tokens.size() == 2) {
+		static const char* const cmds[] = {
+			"start", "stop", "status",
+		};
+		completeString(tokens, cmds);
+	} else if ((tokens.size() >= 3) && (tokens[1] == "start")) {
+		static const char* const options[] = {
+			"-videoonly", "-audioonly",
+		};
+		completeString(tokens, options);
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,131 @@
+#ifndef SHAREDMEMORYEXPORT_HH
+#define SHAREDMEMORYEXPORT_HH
+
+#include "Command.hh"
+#include "EmuTime.hh"
+#include "span.hh"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class Reactor;
+class PostProcessor;
+class MSXMixer;
+class RawFrame;
+class TclObject;
+
+/** Publishes the finished (unscaled) video frames and the mixed audio
+  * fragments in a POSIX shared memory object. External processes can map
+  * that object and consume video and audio at full rate, without going
+  * through files (like 'screenshot' and 'record' do).
+  *
+  * Layout of the shared memory object (integers are in host byte order):
+  *   Header
+  *   numFrameSlots times: FrameSlot, followed by frameMaxHeight uint32_t
+  *                        line widths, followed by frameMaxHeight lines of
+  *                        framePitch bytes
+  *   numAudioSlots times: AudioSlot, followed by maxAudioSamples stereo
+  *                        int16_t sample pairs
+  * (the exact offsets and sizes are stored in the header).
+  *
+  * Both rings are written in sequence: item N (starting from 1) goes to
+  * slot (N % numSlots). Each slot is protected by a sequence lock: while a
+  * slot is being written its 'sequence' field is 0, afterwards it's N.
+  * Only then the 'frameSequence' or 'audioSequence' field in the header
+  * is set to N. A reader should:
+  *  - read the sequence number N from the header
+  *  - check that the slot's 'sequence' equals N
+  *  - copy the data it needs
+  *  - check again that the slot's 'sequence' still equals N, if not
+  *    the slot got overwritten in the mean time
+  * Gaps in the sequence numbers seen by a reader mean it was too slow.
+  *
+  * The header fields (except for the sequence numbers) don't change during
+  * an export. Changing the renderer or a video setting that recreates the
+  * video system stops the export (with a warning).
+  */
+class SharedMemoryExport
+{
+public:
+	static const uint32_t VERSION = 1;
+	static const unsigned NUM_FRAME_SLOTS = 4;
+	static const unsigned FRAME_MAX_WIDTH = 1280; // V9990 in B1..B7 modes
+	static const unsigned FRAME_MAX_HEIGHT = 480; // laserdisc
+	static const unsigned NUM_AUDIO_SLOTS = 64;
+	static const unsigned MAX_AUDIO_SAMPLES = 8192; // see MSXMixer
+
+	struct Header {
+		char magic[8]; // "openMSX" + zero byte
+		uint32_t version;
+		uint32_t headerSize;
+		uint64_t ticksPerSecond; // unit of the 'emuTime' fields
+
+		uint32_t numFrameSlots; // 0 when not exporting video
+		uint32_t frameMaxWidth;
+		uint32_t frameMaxHeight;
+		uint32_t framePitch; // in bytes
+		uint32_t bytesPerPixel; // 2 or 4
+		uint32_t redMask, greenMask, blueMask; // of the video pixels
+		uint64_t frameOffset; // offset of the first FrameSlot
+		uint64_t frameSlotSize; // in bytes, incl FrameSlot struct
+		std::atomic<uint64_t> frameSequence; // 0 -> no frame yet
+
+		uint32_t numAudioSlots; // 0 when not exporting audio
+		uint32_t maxAudioSamples;
+		uint64_t audioOffset; // offset of the first AudioSlot
+		uint64_t audioSlotSize; // in bytes, incl AudioSlot struct
+		std::atomic<uint64_t> audioSequence; // 0 -> no fragment yet
+	};
+
+	struct FrameSlot {
+		std::atomic<uint64_t> sequence;
+		uint64_t emuTime; // moment the frame was finished
+		uint32_t height; // number of lines in this frame
+		uint32_t field; // 0 = non-interlaced, 1 = even, 2 = odd
+	};
+
+	struct AudioSlot {
+		std::atomic<uint64_t> sequence;
+		uint64_t emuTime; // moment of the first sample
+		uint32_t numSamples; // number of stereo sample pairs
+		uint32_t sampleRate;
+	};
+
+	explicit SharedMemoryExport(Reactor& reactor);
+	~SharedMemoryExport();
+
+	void addImage(RawFrame& frame, EmuTime::param time);
+	void addWave(unsigned num, const int16_t* data, EmuTime::param time);
+	void stop();
+
+private:
+	void start(bool exportVideo, bool exportAudio, const std::string& name);
+	void processStart(span<const TclObject> tokens, TclObject& result);
+	void status(span<const TclObject> tokens, TclObject& result) const;
+
+	Reactor& reactor;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(span<const TclObject> tokens, TclObject& result) override;
+		std::string help(const std::vector<std::string>& tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} shmExportCommand;
+
+	std::vector<PostProcessor*> postProcessors;
+	MSXMixer* mixer;
+
+	std::string shmName; // empty when not exporting
+	Header* header; // start of the mapped shared memory object
+	size_t shmSize;
+	int fd;
+	uint64_t frameSequence;
+	uint64_t audioSequence;
+};
+
+} // namespace openmsx
+
+#endif
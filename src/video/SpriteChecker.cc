@@ -12,6 +12,7 @@ TODO:
 #include "RenderSettings.hh"
 #include "BooleanSetting.hh"
 #include "serialize.hh"
+#include "outer.hh"
 #include <algorithm>
 #include <cassert>
 
@@ -22,8 +23,9 @@ SpriteChecker::SpriteChecker(VDP& vdp_, RenderSettings& renderSettings,
 	: vdp(vdp_), vram(vdp.getVRAM())
 	, limitSpritesSetting(renderSettings.getLimitSpritesSetting())
 	, frameStartTime(time)
+	, spriteLinesDirty(true)
 {
-	vram.spriteAttribTable.setObserver(this);
+	vram.spriteAttribTable.setObserver(&attribObserver);
 	vram.spritePatternTable.setObserver(this);
 }
 
@@ -36,6 +38,7 @@ void SpriteChecker::reset(EmuTime::param time)
 	frameStart(time);
 
 	updateSpritesMethod = &SpriteChecker::updateSprites1;
+	spriteLinesDirty = true;
 }
 
 static inline SpriteChecker::SpritePattern doublePattern(SpriteChecker::SpritePattern a)
@@ -78,6 +81,115 @@ inline SpriteChecker::SpritePattern SpriteChecker::calculatePatternPlanar(
 	return !vdp.isSpriteMag() ? pattern : doublePattern(pattern);
 }
 
+void SpriteChecker::updateSpriteLines(bool mode2)
+{
+	ranges::fill(spriteLines, 0);
+	int magSize = (vdp.isSpriteMag() + 1) * vdp.getSpriteSize();
+
+	const byte* yPtr;
+	unsigned yStride;
+	if (!mode2) {
+		yPtr = vram.spriteAttribTable.getReadArea(0, 32 * 4);
+		yStride = 4;
+	} else if (planar) {
+		const byte* attributePtr1;
+		vram.spriteAttribTable.getReadAreaPlanar(
+			512, 32 * 4, yPtr, attributePtr1);
+		yStride = 2;
+	} else {
+		yPtr = vram.spriteAttribTable.getReadArea(512, 32 * 4);
+		yStride = 4;
+	}
+	byte terminator = mode2 ? 216 : 208;
+
+	numSprites = 32;
+	for (int sprite = 0; sprite < 32; ++sprite) {
+		byte y = yPtr[yStride * sprite];
+		if (y == terminator) {
+			numSprites = sprite;
+			break;
+		}
+		spriteY[sprite] = y;
+		uint32_t bit = 1u << sprite;
+		for (int i = 0; i < magSize; ++i) {
+			spriteLines[(y + i) & 0xFF] |= bit;
+		}
+	}
+	spriteLinesDirty = false;
+}
+
+inline bool SpriteChecker::affectsSpriteLines(unsigned offset) const
+{
+	if (updateSpritesMethod != &SpriteChecker::updateSprites2) {
+		// sprite mode 1: Y-coordinate is the first byte of each entry
+		return (offset & 3) == 0;
+	}
+	// In planar mode the offsets are scrambled, don't bother.
+	if (planar) return true;
+	// sprite mode 2: skip the color table (first 512 bytes)
+	return (offset >= 512) && ((offset & 3) == 0);
+}
+
+void SpriteChecker::AttribObserver::updateVRAM(
+	unsigned offset, EmuTime::param time)
+{
+	auto& checker = OUTER(SpriteChecker, attribObserver);
+	// Check the lines before this change with the old sprite lines.
+	checker.checkUntil(time);
+	if (checker.affectsSpriteLines(offset)) {
+		checker.spriteLinesDirty = true;
+	}
+}
+
+void SpriteChecker::AttribObserver::updateWindow(
+	bool /*enabled*/, EmuTime::param time)
+{
+	auto& checker = OUTER(SpriteChecker, attribObserver);
+	checker.sync(time);
+	checker.spriteLinesDirty = true;
+}
+
+int SpriteChecker::findCollision(const SpriteInfo* sprites, int num,
+                                 byte ignoreMask)
+{
+	/*
+	Instead of checking every pair of sprites, keep a bitmap of the pixels
+	that are covered by the sprites seen so far (one bit per pixel, 32
+	pixels per word) and a bitmap of the pixels that were covered more
+	than once. Words 0-7 cover the visible screen (x in [0..256)), word 8
+	catches the pixels of sprites that stick out at the right.
+	*/
+	uint32_t covered [8 + 1] = {};
+	uint32_t collided[8 + 1] = {};
+	for (int i = 0; i < num; ++i) {
+		if (sprites[i].colorAttrib & ignoreMask) continue;
+		int x = sprites[i].x;
+		SpritePattern pattern = sprites[i].pattern;
+		if (x < 0) {
+			// Sprites cannot collide in the left border.
+			assert(x >= -32);
+			if (x == -32) continue;
+			pattern <<= -x;
+			x = 0;
+		}
+		unsigned w     = x / 32;
+		unsigned shift = x % 32;
+		uint32_t left  = pattern >> shift;
+		uint32_t right = shift ? (pattern << (32 - shift)) : 0;
+		collided[w + 0] |= covered[w + 0] & left;
+		collided[w + 1] |= covered[w + 1] & right;
+		covered [w + 0] |= left;
+		covered [w + 1] |= right;
+	}
+	// Sprites cannot collide in the right border either.
+	for (int w = 0; w < 8; ++w) {
+		if (collided[w]) {
+			return 32 * w + Math::countLeadingZeros(collided[w]);
+		}
+	}
+	return -1;
+}
+
 void SpriteChecker::updateSprites1(int limit)
 {
 	if (vdp.spritesEnabledFast()) {
@@ -97,21 +209,12 @@ void SpriteChecker::updateSprites1(int limit)
 
 inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 {
-	// This implementation contains a double for-loop. The outer loop goes
-	// over the sprites, the inner loop over the to-be-checked lines. This
-	// is not the order in which the real VDP performs this operation: the
-	// real VDP renders line-per-line and for each line checks all 32
-	// sprites.
-	//
-	// Though this 'reverse' order allows to skip over very large regions
-	// of the inner loop: we only have to process the lines were a
-	// particular sprite is actually visible. I measured this makes this
-	// routine 4x-5x faster!
-	//
-	// This routine also needs to detect the sprite number of the 'first'
-	// 5th-sprite-condition. With 'first' meaning the first line where this
-	// condition occurs. Because our loops are swapped compared to the real
-	// VDP, we need some extra fixup logic to correctly detect this.
+	// The lines on which each sprite is visible are precalculated in
+	// 'spriteLines' (that only changes when the Y-coordinates in the
+	// sprite attribute table or the sprite size change). So just like the
+	// real VDP we can go line-per-line, and for each line only visit the
+	// sprites that are actually visible on that line.
+	if (spriteLinesDirty) updateSpriteLines(false);
 
 	// Calculate display line.
 	// This is the line sprites are checked at; the line they are displayed
@@ -122,37 +225,33 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	bool limitSprites = limitSpritesSetting.getBoolean();
 	int size = vdp.getSpriteSize();
 	bool mag = vdp.isSpriteMag();
-	int magSize = (mag + 1) * size;
 	const byte* attributePtr = vram.spriteAttribTable.getReadArea(0, 32 * 4);
 	byte patternIndexMask = size == 16 ? 0xFC : 0xFF;
-	int fifthSpriteNum  = -1;  // no 5th sprite detected yet
-	int fifthSpriteLine = 999; // larger than any possible valid line
-
-	int sprite = 0;
-	for (/**/; sprite < 32; ++sprite) {
-		int y = attributePtr[4 * sprite + 0];
-		if (y == 208) break;
+	int fifthSpriteNum = -1; // no 5th sprite detected yet
 
-		for (int line = minLine; line < maxLine; ++line) {
-			// Calculate line number within the sprite.
-			int displayLine = line + displayDelta;
-			int spriteLine = (displayLine - y) & 0xFF;
-			if (spriteLine >= magSize) {
-				// Skip ahead till sprite becomes visible.
-				line += 256 - spriteLine - 1; // -1 because of for-loop
-				continue;
-			}
+	// Optimisation:
+	// If collision already occurred,
+	// that state is stable until it is reset by a status reg read,
+	// so no need to execute the checks.
+	bool checkCollision = !(vdp.getStatusReg0() & 0x20);
+	int collisionLine = -1; // no collision detected yet
+	int minXCollision = -1;
 
-			int visibleIndex = spriteCount[line];
+	for (int line = minLine; line < maxLine; ++line) {
+		int displayLine = line + displayDelta;
+		uint32_t visible = spriteLines[displayLine & 0xFF];
+		int visibleIndex = 0;
+		for (/**/; visible; visible &= visible - 1) {
+			int sprite = Math::findFirstSet(visible) - 1;
 			if (visibleIndex == 4) {
-				// Find earliest line where this condition occurs.
-				if (line < fifthSpriteLine) {
-					fifthSpriteLine = line;
-					fifthSpriteNum = sprite;
-				}
-				if (limitSprites) continue;
+				// Lines are checked in order, so this is the
+				// earliest line where this condition occurs.
+				if (fifthSpriteNum == -1) fifthSpriteNum = sprite;
+				if (limitSprites) break;
 			}
 
+			// Calculate line number within the sprite.
+			int spriteLine = (displayLine - spriteY[sprite]) & 0xFF;
 			SpriteInfo& sip = spriteBuffer[line][visibleIndex];
 			int patternIndex = attributePtr[4 * sprite + 2] & patternIndexMask;
 			if (mag) spriteLine /= 2;
@@ -162,7 +261,31 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 			if (colorAttrib & 0x80) sip.x -= 32;
 			sip.colorAttrib = colorAttrib;
 
-			spriteCount[line] = visibleIndex + 1;
+			++visibleIndex;
+		}
+		spriteCount[line] = visibleIndex;
+
+		/*
+		Model for sprite collision: (or "coincidence" in TMS9918 data sheet)
+		- Reset when status reg is read.
+		- Set when sprite patterns overlap.
+		- Color doesn't matter: sprites of color 0 can collide.
+		- Sprites that are partially off-screen position can collide, but only
+		  on the in-screen pixels. In other words: sprites cannot collide in
+		  the left or right border, only in the visible screen area. Though
+		  they can collide in the V9958 extra border mask. This behaviour is
+		  the same in sprite mode 1 and 2.
+		- Only the first 4 sprites on a line can collide.
+		*/
+		if (checkCollision && (visibleIndex >= 2)) {
+			int x = findCollision(spriteBuffer[line],
+			                      std::min(4, visibleIndex), 0);
+			if (x != -1) {
+				// don't check lines with higher Y-coord
+				checkCollision = false;
+				collisionLine = line;
+				minXCollision = x;
+			}
 		}
 	}
 
@@ -178,73 +301,18 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	}
 	if (~status & 0x40) {
 		// No 5th sprite detected, store number of latest sprite processed.
-		status = (status & 0x20) | std::min(sprite, 31);
+		status = (status & 0x20) | std::min(numSprites, 31);
 	}
-	vdp.setSpriteStatus(status);
-
-	// Optimisation:
-	// If collision already occurred,
-	// that state is stable until it is reset by a status reg read,
-	// so no need to execute the checks.
-	// The spriteBuffer array is filled now, so we can bail out.
-	if (vdp.getStatusReg0() & 0x20) return;
-
-	/*
-	Model for sprite collision: (or "coincidence" in TMS9918 data sheet)
-	- Reset when status reg is read.
-	- Set when sprite patterns overlap.
-	- Color doesn't matter: sprites of color 0 can collide.
-	- Sprites that are partially off-screen position can collide, but only
-	  on the in-screen pixels. In other words: sprites cannot collide in
-	  the left or right border, only in the visible screen area. Though
-	  they can collide in the V9958 extra border mask. This behaviour is
-	  the same in sprite mode 1 and 2.
-
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow,
-	but there are max 4 sprites and therefore max 6 pairs.
-	If any collision is found, method returns at once.
-	*/
-	for (int line = minLine; line < maxLine; ++line) {
-		int minXCollision = 999;
-		for (int i = std::min<int>(4, spriteCount[line]); --i >= 1; /**/) {
-			int x_i = spriteBuffer[line][i].x;
-			SpritePattern pattern_i = spriteBuffer[line][i].pattern;
-			for (int j = i; --j >= 0; ) {
-				// Do sprite i and sprite j collide?
-				int x_j = spriteBuffer[line][j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = spriteBuffer[line][j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + Math::countLeadingZeros(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
-		if (minXCollision < 256) {
-			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
-			// verified: collision coords are also filled
-			//           in for sprite mode 1
-			// x-coord should be increased by 12
-			// y-coord                         8
-			collisionX = minXCollision + 12;
-			collisionY = line - vdp.getLineZero() + 8;
-			return; // don't check lines with higher Y-coord
-		}
+	if (collisionLine != -1) {
+		status |= 0x20;
+		// verified: collision coords are also filled
+		//           in for sprite mode 1
+		// x-coord should be increased by 12
+		// y-coord                         8
+		collisionX = minXCollision + 12;
+		collisionY = collisionLine - vdp.getLineZero() + 8;
 	}
+	vdp.setSpriteStatus(status);
 }
 
 void SpriteChecker::updateSprites2(int limit)
@@ -267,127 +335,98 @@ void SpriteChecker::updateSprites2(int limit)
 
 inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 {
-	// See comment in checkSprites1() about order of inner and outer loops.
+	// See comment in checkSprites1() about 'spriteLines'.
+	if (spriteLinesDirty) updateSpriteLines(true);
 
 	// Calculate display line.
 	// This is the line sprites are checked at; the line they are displayed
 	// at is one lower.
 	int displayDelta = vdp.getVerticalScroll() - vdp.getLineZero();
 
-	// Get sprites for this line and detect 5th sprite if any.
+	// Get sprites for this line and detect 9th sprite if any.
 	bool limitSprites = limitSpritesSetting.getBoolean();
 	int size = vdp.getSpriteSize();
 	bool mag = vdp.isSpriteMag();
-	int magSize = (mag + 1) * size;
 	int patternIndexMask = (size == 16) ? 0xFC : 0xFF;
-	int ninthSpriteNum  = -1;  // no 9th sprite detected yet
-	int ninthSpriteLine = 999; // larger than any possible valid line
+	int ninthSpriteNum = -1; // no 9th sprite detected yet
+
+	// See comment in checkSprites1().
+	bool checkCollision = !(vdp.getStatusReg0() & 0x20);
+	int collisionLine = -1; // no collision detected yet
+	int minXCollision = -1;
 
-	// Because it gave a measurable performance boost, we duplicated the
-	// code for planar and non-planar modes.
-	int sprite = 0;
+	const byte* attributePtr0;
+	const byte* attributePtr1;
 	if (planar) {
-		const byte* attributePtr0;
-		const byte* attributePtr1;
 		vram.spriteAttribTable.getReadAreaPlanar(
 			512, 32 * 4, attributePtr0, attributePtr1);
-		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
-			int y = attributePtr0[2 * sprite + 0];
-			if (y == 216) break;
-
-			for (int line = minLine; line < maxLine; ++line) {
-				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
-				int spriteLine = (displayLine - y) & 0xFF;
-				if (spriteLine >= magSize) {
-					// Skip ahead till sprite is visible.
-					line += 256 - spriteLine - 1;
-					continue;
-				}
-
-				int visibleIndex = spriteCount[line];
-				if (visibleIndex == 8) {
-					// Find earliest line where this condition occurs.
-					if (line < ninthSpriteLine) {
-						ninthSpriteLine = line;
-						ninthSpriteNum = sprite;
-					}
-					if (limitSprites) continue;
-				}
-
-				if (mag) spriteLine /= 2;
-				int colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
-				byte colorAttrib =
-					vram.spriteAttribTable.readPlanar(colorIndex);
-
-				SpriteInfo& sip = spriteBuffer[line][visibleIndex];
+	} else {
+		attributePtr0 = vram.spriteAttribTable.getReadArea(512, 32 * 4);
+		attributePtr1 = nullptr;
+	}
+
+	for (int line = minLine; line < maxLine; ++line) {
+		int displayLine = line + displayDelta;
+		uint32_t visible = spriteLines[displayLine & 0xFF];
+		SpriteInfo* visibleSprites = spriteBuffer[line];
+		int visibleIndex = 0;
+		for (/**/; visible; visible &= visible - 1) {
+			int sprite = Math::findFirstSet(visible) - 1;
+			if (visibleIndex == 8) {
+				// Lines are checked in order, so this is the
+				// earliest line where this condition occurs.
+				if (ninthSpriteNum == -1) ninthSpriteNum = sprite;
+				if (limitSprites) break;
+			}
+
+			// Calculate line number within the sprite.
+			int spriteLine = (displayLine - spriteY[sprite]) & 0xFF;
+			if (mag) spriteLine /= 2;
+			int colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
+			SpriteInfo& sip = visibleSprites[visibleIndex];
+			// TODO: Verify CC implementation.
+			byte colorAttrib;
+			if (planar) {
+				colorAttrib = vram.spriteAttribTable.readPlanar(colorIndex);
 				int patternIndex = attributePtr0[2 * sprite + 1] & patternIndexMask;
 				sip.pattern = calculatePatternPlanar(patternIndex, spriteLine);
 				sip.x = attributePtr1[2 * sprite + 0];
-				if (colorAttrib & 0x80) sip.x -= 32;
-				sip.colorAttrib = colorAttrib;
-
-				// set sentinel (see below)
-				spriteBuffer[line][visibleIndex + 1].colorAttrib = 0;
-				spriteCount[line] = visibleIndex + 1;
-			}
-		}
-	} else {
-		const byte* attributePtr0 =
-			vram.spriteAttribTable.getReadArea(512, 32 * 4);
-		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
-			int y = attributePtr0[4 * sprite + 0];
-			if (y == 216) break;
-
-			for (int line = minLine; line < maxLine; ++line) {
-				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
-				int spriteLine = (displayLine - y) & 0xFF;
-				if (spriteLine >= magSize) {
-					// Skip ahead till sprite is visible.
-					line += 256 - spriteLine - 1;
-					continue;
-				}
-
-				int visibleIndex = spriteCount[line];
-				if (visibleIndex == 8) {
-					// Find earliest line where this condition occurs.
-					if (line < ninthSpriteLine) {
-						ninthSpriteLine = line;
-						ninthSpriteNum = sprite;
-					}
-					if (limitSprites) continue;
-				}
-
-				if (mag) spriteLine /= 2;
-				int colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
-				byte colorAttrib =
-					vram.spriteAttribTable.readNP(colorIndex);
+			} else {
 				// Sprites with CC=1 are only visible if preceded by
 				// a sprite with CC=0. However they DO contribute towards
 				// the max-8-sprites-per-line limit, so we can't easily
 				// filter them here. See also
 				//    https://github.com/openMSX/openMSX/issues/497
-
-				SpriteInfo& sip = spriteBuffer[line][visibleIndex];
+				colorAttrib = vram.spriteAttribTable.readNP(colorIndex);
 				int patternIndex = attributePtr0[4 * sprite + 2] & patternIndexMask;
 				sip.pattern = calculatePatternNP(patternIndex, spriteLine);
 				sip.x = attributePtr0[4 * sprite + 1];
-				if (colorAttrib & 0x80) sip.x -= 32;
-				sip.colorAttrib = colorAttrib;
-
-				// Set sentinel. Sentinel is actually only
-				// needed for sprites with CC=1.
-				// In the past we set the sentinel (for all
-				// lines) at the end. But it's slightly faster
-				// to do it only for lines that actually
-				// contain sprites (even if sentinel gets
-				// overwritten a couple of times for lines with
-				// many sprites).
-				spriteBuffer[line][visibleIndex + 1].colorAttrib = 0;
-				spriteCount[line] = visibleIndex + 1;
+			}
+			if (colorAttrib & 0x80) sip.x -= 32;
+			sip.colorAttrib = colorAttrib;
+
+			++visibleIndex;
+		}
+		// Set sentinel. Sentinel is actually only needed for sprites
+		// with CC=1.
+		visibleSprites[visibleIndex].colorAttrib = 0;
+		spriteCount[line] = visibleIndex;
+
+		/*
+		Model for sprite collision: see checkSprites1(), in addition:
+		- Color doesn't matter: sprites of color 0 can collide.
+		    TODO: V9938 data book denies this (page 98).
+		- Sprites with CC or IC set cannot collide.
+		- Only the first 8 sprites on a line can collide.
+		*/
+		if (checkCollision && (visibleIndex >= 2)) {
+			int x = findCollision(visibleSprites,
+			                      std::min(8, visibleIndex), 0x60);
+			if (x != -1) {
+				// don't check lines with higher Y-coord
+				checkCollision = false;
+				collisionLine = line;
+				minXCollision = x;
 			}
 		}
 	}
@@ -405,80 +444,16 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	}
 	if (~status & 0x40) {
 		// No 9th sprite detected, store number of latest sprite processed.
-		status = (status & 0x20) | std::min(sprite, 31);
+		status = (status & 0x20) | std::min(numSprites, 31);
 	}
-	vdp.setSpriteStatus(status);
-
-	// Optimisation:
-	// If collision already occurred,
-	// that state is stable until it is reset by a status reg read,
-	// so no need to execute the checks.
-	// The visibleSprites array is filled now, so we can bail out.
-	if (vdp.getStatusReg0() & 0x20) return;
-
-	/*
-	Model for sprite collision: (or "coincidence" in TMS9918 data sheet)
-	- Reset when status reg is read.
-	- Set when sprite patterns overlap.
-	- Color doesn't matter: sprites of color 0 can collide.
-	    TODO: V9938 data book denies this (page 98).
-	- Sprites that are partially off-screen position can collide, but only
-	  on the in-screen pixels. In other words: sprites cannot collide in
-	  the left or right border, only in the visible screen area. Though
-	  they can collide in the V9958 extra border mask. This behaviour is
-	  the same in sprite mode 1 and 2.
-
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow.
-	There are max 8 sprites and therefore max 42 pairs.
-	  TODO: Maybe this is slow... Think of something faster.
-	        Probably new approach is needed anyway for OR-ing.
-	*/
-	for (int line = minLine; line < maxLine; ++line) {
-		int minXCollision = 999; // no collision
-		SpriteInfo* visibleSprites = spriteBuffer[line];
-		for (int i = std::min<int>(8, spriteCount[line]); --i >= 1; /**/) {
-			// If CC or IC is set, this sprite cannot collide.
-			if (visibleSprites[i].colorAttrib & 0x60) continue;
-
-			int x_i = visibleSprites[i].x;
-			SpritePattern pattern_i = visibleSprites[i].pattern;
-			for (int j = i; --j >= 0; ) {
-				// If CC or IC is set, this sprite cannot collide.
-				if (visibleSprites[j].colorAttrib & 0x60) continue;
-
-				// Do sprite i and sprite j collide?
-				int x_j = visibleSprites[j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = visibleSprites[j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + Math::countLeadingZeros(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
-		if (minXCollision < 256) {
-			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
-			// x-coord should be increased by 12
-			// y-coord                         8
-			collisionX = minXCollision + 12;
-			collisionY = line - vdp.getLineZero() + 8;
-			return; // don't check lines with higher Y-coord
-		}
+	if (collisionLine != -1) {
+		status |= 0x20;
+		// x-coord should be increased by 12
+		// y-coord                         8
+		collisionX = minXCollision + 12;
+		collisionY = collisionLine - vdp.getLineZero() + 8;
 	}
+	vdp.setSpriteStatus(status);
 }
 
 // version 1: initial version
@@ -492,6 +467,7 @@ void SpriteChecker::serialize(Archive& ar, unsigned version)
 		frameStartTime.reset(vdp.getFrameStartTime());
 		//  - updateSpritesMethod, planar
 		setDisplayMode(vdp.getDisplayMode());
+		//  - spriteLines (setDisplayMode() marks them dirty)
 
 		// We don't serialize spriteCount[] and spriteBuffer[].
 		// These are only used to draw the MSX screen, they don't have
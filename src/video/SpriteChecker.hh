@@ -139,7 +139,7 @@ public:
 	inline void updateSpriteSizeMag(byte sizeMag, EmuTime::param time) {
 		(void)sizeMag;
 		sync(time);
-		// TODO: Precalc something?
+		spriteLinesDirty = true;
 	}
 
 	/** Informs the sprite checker of a vertical scroll change.
@@ -171,6 +171,13 @@ public:
 		}
 	}
 
+	/** Informs the sprite checker that the content of VRAM changed without
+	  * going through the VRAM windows (e.g. VRAM remapping).
+	  */
+	inline void invalidateSpriteLines() {
+		spriteLinesDirty = true;
+	}
+
 	/** Get X coordinate of sprite collision.
 	  */
 	inline int getCollisionX(EmuTime::param time) {
@@ -236,7 +243,8 @@ public:
 		return spriteCount[line];
 	}
 
-	// VRAMObserver implementation:
+	// VRAMObserver implementation (for the sprite pattern table, the
+	// sprite attribute table has its own observer, see below):
 
 	void updateVRAM(unsigned /*offset*/, EmuTime::param time) override {
 		checkUntil(time);
@@ -269,8 +277,20 @@ private:
 		default:
 			UNREACHABLE;
 		}
+		spriteLinesDirty = true;
 	}
 
+	/** Recalculate 'spriteLines', 'spriteY' and 'numSprites' from the
+	  * sprite attribute table.
+	  * @param mode2 Sprite mode 2 (true) or sprite mode 1 (false).
+	  */
+	void updateSpriteLines(bool mode2);
+
+	/** Would a write to the given offset in the sprite attribute table
+	  * change the content of 'spriteLines'?
+	  */
+	inline bool affectsSpriteLines(unsigned offset) const;
+
 	/** Calculate sprite patterns for sprite mode 1.
 	  */
 	void updateSprites1(int limit);
@@ -314,6 +334,23 @@ private:
 	  */
 	inline void checkSprites2(int minLine, int maxLine);
 
+	/** Find the leftmost pixel where two (or more) of the given sprites
+	  * overlap. Sprites that have one of the bits in 'ignoreMask' set in
+	  * their color attribute are not taken into account.
+	  * @return X-coordinate of the collision, or -1 if there's none.
+	  */
+	static int findCollision(const SpriteInfo* sprites, int num,
+	                         byte ignoreMask);
+
+	/** Observes the sprite attribute table. Changes to this table must
+	  * invalidate 'spriteLines' (in addition to syncing the sprite
+	  * checker). Changes to the sprite pattern table don't.
+	  */
+	struct AttribObserver final : VRAMObserver {
+		void updateVRAM(unsigned offset, EmuTime::param time) override;
+		void updateWindow(bool enabled, EmuTime::param time) override;
+	} attribObserver;
+
 	using UpdateSpritesMethod = void (SpriteChecker::*)(int limit);
 	UpdateSpritesMethod updateSpritesMethod;
 
@@ -365,6 +402,27 @@ private:
 	  */
 	uint8_t spriteCount[313];
 
+	/** For each display line (modulo 256), a bitmask of the sprites
+	  * (bit N is sprite N) that are visible on that line. This only
+	  * depends on the Y-coordinates in the sprite attribute table and on
+	  * the sprite size and magnification, so it's only recalculated when
+	  * one of those changes.
+	  */
+	uint32_t spriteLines[256];
+
+	/** The Y-coordinates that were used to calculate 'spriteLines'.
+	  */
+	byte spriteY[32];
+
+	/** Number of sprites before the terminating Y-coordinate (208 in
+	  * sprite mode 1, 216 in sprite mode 2), or 32 if there is none.
+	  */
+	int numSprites;
+
+	/** Must 'spriteLines' be recalculated before it's used?
+	  */
+	bool spriteLinesDirty;
+
 	/** Is current display mode planar or not?
 	  * TODO: Introduce separate update methods for planar/nonplanar modes.
 	  */
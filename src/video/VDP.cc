@@ -85,6 +85,7 @@ VDP::VDP(const DeviceConfig& config)
 	, msxYPosInfo      (*this)
 	, msxX256PosInfo   (*this)
 	, msxX512PosInfo   (*this)
+	, frameSkipInfo    (*this)
 	, frameStartTime(getCurrentTime())
 	, irqVertical  (getMotherBoard(), getName() + ".IRQvertical",   config)
 	, irqHorizontal(getMotherBoard(), getName() + ".IRQhorizontal", config)
@@ -1736,6 +1737,30 @@ int VDP::MsxX512PosInfo::calc(const EmuTime& time) const
 }
 
 
+// class FrameSkipInfo
+
+VDP::FrameSkipInfo::FrameSkipInfo(VDP& vdp_)
+	: InfoTopic(vdp_.getMotherBoard().getMachineInfoCommand(),
+	            strCat(vdp_.getName(), "_frameskip"))
+	, vdp(vdp_)
+{
+}
+
+void VDP::FrameSkipInfo::execute(
+	span<const TclObject> /*tokens*/, TclObject& result) const
+{
+	vdp.renderer->getFrameSkipStats(result);
+}
+
+string VDP::FrameSkipInfo::help(const vector<string>& /*tokens*/) const
+{
+	return "Frameskip statistics of the renderer: the number of rendered "
+	       "and skipped frames and, for the adaptive frameskip mode, the "
+	       "current skip level and the measured host times (in us) it "
+	       "is based on.";
+}
+
+
 // version 1: initial version
 // version 2: added frameCount
 // version 3: removed verticalAdjust
@@ -40,6 +40,7 @@ TODO:
 #include "unreachable.hh"
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
 
 using std::min;
@@ -171,6 +172,7 @@ struct Graphic4Mode
 	static const byte PIXELS_PER_BYTE = 2;
 	static const byte PIXELS_PER_BYTE_SHIFT = 1;
 	static const unsigned PIXELS_PER_LINE = 256;
+	static const bool PLANAR = false;
 	static inline unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static inline byte point(VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
 	template <typename LogOp>
@@ -221,6 +223,7 @@ struct Graphic5Mode
 	static const byte PIXELS_PER_BYTE = 4;
 	static const byte PIXELS_PER_BYTE_SHIFT = 2;
 	static const unsigned PIXELS_PER_LINE = 512;
+	static const bool PLANAR = false;
 	static inline unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static inline byte point(VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
 	template <typename LogOp>
@@ -273,6 +276,7 @@ struct Graphic6Mode
 	static const byte PIXELS_PER_BYTE = 2;
 	static const byte PIXELS_PER_BYTE_SHIFT = 1;
 	static const unsigned PIXELS_PER_LINE = 512;
+	static const bool PLANAR = true;
 	static inline unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static inline byte point(VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
 	template <typename LogOp>
@@ -323,6 +327,7 @@ struct Graphic7Mode
 	static const byte PIXELS_PER_BYTE = 1;
 	static const byte PIXELS_PER_BYTE_SHIFT = 0;
 	static const unsigned PIXELS_PER_LINE = 256;
+	static const bool PLANAR = true;
 	static inline unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static inline byte point(VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
 	template<typename LogOp>
@@ -371,6 +376,7 @@ struct NonBitmapMode
 	static const byte PIXELS_PER_BYTE = 1;
 	static const byte PIXELS_PER_BYTE_SHIFT = 0;
 	static const unsigned PIXELS_PER_LINE = 256;
+	static const bool PLANAR = false;
 	static inline unsigned addressOf(unsigned x, unsigned y, bool extVRAM);
 	static inline byte point(VDPVRAM& vram, unsigned x, unsigned y, bool extVRAM);
 	template<typename LogOp>
@@ -650,8 +656,13 @@ struct IncrShift7
 
 
 // Logical operations:
+//  calc() returns the new value of a VRAM byte, operator() writes it.
 
 struct DummyOp {
+	byte calc(byte src, byte /*color*/, byte /*mask*/) const
+	{
+		return src;
+	}
 	void operator()(EmuTime::param /*time*/, VDPVRAM& /*vram*/, unsigned /*addr*/,
 	                byte /*src*/, byte /*color*/, byte /*mask*/) const
 	{
@@ -659,48 +670,57 @@ struct DummyOp {
 	}
 };
 
-struct ImpOp {
+template<typename Op>
+struct WriteOp {
 	void operator()(EmuTime::param time, VDPVRAM& vram, unsigned addr,
 	                byte src, byte color, byte mask) const
 	{
-		vram.cmdWrite(addr, (src & mask) | color, time);
+		vram.cmdWrite(addr, static_cast<const Op*>(this)->calc(
+			src, color, mask), time);
 	}
 };
 
-struct AndOp {
-	void operator()(EmuTime::param time, VDPVRAM& vram, unsigned addr,
-	                byte src, byte color, byte mask) const
+struct ImpOp : WriteOp<ImpOp> {
+	byte calc(byte src, byte color, byte mask) const
 	{
-		vram.cmdWrite(addr, src & (color | mask), time);
+		return (src & mask) | color;
 	}
 };
 
-struct OrOp {
-	void operator()(EmuTime::param time, VDPVRAM& vram, unsigned addr,
-	                byte src, byte color, byte /*mask*/) const
+struct AndOp : WriteOp<AndOp> {
+	byte calc(byte src, byte color, byte mask) const
 	{
-		vram.cmdWrite(addr, src | color, time);
+		return src & (color | mask);
 	}
 };
 
-struct XorOp {
-	void operator()(EmuTime::param time, VDPVRAM& vram, unsigned addr,
-	                byte src, byte color, byte /*mask*/) const
+struct OrOp : WriteOp<OrOp> {
+	byte calc(byte src, byte color, byte /*mask*/) const
 	{
-		vram.cmdWrite(addr, src ^ color, time);
+		return src | color;
 	}
 };
 
-struct NotOp {
-	void operator()(EmuTime::param time, VDPVRAM& vram, unsigned addr,
-	                byte src, byte color, byte mask) const
+struct XorOp : WriteOp<XorOp> {
+	byte calc(byte src, byte color, byte /*mask*/) const
 	{
-		vram.cmdWrite(addr, (src & mask) | ~(color | mask), time);
+		return src ^ color;
+	}
+};
+
+struct NotOp : WriteOp<NotOp> {
+	byte calc(byte src, byte color, byte mask) const
+	{
+		return (src & mask) | ~(color | mask);
 	}
 };
 
 template<typename Op>
 struct TransparentOp : Op {
+	byte calc(byte src, byte color, byte mask) const
+	{
+		return color ? Op::calc(src, color, mask) : src;
+	}
 	void operator()(EmuTime::param time, VDPVRAM& vram, unsigned addr,
 	                byte src, byte color, byte mask) const
 	{
@@ -717,6 +737,122 @@ using TXorOp = TransparentOp<XorOp>;
 using TNotOp = TransparentOp<NotOp>;
 
 
+// Bulk access:
+//  The command engine normally writes VRAM byte per byte via cmdWrite(),
+//  which (per byte) checks whether the renderer or the sprite checker must
+//  first be synchronized. When none of the bytes that remain on the current
+//  line are observed, the timing is calculated first (exactly as in the
+//  byte-by-byte loops) and then the VRAM is accessed in bulk.
+
+/** Can the VRAM bytes of 'num' consecutive steps on line 'y' be accessed
+  * directly? Steps start at x-coordinate 'x' and move 'tx' pixels each.
+  */
+template<typename Mode>
+static inline bool isDirectRun(const VDPVRAM& vram, bool write,
+                               unsigned x, int tx, unsigned num, unsigned y)
+{
+	unsigned x2 = x + (num - 1) * tx;
+	unsigned first = Mode::addressOf(min(x, x2), y, false);
+	unsigned last  = Mode::addressOf(max(x, x2), y, false);
+	auto check = [&](unsigned f, unsigned l) {
+		return write ? vram.isCmdDirectWrite(f, l)
+		             : vram.isCmdDirectRead (f, l);
+	};
+	if (Mode::PLANAR) {
+		first &= 0xFFFF;
+		last  &= 0xFFFF;
+		return check(first, last) && check(first | 0x10000, last | 0x10000);
+	}
+	return check(first, last);
+}
+
+/** Advance the calculator over at most 'num' write-only steps, 'delta'
+  * apart. Stops early when the limit is reached (after the step that
+  * reached it).
+  * @return The number of steps that were executed. When this equals 'num'
+  *         the calculator is at the time of the last step.
+  */
+static inline unsigned stepWriteRun(Calculator& calculator, unsigned num,
+                                    Delta delta)
+{
+	for (unsigned i = 1; i < num; ++i) {
+		calculator.next(delta);
+		if (calculator.limitReached()) return i;
+	}
+	return num;
+}
+
+/** Advance the calculator over at most 'num' read/write steps: the write
+  * happens 'readDelta' after the read, the next read 'writeDelta' after
+  * the write. Stops early when the limit is reached.
+  * @return The number of completed steps. When this equals 'num' the
+  *         calculator is at the time of the last write. Otherwise 'phase'
+  *         indicates whether the read of the next step already happened.
+  */
+static inline unsigned stepReadWriteRun(Calculator& calculator, unsigned num,
+                                        Delta readDelta, Delta writeDelta,
+                                        int& phase)
+{
+	unsigned i = 0;
+	while (true) {
+		calculator.next(readDelta);
+		if (calculator.limitReached()) { phase = 1; return i; }
+		if (++i == num) return num;
+		calculator.next(writeDelta);
+		if (calculator.limitReached()) { phase = 0; return i; }
+	}
+}
+
+/** Fill 'num' bytes on line 'y' (see isDirectRun()). */
+template<typename Mode>
+static inline void fillDirect(byte* data, unsigned x, int tx, unsigned num,
+                              unsigned y, byte value)
+{
+	if (!Mode::PLANAR) {
+		unsigned x2 = x + (num - 1) * tx;
+		memset(data + Mode::addressOf(min(x, x2), y, false), value, num);
+		return;
+	}
+	for (unsigned i = 0; i < num; ++i, x += tx) {
+		data[Mode::addressOf(x, y, false)] = value;
+	}
+}
+
+/** Copy 'num' bytes from line 'sy' to line 'dy' (see isDirectRun()).
+  * Overlapping areas give the same result as copying byte by byte.
+  */
+template<typename Mode>
+static inline void copyDirect(byte* data, unsigned sx, unsigned sy,
+                              unsigned dx, unsigned dy, int tx, unsigned num)
+{
+	if (!Mode::PLANAR) {
+		unsigned sx2 = sx + (num - 1) * tx;
+		unsigned dx2 = dx + (num - 1) * tx;
+		unsigned src = Mode::addressOf(min(sx, sx2), sy, false);
+		unsigned dst = Mode::addressOf(min(dx, dx2), dy, false);
+		if (((src + num) <= dst) || ((dst + num) <= src)) {
+			memcpy(data + dst, data + src, num);
+			return;
+		}
+	}
+	for (unsigned i = 0; i < num; ++i, sx += tx, dx += tx) {
+		data[Mode::addressOf(dx, dy, false)] =
+			data[Mode::addressOf(sx, sy, false)];
+	}
+}
+
+/** Logical operation adaptor that writes to VRAM without synchronisation
+  * (see VDPVRAM::getCmdDirectData()).
+  */
+template<typename Op>
+struct DirectOp {
+	void operator()(EmuTime::param /*time*/, VDPVRAM& vram, unsigned addr,
+	                byte src, byte color, byte mask) const
+	{
+		vram.getCmdDirectData()[addr] = Op().calc(src, color, mask);
+	}
+};
+
 // Commands
 
 void VDPCmdEngine::calcFinishTime(unsigned nx, unsigned ny, unsigned ticksPerPixel)
@@ -964,36 +1100,59 @@ void VDPCmdEngine::executeLmmv(EmuTime::param limit)
 	bool doPset = !dstExt || hasExtendedVRAM;
 	unsigned addr = Mode::addressOf(ADX, DY, dstExt);
 	auto calculator = getSlotCalculator(limit);
+	bool direct = !dstExt &&
+		isDirectRun<Mode>(vram, true, ADX, TX, ANX, DY);
 
 	switch (phase) {
 	case 0:
 loop:		if (unlikely(calculator.limitReached())) { phase = 0; break; }
+		if (direct) {
+			unsigned n = stepReadWriteRun(
+				calculator, ANX, DELTA_24, DELTA_72, phase);
+			byte* data = vram.getCmdDirectData();
+			for (unsigned i = 0; i < n; ++i, ADX += TX) {
+				addr = Mode::addressOf(ADX, DY, false);
+				Mode::pset(EmuTime::dummy(), vram, ADX, addr,
+				           data[addr], CL, DirectOp<LogOp>());
+			}
+			ANX -= n;
+			addr = Mode::addressOf(ADX, DY, false);
+			if (ANX != 0) {
+				// limit reached
+				if (phase == 1) tmpDst = data[addr];
+				break;
+			}
+			goto endOfLine;
+		}
 		if (likely(doPset)) {
 			tmpDst = vram.cmdWriteWindow.readNP(addr);
 		}
 		calculator.next(DELTA_24);
 		// fall-through
-	case 1: {
+	case 1:
 		if (unlikely(calculator.limitReached())) { phase = 1; break; }
 		if (likely(doPset)) {
 			Mode::pset(calculator.getTime(), vram, ADX, addr,
 			           tmpDst, CL, LogOp());
 		}
 		ADX += TX;
-		Delta delta = DELTA_72;
-		if (--ANX == 0) {
-			delta = DELTA_136; // 72 + 64;
-			DY += TY; --NY;
-			ADX = DX; ANX = tmpNX;
-			if (--tmpNY == 0) {
-				commandDone(calculator.getTime());
-				break;
-			}
+		if (--ANX != 0) {
+			addr = Mode::addressOf(ADX, DY, dstExt);
+			calculator.next(DELTA_72);
+			goto loop;
+		}
+endOfLine:
+		DY += TY; --NY;
+		ADX = DX; ANX = tmpNX;
+		if (--tmpNY == 0) {
+			commandDone(calculator.getTime());
+			break;
 		}
 		addr = Mode::addressOf(ADX, DY, dstExt);
-		calculator.next(delta);
+		direct = !dstExt &&
+			isDirectRun<Mode>(vram, true, ADX, TX, ANX, DY);
+		calculator.next(DELTA_136); // 72 + 64;
 		goto loop;
-	}
 	default:
 		UNREACHABLE;
 	}
@@ -1341,24 +1500,37 @@ void VDPCmdEngine::executeHmmv(EmuTime::param limit)
 	bool dstExt = (ARG & MXD) != 0;
 	bool doPset = !dstExt || hasExtendedVRAM;
 	auto calculator = getSlotCalculator(limit);
+	bool direct = !dstExt &&
+		isDirectRun<Mode>(vram, true, ADX, TX, ANX, DY);
 
 	while (!calculator.limitReached()) {
-		if (likely(doPset)) {
-			vram.cmdWrite(Mode::addressOf(ADX, DY, dstExt),
-			              COL, calculator.getTime());
-		}
-		ADX += TX;
-		Delta delta = DELTA_48;
-		if (--ANX == 0) {
-			delta = DELTA_104; // 48 + 56;
-			DY += TY; --NY;
-			ADX = DX; ANX = tmpNX;
-			if (--tmpNY == 0) {
-				commandDone(calculator.getTime());
-				break;
+		if (direct) {
+			unsigned n = stepWriteRun(calculator, ANX, DELTA_48);
+			fillDirect<Mode>(vram.getCmdDirectData(),
+			                 ADX, TX, n, DY, COL);
+			ADX += n * TX;
+			ANX -= n;
+			if (ANX != 0) break; // limit reached
+		} else {
+			if (likely(doPset)) {
+				vram.cmdWrite(Mode::addressOf(ADX, DY, dstExt),
+				              COL, calculator.getTime());
+			}
+			ADX += TX;
+			if (--ANX != 0) {
+				calculator.next(DELTA_48);
+				continue;
 			}
 		}
-		calculator.next(delta);
+		DY += TY; --NY;
+		ADX = DX; ANX = tmpNX;
+		if (--tmpNY == 0) {
+			commandDone(calculator.getTime());
+			break;
+		}
+		direct = !dstExt &&
+			isDirectRun<Mode>(vram, true, ADX, TX, ANX, DY);
+		calculator.next(DELTA_104); // 48 + 56;
 	}
 	engineTime = calculator.getTime();
 	calcFinishTime(tmpNX, tmpNY, 48);
@@ -1449,36 +1621,58 @@ void VDPCmdEngine::executeHmmm(EmuTime::param limit)
 	bool doPoint = !srcExt || hasExtendedVRAM;
 	bool doPset  = !dstExt || hasExtendedVRAM;
 	auto calculator = getSlotCalculator(limit);
+	bool direct = !srcExt && !dstExt &&
+		isDirectRun<Mode>(vram, false, ASX, TX, ANX, SY) &&
+		isDirectRun<Mode>(vram, true,  ADX, TX, ANX, DY);
 
 	switch (phase) {
 	case 0:
 loop:		if (unlikely(calculator.limitReached())) { phase = 0; break; }
+		if (direct) {
+			unsigned n = stepReadWriteRun(
+				calculator, ANX, DELTA_24, DELTA_64, phase);
+			byte* data = vram.getCmdDirectData();
+			copyDirect<Mode>(data, ASX, SY, ADX, DY, TX, n);
+			ASX += n * TX; ADX += n * TX;
+			ANX -= n;
+			if (ANX != 0) {
+				// limit reached
+				if (phase == 1) {
+					tmpSrc = data[Mode::addressOf(ASX, SY, false)];
+				}
+				break;
+			}
+			goto endOfLine;
+		}
 		tmpSrc = likely(doPoint)
 			? vram.cmdReadWindow.readNP(
 			       Mode::addressOf(ASX, SY, srcExt))
 			: 0xFF;
 		calculator.next(DELTA_24);
 		// fall-through
-	case 1: {
+	case 1:
 		if (unlikely(calculator.limitReached())) { phase = 1; break; }
 		if (likely(doPset)) {
 			vram.cmdWrite(Mode::addressOf(ADX, DY, dstExt),
 			              tmpSrc, calculator.getTime());
 		}
 		ASX += TX; ADX += TX;
-		Delta delta = DELTA_64;
-		if (--ANX == 0) {
-			delta = DELTA_128; // 64 + 64
-			SY += TY; DY += TY; --NY;
-			ASX = SX; ADX = DX; ANX = tmpNX;
-			if (--tmpNY == 0) {
-				commandDone(calculator.getTime());
-				break;
-			}
+		if (--ANX != 0) {
+			calculator.next(DELTA_64);
+			goto loop;
 		}
-		calculator.next(delta);
+endOfLine:
+		SY += TY; DY += TY; --NY;
+		ASX = SX; ADX = DX; ANX = tmpNX;
+		if (--tmpNY == 0) {
+			commandDone(calculator.getTime());
+			break;
+		}
+		direct = !srcExt && !dstExt &&
+			isDirectRun<Mode>(vram, false, ASX, TX, ANX, SY) &&
+			isDirectRun<Mode>(vram, true,  ADX, TX, ANX, DY);
+		calculator.next(DELTA_128); // 64 + 64
 		goto loop;
-	}
 	default:
 		UNREACHABLE;
 	}
@@ -1583,10 +1777,29 @@ void VDPCmdEngine::executeYmmm(EmuTime::param limit)
 	bool dstExt = (ARG & MXD) != 0;
 	bool doPset  = !dstExt || hasExtendedVRAM;
 	auto calculator = getSlotCalculator(limit);
+	bool direct = !dstExt &&
+		isDirectRun<Mode>(vram, false, ADX, TX, ANX, SY) &&
+		isDirectRun<Mode>(vram, true,  ADX, TX, ANX, DY);
 
 	switch (phase) {
 	case 0:
 loop:		if (unlikely(calculator.limitReached())) { phase = 0; break; }
+		if (direct) {
+			unsigned n = stepReadWriteRun(
+				calculator, ANX, DELTA_24, DELTA_40, phase);
+			byte* data = vram.getCmdDirectData();
+			copyDirect<Mode>(data, ADX, SY, ADX, DY, TX, n);
+			ADX += n * TX;
+			ANX -= n;
+			if (ANX != 0) {
+				// limit reached
+				if (phase == 1) {
+					tmpSrc = data[Mode::addressOf(ADX, SY, false)];
+				}
+				break;
+			}
+			goto endOfLine;
+		}
 		if (likely(doPset)) {
 			tmpSrc = vram.cmdReadWindow.readNP(
 			       Mode::addressOf(ADX, SY, dstExt));
@@ -1601,6 +1814,7 @@ loop:		if (unlikely(calculator.limitReached())) { phase = 0; break; }
 		}
 		ADX += TX;
 		if (--ANX == 0) {
+endOfLine:
 			// note: going to the next line does not take extra time
 			SY += TY; DY += TY; --NY;
 			ADX = DX; ANX = tmpNX;
@@ -1608,6 +1822,9 @@ loop:		if (unlikely(calculator.limitReached())) { phase = 0; break; }
 				commandDone(calculator.getTime());
 				break;
 			}
+			direct = !dstExt &&
+				isDirectRun<Mode>(vram, false, ADX, TX, ANX, SY) &&
+				isDirectRun<Mode>(vram, true,  ADX, TX, ANX, DY);
 		}
 		calculator.next(DELTA_40);
 		goto loop;
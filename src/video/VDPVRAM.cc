@@ -62,6 +62,24 @@ byte VDPVRAM::LogicalVRAMDebuggable::read(unsigned address, EmuTime::param time)
 	return vram.cpuRead(transform(address), time);
 }
 
+void VDPVRAM::LogicalVRAMDebuggable::readBlock(
+	unsigned start, byte* output, unsigned num)
+{
+	// Same result as read() for each byte, but the command engine only
+	// needs to be synced once.
+	auto& vram = OUTER(VDPVRAM, logicalVRAMDebug);
+	vram.cmdEngine->sync(getMotherBoard().getCurrentTime());
+	if (vram.vdp.getDisplayMode().isPlanar()) {
+		for (unsigned i = 0; i < num; ++i) {
+			output[i] = vram.data[transform(start + i) & vram.sizeMask];
+		}
+	} else {
+		for (unsigned i = 0; i < num; ++i) {
+			output[i] = vram.data[(start + i) & vram.sizeMask];
+		}
+	}
+}
+
 void VDPVRAM::LogicalVRAMDebuggable::write(
 	unsigned address, byte value, EmuTime::param time)
 {
@@ -87,6 +105,16 @@ byte VDPVRAM::PhysicalVRAMDebuggable::read(unsigned address, EmuTime::param time
 	return vram.cpuRead(address, time);
 }
 
+void VDPVRAM::PhysicalVRAMDebuggable::readBlock(
+	unsigned start, byte* output, unsigned num)
+{
+	auto& vram = OUTER(VDPVRAM, physicalVRAMDebug);
+	vram.cmdEngine->sync(getMotherBoard().getCurrentTime());
+	for (unsigned i = 0; i < num; ++i) {
+		output[i] = vram.data[(start + i) & vram.sizeMask];
+	}
+}
+
 void VDPVRAM::PhysicalVRAMDebuggable::write(
 	unsigned address, byte value, EmuTime::param time)
 {
@@ -305,6 +333,7 @@ void VDPVRAM::change4k8kMapping(bool mapping8k)
 		}
 	}
 	memcpy(&data[0], tmp, sizeof(tmp));
+	spriteChecker->invalidateSpriteLines();
 }
 
 
@@ -297,6 +297,37 @@ public:
 		return (address & combiMask) == unsigned(baseAddr);
 	}
 
+	/** Test whether at least one address in the given range is inside
+	  * this window. See isInside(unsigned).
+	  * @param first The lowest address of the range.
+	  * @param last The highest address of the range (inclusive).
+	  * @return true iff some address in [first, last] is inside.
+	  */
+	inline bool overlaps(unsigned first, unsigned last) const {
+		if (!isEnabled()) return false;
+		// Search the lowest address >= first that is inside this
+		// window. Bits in combiMask must match baseAddr, the other
+		// bits can have any value.
+		unsigned mask = combiMask;
+		unsigned base = baseAddr;
+		unsigned diff = (first ^ base) & mask;
+		if (diff == 0) return true;
+		unsigned low = Math::floodRight(diff);
+		unsigned top = low ^ (low >> 1); // highest mismatching bit
+		unsigned addr;
+		if (base & top) {
+			// Set that bit, lower bits take their minimal value.
+			addr = (first & ~low) | (base & low);
+		} else {
+			// Need to carry into a free bit above the mismatch.
+			unsigned carry = ~mask & ~first & ~low;
+			if (carry == 0) return false;
+			unsigned bit = carry & (~carry + 1);
+			addr = (first & ~(bit | (bit - 1))) | bit | (base & (bit - 1));
+		}
+		return addr <= last;
+	}
+
 	/** Notifies the observer of this window of a VRAM change,
 	  * if the changes address is inside this window.
 	  * @param address The address to test.
@@ -428,6 +459,46 @@ public:
 		writeCommon(address, value, time);
 	}
 
+	/** Can the command engine read the given address range directly
+	  * (see getCmdDirectData())? This is the case when no VRAM mirroring
+	  * applies to this range.
+	  * The range may not cross a 16kB boundary.
+	  */
+	inline bool isCmdDirectRead(unsigned first, unsigned last) const {
+		assert((first >> 14) == (last >> 14));
+		return ((first & sizeMask) == first) &&
+		       ((last  & sizeMask) == last);
+	}
+
+	/** Can the command engine write the given address range directly
+	  * (see getCmdDirectData())? On top of the isCmdDirectRead()
+	  * conditions, the range must be backed by actual VRAM and no other
+	  * subsystem may need to be notified of changes in this range.
+	  * The result stays valid until the VDP registers or the display
+	  * mode change, so certainly during one command engine sync.
+	  * The range may not cross a 16kB boundary.
+	  */
+	inline bool isCmdDirectWrite(unsigned first, unsigned last) const {
+		return isCmdDirectRead(first, last) &&
+		       (last < actualSize) &&
+		       !(bitmapVisibleWindow.hasObserver() &&
+		         bitmapVisibleWindow.overlaps(first, last)) &&
+		       !(spriteAttribTable.hasObserver() &&
+		         spriteAttribTable.overlaps(first, last)) &&
+		       !(spritePatternTable.hasObserver() &&
+		         spritePatternTable.overlaps(first, last));
+	}
+
+	/** Raw VRAM access for the command engine, without synchronisation.
+	  * Only addresses within a range accepted by isCmdDirectRead() (for
+	  * reading) or isCmdDirectWrite() (for writing) may be accessed.
+	  * This skips the per-byte window checks of cmdWrite(), so bulk
+	  * command engine operations can run at memory speed.
+	  */
+	inline byte* getCmdDirectData() {
+		return &data[0];
+	}
+
 	/** Write a byte to VRAM through the CPU interface.
 	  * @param address The address to write.
 	  * @param value The value to write.
@@ -614,6 +685,7 @@ private:
 	public:
 		explicit LogicalVRAMDebuggable(VDP& vdp);
 		byte read(unsigned address, EmuTime::param time) override;
+		void readBlock(unsigned start, byte* output, unsigned num) override;
 		void write(unsigned address, byte value, EmuTime::param time) override;
 	private:
 		unsigned transform(unsigned address);
@@ -626,6 +698,7 @@ private:
 	struct PhysicalVRAMDebuggable final : SimpleDebuggable {
 		PhysicalVRAMDebuggable(VDP& vdp, unsigned actualSize);
 		byte read(unsigned address, EmuTime::param time) override;
+		void readBlock(unsigned start, byte* output, unsigned num) override;
 		void write(unsigned address, byte value, EmuTime::param time) override;
 	} physicalVRAMDebug;
 
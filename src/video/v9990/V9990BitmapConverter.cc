@@ -7,6 +7,10 @@
 #include "components.hh"
 #include <cassert>
 #include <cstdint>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace openmsx {
 
@@ -24,109 +28,132 @@ V9990BitmapConverter<Pixel>::V9990BitmapConverter(
 	setColorMode(PP, B0); // initialize with dummy values
 }
 
-template<bool YJK, bool PAL, bool SKIP, typename Pixel, typename ColorLookup>
-static inline void draw_YJK_YUV_PAL(
-	ColorLookup color, V9990VRAM& vram,
-	Pixel* __restrict& out, unsigned& address, int firstX = 0)
+// Scalar version of convertYUV(), converts one block of 4 pixels.
+template<bool YJK, bool PAL>
+static inline void convertYUV4(const byte* in, uint16_t* out)
 {
-	byte data[4];
-	for (auto& d : data) {
-		d = vram.readVRAMBx(address++);
-	}
-
-	int u = (data[2] & 7) + ((data[3] & 3) << 3) - ((data[3] & 4) << 3);
-	int v = (data[0] & 7) + ((data[1] & 3) << 3) - ((data[1] & 4) << 3);
+	int u = (in[2] & 7) + ((in[3] & 3) << 3) - ((in[3] & 4) << 3);
+	int v = (in[0] & 7) + ((in[1] & 3) << 3) - ((in[1] & 4) << 3);
 
-	for (int i = SKIP ? firstX : 0; i < 4; ++i) {
-		if (PAL && (data[i] & 0x08)) {
-			*out++ = color.lookup64(data[i] >> 4);
+	for (int i = 0; i < 4; ++i) {
+		if (PAL && (in[i] & 0x08)) {
+			out[i] = 0x8000 | (in[i] >> 4);
 		} else {
-			int y = (data[i] & 0xF8) >> 3;
+			int y = (in[i] & 0xF8) >> 3;
 			int r = Math::clip<0, 31>(y + u);
 			int g = Math::clip<0, 31>((5 * y - 2 * u - v) / 4);
 			int b = Math::clip<0, 31>(y + v);
 			// The only difference between YUV and YJK is that
 			// green and blue are swapped.
 			if (YJK) std::swap(g, b);
-			*out++ = color.lookup32768((g << 10) + (r << 5) + b);
+			out[i] = (g << 10) + (r << 5) + b;
 		}
 	}
 }
 
-template<typename Pixel, typename ColorLookup>
-static void rasterBYUV(
-	ColorLookup color, V9990& vdp, V9990VRAM& vram,
-	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
+#ifdef __SSE2__
+// SSE2 version of convertYUV(), converts two blocks of 4 pixels.
+template<bool YJK, bool PAL>
+static inline void convertYUV8(const byte* in, uint16_t* out)
 {
-	unsigned address = (x & ~3) + y * vdp.getImageWidth();
-	if (x & 3) {
-		draw_YJK_YUV_PAL<false, false, true>(
-			color, vram, out, address, x & 3);
-		nrPixels -= 4 - (x & 3);
-	}
-	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		draw_YJK_YUV_PAL<false, false, false>(
-			color, vram, out, address);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i max = _mm_set1_epi16(31);
+	auto clip = [&](__m128i x) {
+		return _mm_min_epi16(_mm_max_epi16(x, zero), max);
+	};
+
+	// one pixel per 16-bit lane
+	__m128i d = _mm_unpacklo_epi8(
+		_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)), zero);
+
+	// Broadcast the low 3 bits of byte 0..3 of each block over all
+	// lanes of that block. The (6-bit signed) U and V components are
+	// built from these.
+	__m128i low = _mm_and_si128(d, _mm_set1_epi16(7));
+	__m128i b0 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, 0x00), 0x00);
+	__m128i b1 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, 0x55), 0x55);
+	__m128i b2 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, 0xAA), 0xAA);
+	__m128i b3 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, 0xFF), 0xFF);
+	__m128i u = _mm_srai_epi16(_mm_slli_epi16(
+		_mm_or_si128(b2, _mm_slli_epi16(b3, 3)), 10), 10);
+	__m128i v = _mm_srai_epi16(_mm_slli_epi16(
+		_mm_or_si128(b0, _mm_slli_epi16(b1, 3)), 10), 10);
+
+	__m128i y = _mm_srli_epi16(d, 3);
+	__m128i r = clip(_mm_add_epi16(y, u));
+	__m128i b = clip(_mm_add_epi16(y, v));
+	// An arithmetic shift rounds towards minus infinity instead of
+	// towards zero (like the division in the scalar version), but that
+	// only makes a difference for negative values, which get clipped
+	// to zero anyway.
+	__m128i y5 = _mm_add_epi16(_mm_slli_epi16(y, 2), y);
+	__m128i g = clip(_mm_srai_epi16(
+		_mm_sub_epi16(_mm_sub_epi16(y5, _mm_add_epi16(u, u)), v), 2));
+	if (YJK) std::swap(g, b);
+	__m128i result = _mm_or_si128(
+		_mm_or_si128(_mm_slli_epi16(g, 10), _mm_slli_epi16(r, 5)), b);
+
+	if (PAL) {
+		__m128i bit3 = _mm_set1_epi16(0x08);
+		__m128i isPal = _mm_cmpeq_epi16(_mm_and_si128(d, bit3), bit3);
+		__m128i pal = _mm_or_si128(_mm_srli_epi16(d, 4),
+		                           _mm_set1_epi16(-0x8000));
+		result = _mm_or_si128(_mm_and_si128   (isPal, pal),
+		                      _mm_andnot_si128(isPal, result));
 	}
-	// Note: this can draw up to 3 pixels too many, but that's ok.
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out), result);
 }
+#endif
 
-template<typename Pixel, typename ColorLookup>
-static void rasterBYUVP(
-	ColorLookup color, V9990& vdp, V9990VRAM& vram,
-	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
+template<bool YJK, bool PAL>
+void convertYUV(const byte* in, uint16_t* out, unsigned num)
 {
-	// TODO this mode cannot be shown in B4 and higher resolution modes
-	//      (So the dual palette for B4 modes is not an issue here.)
-	unsigned address = (x & ~3) + y * vdp.getImageWidth();
-	if (x & 3) {
-		draw_YJK_YUV_PAL<false, true, true>(
-			color, vram, out, address, x & 3);
-		nrPixels -= 4 - (x & 3);
+	assert((num % 4) == 0);
+	unsigned i = 0;
+#ifdef __SSE2__
+	for (/**/; (i + 8) <= num; i += 8) {
+		convertYUV8<YJK, PAL>(in + i, out + i);
 	}
-	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		draw_YJK_YUV_PAL<false, true, false>(
-			color, vram, out, address);
+#endif
+	for (/**/; i < num; i += 4) {
+		convertYUV4<YJK, PAL>(in + i, out + i);
 	}
-	// Note: this can draw up to 3 pixels too many, but that's ok.
 }
 
-template<typename Pixel, typename ColorLookup>
-static void rasterBYJK(
+// Force template instantiation (the unittest uses all variants)
+template void convertYUV<false, false>(const byte*, uint16_t*, unsigned);
+template void convertYUV<false, true >(const byte*, uint16_t*, unsigned);
+template void convertYUV<true,  false>(const byte*, uint16_t*, unsigned);
+template void convertYUV<true,  true >(const byte*, uint16_t*, unsigned);
+
+// Used for the BYUV, BYUVP, BYJK and BYJKP modes.
+// TODO the P modes cannot be shown in B4 and higher resolution modes
+//      (So the dual palette for B4 modes is not an issue here.)
+template<bool YJK, bool PAL, typename Pixel, typename ColorLookup>
+static void rasterYUV(
 	ColorLookup color, V9990& vdp, V9990VRAM& vram,
 	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
 {
+	// First calculate the V9990 colors for all (complete) blocks of 4
+	// pixels, then translate them to host colors. The former is the
+	// part that benefits from SIMD.
+	assert(nrPixels <= 1024);
+	if (nrPixels <= 0) return;
 	unsigned address = (x & ~3) + y * vdp.getImageWidth();
-	if (x & 3) {
-		draw_YJK_YUV_PAL<true, false, true>(
-			color, vram, out, address, x & 3);
-		nrPixels -= 4 - (x & 3);
-	}
-	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		draw_YJK_YUV_PAL<true, false, false>(
-			color, vram, out, address);
+	unsigned skip = x & 3;
+	unsigned num = (skip + nrPixels + 3) & ~3;
+	byte in[1024 + 4];
+	for (unsigned i = 0; i < num; ++i) {
+		in[i] = vram.readVRAMBx(address + i);
 	}
-	// Note: this can draw up to 3 pixels too many, but that's ok.
-}
+	uint16_t colors[1024 + 4];
+	convertYUV<YJK, PAL>(in, colors, num);
 
-template<typename Pixel, typename ColorLookup>
-static void rasterBYJKP(
-	ColorLookup color, V9990& vdp, V9990VRAM& vram,
-	Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
-{
-	// TODO this mode cannot be shown in B4 and higher resolution modes
-	//      (So the dual palette for B4 modes is not an issue here.)
-	unsigned address = (x & ~3) + y * vdp.getImageWidth();
-	if (x & 3) {
-		draw_YJK_YUV_PAL<true, true, true>(
-			color, vram, out, address, x & 3);
-		nrPixels -= 4 - (x & 3);
+	for (unsigned i = skip; i < (skip + nrPixels); ++i) {
+		auto c = colors[i];
+		*out++ = (PAL && (c & 0x8000)) ? color.lookup64(c & 0x0F)
+		                               : color.lookup32768(c);
 	}
-	for (/**/; nrPixels > 0; nrPixels -= 4) {
-		draw_YJK_YUV_PAL<true, true, false>(
-			color, vram, out, address);
-	}
-	// Note: this can draw up to 3 pixels too many, but that's ok.
 }
 
 template<typename Pixel, typename ColorLookup>
@@ -325,10 +352,10 @@ static void raster(V9990ColorMode colorMode, bool highRes,
                    Pixel* __restrict out, unsigned x, unsigned y, int nrPixels)
 {
 	switch (colorMode) {
-	case BYUV:  return rasterBYUV <Pixel>(color, vdp, vram, out, x, y, nrPixels);
-	case BYUVP: return rasterBYUVP<Pixel>(color, vdp, vram, out, x, y, nrPixels);
-	case BYJK:  return rasterBYJK <Pixel>(color, vdp, vram, out, x, y, nrPixels);
-	case BYJKP: return rasterBYJKP<Pixel>(color, vdp, vram, out, x, y, nrPixels);
+	case BYUV:  return rasterYUV<false, false, Pixel>(color, vdp, vram, out, x, y, nrPixels);
+	case BYUVP: return rasterYUV<false, true,  Pixel>(color, vdp, vram, out, x, y, nrPixels);
+	case BYJK:  return rasterYUV<true,  false, Pixel>(color, vdp, vram, out, x, y, nrPixels);
+	case BYJKP: return rasterYUV<true,  true,  Pixel>(color, vdp, vram, out, x, y, nrPixels);
 	case BD16:  return rasterBD16 <Pixel>(color, vdp, vram, out, x, y, nrPixels);
 	case BD8:   return rasterBD8  <Pixel>(color, vdp, vram, out, x, y, nrPixels);
 	case BP6:   return rasterBP6  <Pixel>(color, vdp, vram, out, x, y, nrPixels);
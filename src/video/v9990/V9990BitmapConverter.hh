@@ -2,6 +2,7 @@
 #define V9990BITMAPCONVERTER_HH
 
 #include "V9990ModeEnum.hh"
+#include "openmsx.hh"
 #include <cstdint>
 
 namespace openmsx {
@@ -9,6 +10,17 @@ namespace openmsx {
 class V9990;
 class V9990VRAM;
 
+/** Calculate the V9990 colors for the YUV (YJK when YJK=true) bitmap modes.
+  * The result is a 15-bit GRB value (the index in the 32768 color palette).
+  * In the 'P' variants of these modes (PAL=true) pixels that use the 16
+  * color palette instead have value (0x8000 | paletteIndex).
+  * @param in VRAM data, one byte per pixel.
+  * @param out Output, one color per pixel.
+  * @param num Number of pixels, must be a multiple of 4 (one YUV block).
+  */
+template<bool YJK, bool PAL>
+void convertYUV(const byte* in, uint16_t* out, unsigned num);
+
 /** Utility class to convert VRAM content to host pixels.
   */
 template <class Pixel>
@@ -11,6 +11,7 @@
 #include "serialize.hh"
 #include "likely.hh"
 #include "unreachable.hh"
+#include <algorithm>
 #include <iostream>
 
 namespace openmsx {
@@ -657,6 +658,124 @@ inline void V9990CmdEngine::V9990Bpp16::psetColor(
 	vram.writeVRAMDirect(addr + 0x40000, result >> 8);
 }
 
+// Row batching -------------------------------------------------------
+//  The block commands take a fixed amount of time per step. Instead of
+//  comparing against 'limit' after each pixel, first calculate how many
+//  steps fit before 'limit' and then execute them (the rest of) one line
+//  at a time. The plain (possibly transparent) IMP operation on full
+//  bytes/words is by far the most common case; for 8bpp and 16bpp (with
+//  all bits enabled in the write mask) it's done with dedicated loops
+//  directly on the VRAM data.
+
+/** Number of iterations of a 'while (time < limit) { time += delta; .. }'
+  * loop. A zero delta (broken timing) means 'unlimited'.
+  */
+static inline unsigned getNumSteps(
+	EmuTime::param time, EmuTime::param limit, EmuDuration::param delta)
+{
+	if (time >= limit) return 0;
+	if (delta == EmuDuration::zero) return unsigned(-1);
+	return (limit - time).divUp(delta);
+}
+
+/** Can a row of pixels be handled by the plain IMP loops below? */
+template<typename Mode>
+static inline bool isPlainImp(byte op, word mask)
+{
+	return (Mode::BITS_PER_PIXEL >= 8) && ((op & 0x0F) == 0x0C) &&
+	       (mask == 0xFFFF);
+}
+
+/** Plain IMP pset of 'n' pixels with a fixed color (LMMV). */
+template<typename Mode>
+static inline void fillRowImp(
+	byte* vramData, unsigned x, unsigned y, int dx, unsigned n,
+	unsigned pitch, word color, bool transp)
+{
+	if (Mode::BITS_PER_PIXEL == 16) {
+		if (transp && (color == 0)) return;
+		for (unsigned i = 0; i < n; ++i, x += dx) {
+			unsigned addr = Mode::addressOf(x, y, pitch);
+			vramData[addr + 0x00000] = color & 0xFF;
+			vramData[addr + 0x40000] = color >> 8;
+		}
+	} else {
+		for (unsigned i = 0; i < n; ++i, x += dx) {
+			unsigned addr = Mode::addressOf(x, y, pitch);
+			byte c = (addr & 0x40000) ? (color >> 8) : (color & 0xFF);
+			if (!transp || c) vramData[addr] = c;
+		}
+	}
+}
+
+/** Plain IMP copy of 'n' pixels (LMMM). Overlapping areas give the same
+  * result as copying pixel by pixel.
+  */
+template<typename Mode>
+static inline void copyRowImp(
+	byte* vramData, unsigned sx, unsigned sy, unsigned dx, unsigned dy,
+	int step, unsigned n, unsigned pitch, bool transp)
+{
+	for (unsigned i = 0; i < n; ++i, sx += step, dx += step) {
+		unsigned src = Mode::addressOf(sx, sy, pitch);
+		unsigned dst = Mode::addressOf(dx, dy, pitch);
+		if (Mode::BITS_PER_PIXEL == 16) {
+			byte lo = vramData[src + 0x00000];
+			byte hi = vramData[src + 0x40000];
+			if (!transp || lo || hi) {
+				vramData[dst + 0x00000] = lo;
+				vramData[dst + 0x40000] = hi;
+			}
+		} else {
+			byte c = vramData[src];
+			if (!transp || c) vramData[dst] = c;
+		}
+	}
+}
+
+/** Plain IMP copy of 'n' pixels from linear VRAM (BMXL). */
+template<typename Mode>
+static inline void linearToRowImp(
+	byte* vramData, unsigned& srcAddress, unsigned x, unsigned y, int dx,
+	unsigned n, unsigned pitch, bool transp)
+{
+	for (unsigned i = 0; i < n; ++i, x += dx) {
+		unsigned dst = Mode::addressOf(x, y, pitch);
+		if (Mode::BITS_PER_PIXEL == 16) {
+			byte lo = vramData[V9990VRAM::transformBx(srcAddress + 0)];
+			byte hi = vramData[V9990VRAM::transformBx(srcAddress + 1)];
+			srcAddress += 2;
+			if (!transp || lo || hi) {
+				vramData[dst + 0x00000] = lo;
+				vramData[dst + 0x40000] = hi;
+			}
+		} else {
+			byte c = vramData[V9990VRAM::transformBx(srcAddress++)];
+			if (!transp || c) vramData[dst] = c;
+		}
+	}
+}
+
+/** Copy 'n' pixels to linear VRAM (BMLX), 8bpp and 16bpp only. */
+template<typename Mode>
+static inline void rowToLinear(
+	byte* vramData, unsigned& dstAddress, unsigned x, unsigned y, int dx,
+	unsigned n, unsigned pitch)
+{
+	for (unsigned i = 0; i < n; ++i, x += dx) {
+		unsigned src = Mode::addressOf(x, y, pitch);
+		if (Mode::BITS_PER_PIXEL == 16) {
+			vramData[V9990VRAM::transformBx(dstAddress++)] =
+				vramData[src + 0x00000];
+			vramData[V9990VRAM::transformBx(dstAddress++)] =
+				vramData[src + 0x40000];
+		} else {
+			vramData[V9990VRAM::transformBx(dstAddress++)] =
+				vramData[src];
+		}
+	}
+}
+
 // ====================================================================
 /** Constructor
   */
@@ -1020,19 +1139,30 @@ void V9990CmdEngine::startLMMV(EmuTime::param time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMV(EmuTime::param limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(LMMV_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		Mode::psetColor(vram, DX, DY, pitch, fgCol, WM, lut, LOG);
-
-		DX += dx;
-		if (!--(ANX)) {
+	bool plain = isPlainImp<Mode>(LOG, WM);
+	bool transp = (LOG & 0x10) != 0;
+	unsigned steps = getNumSteps(engineTime, limit, delta);
+	while (steps) {
+		unsigned n = std::min<unsigned>(steps, ANX);
+		if (plain) {
+			fillRowImp<Mode>(vram.getWriteBackdoor(), DX, DY, dx, n,
+			                 pitch, fgCol, transp);
+			DX += n * dx;
+		} else {
+			for (unsigned i = 0; i < n; ++i) {
+				Mode::psetColor(vram, DX, DY, pitch, fgCol, WM, lut, LOG);
+				DX += dx;
+			}
+		}
+		engineTime += delta * n;
+		steps -= n;
+		ANX -= n;
+		if (!ANX) {
 			DX -= (NX * dx);
 			DY += dy;
 			if (!--(ANY)) {
@@ -1112,22 +1242,34 @@ void V9990CmdEngine::startLMMM(EmuTime::param time)
 template<typename Mode>
 void V9990CmdEngine::executeLMMM(EmuTime::param limit)
 {
-	// TODO can be optimized a lot
-
 	auto delta = getTiming(LMMM_TIMING);
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = Mode::getLogOpLUT(LOG);
-	while (engineTime < limit) {
-		engineTime += delta;
-		auto src = Mode::point(vram, SX, SY, pitch);
-		src = Mode::shift(src, SX, DX);
-		Mode::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
-
-		DX += dx;
-		SX += dx;
-		if (!--(ANX)) {
+	bool plain = isPlainImp<Mode>(LOG, WM);
+	bool transp = (LOG & 0x10) != 0;
+	unsigned steps = getNumSteps(engineTime, limit, delta);
+	while (steps) {
+		unsigned n = std::min<unsigned>(steps, ANX);
+		if (plain) {
+			copyRowImp<Mode>(vram.getWriteBackdoor(), SX, SY, DX, DY,
+			                 dx, n, pitch, transp);
+			DX += n * dx;
+			SX += n * dx;
+		} else {
+			for (unsigned i = 0; i < n; ++i) {
+				auto src = Mode::point(vram, SX, SY, pitch);
+				src = Mode::shift(src, SX, DX);
+				Mode::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
+				DX += dx;
+				SX += dx;
+			}
+		}
+		engineTime += delta * n;
+		steps -= n;
+		ANX -= n;
+		if (!ANX) {
 			DX -= (NX * dx);
 			SX -= (NX * dx);
 			DY += dy;
@@ -1259,15 +1401,29 @@ void V9990CmdEngine::executeBMXL<V9990CmdEngine::V9990Bpp16>(EmuTime::param limi
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = V9990Bpp16::getLogOpLUT(LOG);
-
-	while (engineTime < limit) {
-		engineTime += delta;
-		word src = vram.readVRAMBx(srcAddress + 0) +
-		           vram.readVRAMBx(srcAddress + 1) * 256;
-		srcAddress += 2;
-		V9990Bpp16::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
-		DX += dx;
-		if (!--(ANX)) {
+	bool plain = isPlainImp<V9990Bpp16>(LOG, WM);
+	bool transp = (LOG & 0x10) != 0;
+	unsigned steps = getNumSteps(engineTime, limit, delta);
+
+	while (steps) {
+		unsigned n = std::min<unsigned>(steps, ANX);
+		if (plain) {
+			linearToRowImp<V9990Bpp16>(vram.getWriteBackdoor(),
+				srcAddress, DX, DY, dx, n, pitch, transp);
+			DX += n * dx;
+		} else {
+			for (unsigned i = 0; i < n; ++i) {
+				word src = vram.readVRAMBx(srcAddress + 0) +
+				           vram.readVRAMBx(srcAddress + 1) * 256;
+				srcAddress += 2;
+				V9990Bpp16::pset(vram, DX, DY, pitch, src, WM, lut, LOG);
+				DX += dx;
+			}
+		}
+		engineTime += delta * n;
+		steps -= n;
+		ANX -= n;
+		if (!ANX) {
 			DX -= (NX * dx);
 			DY += dy;
 			if (!--(ANY)) {
@@ -1288,8 +1444,34 @@ void V9990CmdEngine::executeBMXL(EmuTime::param limit)
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
 	const byte* lut = Mode::getLogOpLUT(LOG);
+	unsigned steps = getNumSteps(engineTime, limit, delta);
+
+	if (isPlainImp<Mode>(LOG, WM)) {
+		// one pixel per byte
+		bool transp = (LOG & 0x10) != 0;
+		while (steps) {
+			unsigned n = std::min<unsigned>(steps, ANX);
+			linearToRowImp<Mode>(vram.getWriteBackdoor(),
+				srcAddress, DX, DY, dx, n, pitch, transp);
+			DX += n * dx;
+			engineTime += delta * n;
+			steps -= n;
+			ANX -= n;
+			if (!ANX) {
+				DX -= (NX * dx);
+				DY += dy;
+				if (!--(ANY)) {
+					cmdReady(engineTime);
+					return;
+				} else {
+					ANX = getWrappedNX();
+				}
+			}
+		}
+		return;
+	}
 
-	while (engineTime < limit) {
+	for (/**/; steps; --steps) {
 		engineTime += delta;
 		byte d = vram.readVRAMBx(srcAddress++);
 		for (int i = 0; (ANY > 0) && (i < Mode::PIXELS_PER_BYTE); ++i) {
@@ -1326,14 +1508,17 @@ void V9990CmdEngine::executeBMLX<V9990CmdEngine::V9990Bpp16>(EmuTime::param limi
 	unsigned pitch = V9990Bpp16::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
-
-	while (engineTime < limit) {
-		engineTime += delta;
-		auto src = V9990Bpp16::point(vram, SX, SY, pitch);
-		vram.writeVRAMBx(dstAddress++, src & 0xFF);
-		vram.writeVRAMBx(dstAddress++, src >> 8);
-		SX += dx;
-		if (!--(ANX)) {
+	unsigned steps = getNumSteps(engineTime, limit, delta);
+
+	while (steps) {
+		unsigned n = std::min<unsigned>(steps, ANX);
+		rowToLinear<V9990Bpp16>(vram.getWriteBackdoor(), dstAddress,
+		                        SX, SY, dx, n, pitch);
+		SX += n * dx;
+		engineTime += delta * n;
+		steps -= n;
+		ANX -= n;
+		if (!ANX) {
 			SX -= (NX * dx);
 			SY += dy;
 			if (!--(ANY)) {
@@ -1353,8 +1538,33 @@ void V9990CmdEngine::executeBMLX(EmuTime::param limit)
 	unsigned pitch = Mode::getPitch(vdp.getImageWidth());
 	int dx = (ARG & DIX) ? -1 : 1;
 	int dy = (ARG & DIY) ? -1 : 1;
+	unsigned steps = getNumSteps(engineTime, limit, delta);
+
+	if (Mode::BITS_PER_PIXEL == 8) {
+		// one pixel per byte
+		while (steps) {
+			unsigned n = std::min<unsigned>(steps, ANX);
+			rowToLinear<Mode>(vram.getWriteBackdoor(), dstAddress,
+			                  SX, SY, dx, n, pitch);
+			SX += n * dx;
+			engineTime += delta * n;
+			steps -= n;
+			ANX -= n;
+			if (!ANX) {
+				SX -= (NX * dx);
+				SY += dy;
+				if (!--(ANY)) {
+					cmdReady(engineTime);
+					return;
+				} else {
+					ANX = getWrappedNX();
+				}
+			}
+		}
+		return;
+	}
 
-	while (engineTime < limit) {
+	for (/**/; steps; --steps) {
 		engineTime += delta;
 		byte d = 0;
 		for (int i = 0; i < Mode::PIXELS_PER_BYTE; ++i) {
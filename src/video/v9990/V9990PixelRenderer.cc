@@ -65,12 +65,17 @@ void V9990PixelRenderer::frameStart(EmuTime::param time)
 		frameSkipCounter = 999;
 		drawFrame = false;
 		prevDrawFrame = false;
+		rasterizer->getPostProcessor()->skipFrame();
 		return;
 	}
 	prevDrawFrame = drawFrame;
 	if (vdp.isInterlaced() && renderSettings.getDeinterlace() &&
 	    vdp.getEvenOdd() && vdp.isEvenOddEnabled()) {
 		// deinterlaced odd frame, do same as even frame
+	} else if (renderSettings.getFrameHash()) {
+		// Every frame must be hashed, independent of the host speed.
+		frameSkipCounter = 0;
+		drawFrame = true;
 	} else {
 		if (frameSkipCounter < renderSettings.getMinFrameSkip()) {
 			++frameSkipCounter;
@@ -91,7 +96,10 @@ void V9990PixelRenderer::frameStart(EmuTime::param time)
 			}
 		}
 	}
-	if (!drawFrame) return;
+	if (!drawFrame) {
+		rasterizer->getPostProcessor()->skipFrame();
+		return;
+	}
 
 	accuracy = renderSettings.getAccuracy();
 	lastX = 0;
@@ -78,6 +78,14 @@ public:
 		data.write(address, value);
 	}
 
+	/** Bulk access for the command engine, see
+	  * TrackedRam::getWriteBackdoor(). Addresses are physical, like for
+	  * readVRAMDirect() and writeVRAMDirect().
+	  */
+	inline byte* getWriteBackdoor() {
+		return data.getWriteBackdoor();
+	}
+
 	byte readVRAMCPU(unsigned address, EmuTime::param time);
 	void writeVRAMCPU(unsigned address, byte val, EmuTime::param time);
 